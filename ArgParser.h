@@ -0,0 +1,55 @@
+#ifndef ARGPARSER_H
+#define ARGPARSER_H
+
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------
+// ArgParser
+// Separa argumentos posicionais das opcoes "--nome" / "--nome=valor",
+// para que os executaveis aceitem flags opcionais em qualquer posicao
+// sem quebrar a ordem dos argumentos posicionais ja existentes.
+// ------------------------------------------------------------
+class ArgParser {
+public:
+    ArgParser(int argc, char** argv) {
+        program = argc > 0 ? argv[0] : "";
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.size() > 2 && arg.compare(0, 2, "--") == 0)
+                options.push_back(arg.substr(2));
+            else
+                positionals.push_back(arg);
+        }
+    }
+
+    const std::string& program_name() const { return program; }
+
+    size_t positional_count() const { return positionals.size(); }
+    const std::string& positional(size_t i) const { return positionals[i]; }
+
+    // --nome (com ou sem valor)
+    bool has_flag(const std::string& name) const {
+        for (const auto& opt : options)
+            if (opt == name || opt.compare(0, name.size() + 1, name + "=") == 0)
+                return true;
+        return false;
+    }
+
+    // --nome=valor (retorna default_value se ausente)
+    std::string option(const std::string& name,
+                       const std::string& default_value = "") const {
+        const std::string prefix = name + "=";
+        for (const auto& opt : options)
+            if (opt.compare(0, prefix.size(), prefix) == 0)
+                return opt.substr(prefix.size());
+        return default_value;
+    }
+
+private:
+    std::string program;
+    std::vector<std::string> positionals;
+    std::vector<std::string> options;
+};
+
+#endif // ARGPARSER_H
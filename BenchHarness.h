@@ -0,0 +1,195 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ------------------------------------------------------------
+// BenchHarness
+// Harness mínimo no estilo do Google Benchmark: cada benchmark tem nome
+// + parâmetros, roda warm-up e N repetições cronometradas e reporta
+// mediana/MAD. Os resultados saem em JSON (um benchmark por linha) e
+// podem ser comparados com um JSON anterior para detectar regressões.
+// ------------------------------------------------------------
+
+// Impede o compilador de descartar o resultado medido
+template <typename T>
+inline void bench_do_not_optimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+using BenchParams = std::vector<std::pair<std::string, long long>>;
+
+struct BenchResult {
+    std::string name;
+    BenchParams params;
+    std::string key;             // nome + parâmetros (identificador estável)
+    std::vector<double> samples_ms;
+    double median_ms = 0.0;
+    double mad_ms = 0.0;         // desvio absoluto mediano
+    double min_ms = 0.0;
+    double mean_ms = 0.0;
+    double items = 0.0;          // itens processados por repetição
+};
+
+struct BenchRegression {
+    std::string key;
+    std::string reference;       // "baseline" ou arquivo de comparação
+    double reference_ms;
+    double current_ms;
+};
+
+class BenchRunner {
+public:
+    BenchRunner(int warmup, int repetitions, const std::string& filter)
+        : warmup(warmup), repetitions(std::max(1, repetitions)), filter(filter) {}
+
+    static std::string make_key(const std::string& name, const BenchParams& params) {
+        std::string key = name;
+        for (const auto& p : params)
+            key += "/" + p.first + ":" + std::to_string(p.second);
+        return key;
+    }
+
+    bool matches(const std::string& key) const {
+        return filter.empty() || key.find(filter) != std::string::npos;
+    }
+
+    // setup roda antes de cada repetição, fora da medição. Devolve o
+    // índice do resultado em get_results() (-1 se filtrado): ponteiros
+    // para results não sobrevivem ao próximo run
+    int run(const std::string& name,
+            const BenchParams& params,
+            double items,
+            const std::function<void()>& body,
+            const std::function<void()>& setup = nullptr) {
+        BenchResult result;
+        result.name = name;
+        result.params = params;
+        result.key = make_key(name, params);
+        result.items = items;
+        if (!matches(result.key)) return -1;
+
+        for (int i = 0; i < warmup; i++) {
+            if (setup) setup();
+            body();
+        }
+        for (int i = 0; i < repetitions; i++) {
+            if (setup) setup();
+            auto start = std::chrono::steady_clock::now();
+            body();
+            auto end = std::chrono::steady_clock::now();
+            result.samples_ms.push_back(
+                std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        summarize(result);
+        print(result);
+        results.push_back(result);
+        return results.size() - 1;
+    }
+
+    const std::vector<BenchResult>& get_results() const { return results; }
+
+    // Ponteiro válido até o próximo run
+    const BenchResult* find(const std::string& key) const {
+        for (const auto& r : results)
+            if (r.key == key) return &r;
+        return nullptr;
+    }
+
+    void write_json(std::ostream& out,
+                    const std::vector<std::pair<std::string, std::string>>& context,
+                    const std::vector<BenchRegression>& regressions) const {
+        out << "{\n  \"context\": {";
+        for (size_t i = 0; i < context.size(); i++)
+            out << (i ? ", " : "") << "\"" << context[i].first << "\": " << context[i].second;
+        out << "},\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const auto& r = results[i];
+            out << "    {\"key\": \"" << r.key << "\", \"name\": \"" << r.name << "\", \"params\": {";
+            for (size_t p = 0; p < r.params.size(); p++)
+                out << (p ? ", " : "") << "\"" << r.params[p].first << "\": " << r.params[p].second;
+            out << std::setprecision(6) << std::fixed
+                << "}, \"repetitions\": " << r.samples_ms.size()
+                << ", \"median_ms\": " << r.median_ms
+                << ", \"mad_ms\": " << r.mad_ms
+                << ", \"min_ms\": " << r.min_ms
+                << ", \"mean_ms\": " << r.mean_ms
+                << ", \"items_per_second\": "
+                << (r.median_ms > 0 ? r.items / (r.median_ms / 1000.0) : 0.0)
+                << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ],\n  \"regressions\": [\n";
+        for (size_t i = 0; i < regressions.size(); i++) {
+            const auto& g = regressions[i];
+            out << "    {\"key\": \"" << g.key << "\", \"reference\": \"" << g.reference
+                << "\", \"reference_ms\": " << g.reference_ms
+                << ", \"current_ms\": " << g.current_ms << "}"
+                << (i + 1 < regressions.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+
+    // Lê as medianas de um JSON gerado por write_json (key -> median_ms)
+    static std::map<std::string, double> read_json_medians(const std::string& filename) {
+        std::map<std::string, double> medians;
+        std::ifstream in(filename);
+        std::string line;
+        while (std::getline(in, line)) {
+            auto k = line.find("\"key\": \"");
+            auto m = line.find("\"median_ms\": ");
+            if (k == std::string::npos || m == std::string::npos) continue;
+            k += 8;
+            std::string key = line.substr(k, line.find('"', k) - k);
+            medians[key] = std::stod(line.substr(m + 13));
+        }
+        return medians;
+    }
+
+private:
+    int warmup;
+    int repetitions;
+    std::string filter;
+    std::vector<BenchResult> results;
+
+    static double median_of(std::vector<double> v) {
+        std::sort(v.begin(), v.end());
+        size_t n = v.size();
+        return n % 2 ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+    }
+
+    static void summarize(BenchResult& r) {
+        r.median_ms = median_of(r.samples_ms);
+        std::vector<double> deviations;
+        double sum = 0.0;
+        r.min_ms = r.samples_ms[0];
+        for (double s : r.samples_ms) {
+            deviations.push_back(std::fabs(s - r.median_ms));
+            sum += s;
+            r.min_ms = std::min(r.min_ms, s);
+        }
+        r.mad_ms = median_of(deviations);
+        r.mean_ms = sum / r.samples_ms.size();
+    }
+
+    static void print(const BenchResult& r) {
+        std::cout << std::left << std::setw(60) << r.key << std::right
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(12) << r.median_ms << " ms"
+                  << "  ± " << std::setw(8) << r.mad_ms << " (MAD, n="
+                  << r.samples_ms.size() << ")\n";
+    }
+};
+
+#endif // BENCH_HARNESS_H
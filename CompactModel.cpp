@@ -0,0 +1,415 @@
+#include "CompactModel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static const char COMPACT_MAGIC[4] = {'R', 'F', 'C', 'M'};
+static const uint8_t COMPACT_VERSION = 1;
+
+// ============================================================
+// Codificação básica: varint, chave monotônica do double, bits
+// ============================================================
+static void put_varint(std::string& out, uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back((char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((char)value);
+}
+
+// Bits do double reordenados para que a ordem dos inteiros sem sinal
+// seja a ordem dos valores (negativos invertidos, positivos com o bit
+// de sinal ligado)
+static uint64_t double_key(double x)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    return (bits >> 63) ? ~bits : bits | (1ull << 63);
+}
+
+static double key_double(uint64_t key)
+{
+    const uint64_t bits = (key >> 63) ? key & ~(1ull << 63) : ~key;
+    double x;
+    std::memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+static int bit_width(uint64_t value)
+{
+    int bits = 0;
+    while (value >> bits) bits++;
+    return bits;
+}
+
+namespace {
+
+struct BitWriter {
+    std::string bytes;
+    int used = 8;   // bits ocupados no último byte
+
+    void put(uint64_t value, int bits) {
+        for (int b = 0; b < bits; b++) {
+            if (used == 8) {
+                bytes.push_back(0);
+                used = 0;
+            }
+            bytes.back() |= (char)(((value >> b) & 1) << used);
+            used++;
+        }
+    }
+};
+
+struct ByteReader {
+    const uint8_t* pos;
+    const uint8_t* end;
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos == end) throw std::runtime_error("Modelo compacto truncado");
+            const uint8_t byte = *pos++;
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        throw std::runtime_error("Varint invalido no modelo compacto");
+    }
+
+    uint64_t remaining() const { return end - pos; }
+
+    void raw(void* out, size_t bytes) {
+        if ((size_t)(end - pos) < bytes) throw std::runtime_error("Modelo compacto truncado");
+        if (bytes) std::memcpy(out, pos, bytes);
+        pos += bytes;
+    }
+
+    // Próxima seção: tamanho em varint seguido dos bytes
+    ByteReader section() {
+        const uint64_t length = varint();
+        if ((uint64_t)(end - pos) < length) throw std::runtime_error("Modelo compacto truncado");
+        ByteReader sub{pos, pos + length};
+        pos += length;
+        return sub;
+    }
+};
+
+struct BitReader {
+    const uint8_t* data;
+    uint64_t n_bits;
+    uint64_t next = 0;
+
+    uint64_t get(int bits) {
+        if (next + bits > n_bits) throw std::runtime_error("Modelo compacto truncado");
+        uint64_t value = 0;
+        for (int b = 0; b < bits; b++, next++)
+            value |= (uint64_t)((data[next >> 3] >> (next & 7)) & 1) << b;
+        return value;
+    }
+};
+
+} // namespace
+
+// ============================================================
+// Escrita: pré-ordem de cada árvore, dicionários, fluxos
+// ============================================================
+void CompactModel::write(const FlatForest& forest, int num_classes, LeafMode leaf_mode,
+                         std::ostream& out)
+{
+    const std::vector<FlatNode>& nodes = forest.get_nodes();
+    const int leaf_width = forest.get_leaf_width();
+
+    // 1) Pré-ordem: bits de estrutura, nós internos e folhas na ordem
+    BitWriter structure;
+    std::vector<int32_t> internal, leaves;
+    internal.reserve(nodes.size());
+    std::vector<int32_t> stack;
+    for (int32_t root : forest.get_roots()) {
+        stack.assign(1, root);
+        while (!stack.empty()) {
+            const int32_t ref = stack.back();
+            stack.pop_back();
+            if (FlatForest::is_leaf_ref(ref)) {
+                structure.put(0, 1);
+                leaves.push_back(ref);
+                continue;
+            }
+            structure.put(1, 1);
+            internal.push_back(ref);
+            stack.push_back(nodes[ref].child[1]);
+            stack.push_back(nodes[ref].child[0]);
+        }
+    }
+
+    // 2) Dicionários: thresholds distintos por feature, máscaras distintas
+    std::vector<std::vector<double>> dictionary;
+    std::vector<uint64_t> masks;
+    for (int32_t ref : internal) {
+        const FlatNode& node = nodes[ref];
+        if (node.is_categorical()) {
+            masks.push_back(node.category_mask);
+            continue;
+        }
+        if (node.feature() >= (int)dictionary.size()) dictionary.resize(node.feature() + 1);
+        dictionary[node.feature()].push_back(node.threshold);
+    }
+    for (auto& values : dictionary) {
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+    }
+    std::sort(masks.begin(), masks.end());
+    masks.erase(std::unique(masks.begin(), masks.end()), masks.end());
+
+    std::string thresholds_section;
+    put_varint(thresholds_section, dictionary.size());
+    for (const auto& values : dictionary) {
+        put_varint(thresholds_section, values.size());
+        uint64_t previous = 0;
+        for (double v : values) {
+            const uint64_t key = double_key(v);
+            put_varint(thresholds_section, key - previous);
+            previous = key;
+        }
+    }
+
+    std::string masks_section;
+    put_varint(masks_section, masks.size());
+    for (uint64_t mask : masks)
+        masks_section.append(reinterpret_cast<const char*>(&mask), sizeof(mask));
+
+    // 3) Nós internos: feature e código no dicionário
+    std::string nodes_section;
+    for (int32_t ref : internal) {
+        const FlatNode& node = nodes[ref];
+        uint64_t code;
+        if (node.is_categorical()) {
+            code = std::lower_bound(masks.begin(), masks.end(), node.category_mask) - masks.begin();
+        } else {
+            const auto& values = dictionary[node.feature()];
+            code = std::lower_bound(values.begin(), values.end(), node.threshold) - values.begin();
+        }
+        put_varint(nodes_section, ((uint64_t)node.feature() << 1) | (node.is_categorical() ? 1 : 0));
+        put_varint(nodes_section, code);
+    }
+
+    // 4) Folhas: classe + 1 empacotada; saídas da tabela em seguida
+    uint64_t max_code = 0;
+    for (int32_t ref : leaves)
+        max_code = std::max<uint64_t>(max_code, (uint64_t)(forest.ref_class(ref) + 1));
+    const int class_bits = bit_width(max_code);
+    BitWriter leaf_classes;
+    for (int32_t ref : leaves)
+        leaf_classes.put((uint64_t)(forest.ref_class(ref) + 1), class_bits);
+    std::string leaf_section;
+    put_varint(leaf_section, class_bits);
+    put_varint(leaf_section, leaf_classes.bytes.size());
+    leaf_section += leaf_classes.bytes;
+    if (leaf_width)
+        for (int32_t ref : leaves)
+            leaf_section.append(reinterpret_cast<const char*>(forest.leaf_output(~ref - 1)),
+                                sizeof(float) * leaf_width);
+
+    // 5) Arquivo: assinatura, versão, tamanho do corpo e o corpo
+    std::string body;
+    put_varint(body, forest.get_num_trees());
+    put_varint(body, num_classes);
+    put_varint(body, (uint64_t)leaf_mode);
+    put_varint(body, leaf_width);
+    put_varint(body, internal.size());
+    put_varint(body, leaves.size());
+    for (const std::string* section : {&thresholds_section, &masks_section, &structure.bytes,
+                                       &nodes_section, &leaf_section}) {
+        put_varint(body, section->size());
+        body += *section;
+    }
+
+    const uint64_t body_size = body.size();
+    out.write(COMPACT_MAGIC, sizeof(COMPACT_MAGIC));
+    out.write(reinterpret_cast<const char*>(&COMPACT_VERSION), sizeof(COMPACT_VERSION));
+    out.write(reinterpret_cast<const char*>(&body_size), sizeof(body_size));
+    out.write(body.data(), body.size());
+    if (!out)
+        throw std::runtime_error("Erro ao gravar o modelo compacto");
+}
+
+bool CompactModel::is_compact(std::istream& in)
+{
+    char magic[sizeof(COMPACT_MAGIC)] = {};
+    const std::streampos start = in.tellg();
+    in.read(magic, sizeof(magic));
+    const bool match = in.gcount() == (std::streamsize)sizeof(magic) &&
+                       std::memcmp(magic, COMPACT_MAGIC, sizeof(magic)) == 0;
+    in.clear();
+    in.seekg(start);
+    return match;
+}
+
+// ============================================================
+// Leitura: um buffer, vetores da FlatForest dimensionados pelo
+// cabeçalho e preenchidos em pré-ordem por uma pilha de pendências
+// ============================================================
+void CompactModel::read(std::istream& in, FlatForest& forest, int& num_classes, LeafMode& leaf_mode)
+{
+    char magic[sizeof(COMPACT_MAGIC)];
+    uint8_t version = 0;
+    uint64_t body_size = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&body_size), sizeof(body_size));
+    if (!in || std::memcmp(magic, COMPACT_MAGIC, sizeof(magic)) != 0)
+        throw std::runtime_error("Assinatura de modelo compacto invalida");
+    if (version != COMPACT_VERSION)
+        throw std::runtime_error("Versao de modelo compacto nao suportada: " + std::to_string(version));
+
+    // Corpo lido em blocos: um body_size corrompido não vira uma alocação
+    // enorme antes de o arquivo acabar
+    const uint64_t CHUNK = 1 << 20;
+    std::vector<uint8_t> body;
+    while (body.size() < body_size) {
+        const size_t done = body.size();
+        const size_t want = (size_t)std::min<uint64_t>(CHUNK, body_size - done);
+        body.resize(done + want);
+        in.read(reinterpret_cast<char*>(body.data() + done), want);
+        if ((size_t)in.gcount() != want)
+            throw std::runtime_error("Modelo compacto truncado");
+    }
+
+    ByteReader reader{body.data(), body.data() + body.size()};
+    const uint64_t n_trees = reader.varint();
+    const uint64_t classes = reader.varint();
+    if (classes > (uint64_t)std::numeric_limits<int>::max())
+        throw std::runtime_error("Numero de classes invalido no modelo compacto");
+    num_classes = (int)classes;
+    const uint64_t mode = reader.varint();
+    if (mode > (uint64_t)LeafMode::Regression)
+        throw std::runtime_error("Modo de folha invalido no modelo compacto");
+    leaf_mode = (LeafMode)mode;
+    const uint64_t width = reader.varint();
+    const uint64_t n_internal = reader.varint();
+    const uint64_t n_leaves = reader.varint();
+    if (n_trees > n_leaves || n_leaves != n_internal + n_trees)
+        throw std::runtime_error("Contagem de nos inconsistente no modelo compacto");
+    if (width > (uint64_t)std::max(num_classes, 1))
+        throw std::runtime_error("Largura de folha invalida no modelo compacto");
+    const int leaf_width = (int)width;
+
+    // Dicionários
+    // Toda contagem lida do arquivo é conferida contra os bytes que
+    // restam na sua seção antes de virar alocação (cada item ocupa >= 1
+    // byte)
+    ByteReader thresholds_reader = reader.section();
+    std::vector<double> thresholds;
+    const uint64_t n_dictionaries = thresholds_reader.varint();
+    if (n_dictionaries > thresholds_reader.remaining())
+        throw std::runtime_error("Dicionarios invalidos no modelo compacto");
+    std::vector<uint64_t> dictionary_offset(n_dictionaries + 1, 0);
+    for (size_t f = 0; f + 1 < dictionary_offset.size(); f++) {
+        const uint64_t count = thresholds_reader.varint();
+        if (count > thresholds_reader.remaining())
+            throw std::runtime_error("Dicionarios invalidos no modelo compacto");
+        dictionary_offset[f + 1] = dictionary_offset[f] + count;
+        uint64_t key = 0;
+        for (uint64_t k = 0; k < count; k++) {
+            key += thresholds_reader.varint();
+            thresholds.push_back(key_double(key));
+        }
+    }
+    ByteReader masks_reader = reader.section();
+    const uint64_t n_masks = masks_reader.varint();
+    if (n_masks > masks_reader.remaining() / sizeof(uint64_t))
+        throw std::runtime_error("Modelo compacto truncado");
+    std::vector<uint64_t> masks(n_masks);
+    masks_reader.raw(masks.data(), masks.size() * sizeof(uint64_t));
+
+    ByteReader structure_reader = reader.section();
+    BitReader structure{structure_reader.pos, (uint64_t)(structure_reader.end - structure_reader.pos) * 8};
+    ByteReader node_reader = reader.section();
+    // um bit de estrutura por nó e dois varints por nó interno
+    if (n_leaves > structure.n_bits || n_internal > (structure.n_bits - n_leaves) ||
+        n_internal > node_reader.remaining() / 2)
+        throw std::runtime_error("Modelo compacto truncado");
+    ByteReader leaf_reader = reader.section();
+    const uint64_t class_bits = leaf_reader.varint();
+    const uint64_t class_bytes = leaf_reader.varint();
+    if (class_bits > 32 || class_bytes > leaf_reader.remaining() ||
+        (leaf_width && n_leaves > (leaf_reader.remaining() - class_bytes) / (leaf_width * sizeof(float))))
+        throw std::runtime_error("Modelo compacto truncado");
+    BitReader leaf_classes{leaf_reader.pos, class_bytes * 8};
+    const uint8_t* leaf_values = leaf_reader.pos + class_bytes;
+
+    // Vetores da FlatForest no tamanho final
+    forest.clear();
+    forest.nodes.resize(n_internal);
+    forest.roots.reserve(n_trees);
+    forest.leaf_width = leaf_width;
+    if (leaf_width) {
+        forest.leaf_classes.resize(n_leaves);
+        forest.leaf_values.resize(n_leaves * leaf_width);
+        std::memcpy(forest.leaf_values.data(), leaf_values, n_leaves * leaf_width * sizeof(float));
+    }
+
+    // Pendência = posição que recebe a próxima referência da pré-ordem
+    // (parent < 0: raiz da árvore)
+    struct Slot { int32_t parent; int side; };
+    std::vector<Slot> pending;
+    pending.reserve(64);
+    int32_t next_node = 0, next_leaf = 0;
+    for (uint64_t t = 0; t < n_trees; t++) {
+        pending.assign(1, Slot{-1, 0});
+        while (!pending.empty()) {
+            const Slot slot = pending.back();
+            pending.pop_back();
+
+            int32_t ref;
+            if (structure.get(1)) {
+                if ((uint64_t)next_node >= n_internal)
+                    throw std::runtime_error("Estrutura invalida no modelo compacto");
+                ref = next_node++;
+                const uint64_t feature_code = node_reader.varint();
+                const uint64_t code = node_reader.varint();
+                if ((feature_code >> 1) > (uint64_t)std::numeric_limits<int>::max())
+                    throw std::runtime_error("Feature invalida no modelo compacto");
+                const int feature = (int)(feature_code >> 1);
+                FlatNode& node = forest.nodes[ref];
+                if (feature_code & 1) {
+                    if (code >= masks.size())
+                        throw std::runtime_error("Mascara invalida no modelo compacto");
+                    node.category_mask = masks[code];
+                    node.feature_index = ~feature;
+                } else {
+                    if ((size_t)feature + 1 >= dictionary_offset.size() ||
+                        code >= dictionary_offset[feature + 1] - dictionary_offset[feature])
+                        throw std::runtime_error("Threshold invalido no modelo compacto");
+                    node.threshold = thresholds[dictionary_offset[feature] + code];
+                    node.feature_index = feature;
+                }
+                pending.push_back(Slot{ref, 1});
+                pending.push_back(Slot{ref, 0});
+            } else {
+                if ((uint64_t)next_leaf >= n_leaves)
+                    throw std::runtime_error("Estrutura invalida no modelo compacto");
+                // classe + 1 no arquivo (0 = sem classe, ex: regressão)
+                const uint64_t stored_class = leaf_classes.get((int)class_bits);
+                if (stored_class > (uint64_t)num_classes)
+                    throw std::runtime_error("Classe de folha invalida no modelo compacto");
+                const int cls = (int)stored_class - 1;
+                if (leaf_width) {
+                    forest.leaf_classes[next_leaf] = cls;
+                    ref = FlatForest::leaf_ref(next_leaf);
+                } else {
+                    ref = FlatForest::leaf_ref(cls);
+                }
+                next_leaf++;
+            }
+
+            if (slot.parent < 0) forest.roots.push_back(ref);
+            else                 forest.nodes[slot.parent].child[slot.side] = ref;
+        }
+    }
+    if ((uint64_t)next_node != n_internal || (uint64_t)next_leaf != n_leaves)
+        throw std::runtime_error("Estrutura invalida no modelo compacto");
+}
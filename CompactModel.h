@@ -0,0 +1,43 @@
+#ifndef COMPACT_MODEL_H
+#define COMPACT_MODEL_H
+
+#include <iostream>
+#include "FlatForest.h"
+
+// ------------------------------------------------------------
+// CompactModel
+// Formato compacto (somente inferência) da forma achatada, para
+// distribuir florestas grandes. Tudo little-endian; inteiros em varint
+// (7 bits por byte). Seções, cada uma precedida do seu tamanho em bytes:
+//
+//   cabeçalho   "RFCM", versão (1 byte); varints: árvores, classes,
+//               modo das folhas, largura das folhas, nós internos, folhas
+//   thresholds  por feature: contagem e os thresholds distintos em ordem
+//               crescente, como delta da chave monotônica dos bits do
+//               double (valores próximos viram deltas pequenos)
+//   máscaras    máscaras categóricas distintas (u64 cada)
+//   estrutura   1 bit por nó, em pré-ordem árvore a árvore
+//               (1 = interno, 0 = folha)
+//   nós         por nó interno: varint (feature << 1 | categórico) e
+//               varint do código no dicionário (posto do threshold ou
+//               índice da máscara)
+//   folhas      classe + 1 empacotada em bits (0 = árvore vazia); com
+//               tabela de saídas, leaf_width floats por folha
+//
+// A leitura carrega o arquivo inteiro num buffer e monta os vetores da
+// FlatForest (em pré-ordem) com laços sobre os fluxos, sem alocação por
+// nó. Lança std::runtime_error em arquivo truncado ou inválido.
+// ------------------------------------------------------------
+class CompactModel {
+public:
+    using LeafMode = DecisionTree::LeafMode;
+
+    static void write(const FlatForest& forest, int num_classes, LeafMode leaf_mode,
+                      std::ostream& out);
+    static void read(std::istream& in, FlatForest& forest, int& num_classes, LeafMode& leaf_mode);
+
+    // Confere a assinatura sem consumir o fluxo
+    static bool is_compact(std::istream& in);
+};
+
+#endif // COMPACT_MODEL_H
@@ -0,0 +1,207 @@
+#include "CompleteForest.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// ============================================================
+// Travessia desenrolada: D constante, sem desvio de folha
+// ============================================================
+template <int D>
+inline int CompleteForest::leaf_of(const double* thresholds, const int32_t* features,
+                                   const double* sample)
+{
+    int idx = 0;
+#pragma GCC unroll 16
+    for (int d = 0; d < D; d++)
+        idx = 2 * idx + 1 + !(sample[features[idx]] <= thresholds[idx]);
+    return idx - ((1 << D) - 1);
+}
+
+template <int D>
+void CompleteForest::vote_group(const CompleteForest& forest, const double* sample, int* votes)
+{
+    const int end = forest.depth_begin[D + 1];
+    for (int t = forest.depth_begin[D]; t < end; t++) {
+        const int leaf = leaf_of<D>(forest.thresholds.data() + forest.node_offset[t],
+                                    forest.features.data() + forest.node_offset[t], sample);
+        const int pred = forest.leaves[forest.leaf_offset[t] + leaf];
+        if (pred >= 0 && pred < forest.num_classes) votes[pred]++;
+    }
+}
+
+const CompleteForest::GroupFn CompleteForest::group_table[MAX_DEPTH + 1] = {
+    &vote_group<0>,  &vote_group<1>,  &vote_group<2>,  &vote_group<3>,
+    &vote_group<4>,  &vote_group<5>,  &vote_group<6>,  &vote_group<7>,
+    &vote_group<8>,  &vote_group<9>,  &vote_group<10>, &vote_group<11>,
+    &vote_group<12>, &vote_group<13>, &vote_group<14>, &vote_group<15>,
+    &vote_group<16>,
+};
+
+// ============================================================
+// Construção: profundidade de cada árvore, agrupamento e preenchimento
+// ============================================================
+void CompleteForest::build(const FlatForest& forest, int n_classes)
+{
+    const std::vector<FlatNode>& flat_nodes = forest.get_nodes();
+    const std::vector<int32_t>& flat_roots = forest.get_roots();
+    const int n_trees = flat_roots.size();
+    num_classes = n_classes;
+    real_nodes = flat_nodes.size();
+
+    // profundidade de cada árvore (folhas não ocupam nós na FlatForest)
+    std::vector<int> depth_of(n_trees, 0);
+    std::vector<std::pair<int32_t, int>> stack;
+    for (int t = 0; t < n_trees; t++) {
+        stack.assign(1, {flat_roots[t], 0});
+        while (!stack.empty()) {
+            const auto [ref, level] = stack.back();
+            stack.pop_back();
+            if (FlatForest::is_leaf_ref(ref)) {
+                depth_of[t] = std::max(depth_of[t], level);
+                continue;
+            }
+            const FlatNode& node = flat_nodes[ref];
+            if (node.is_categorical())
+                throw std::runtime_error("Arvore completa nao suporta splits categoricos");
+            if (level + 1 > MAX_DEPTH)
+                throw std::runtime_error("Arvore mais funda que " + std::to_string(MAX_DEPTH) +
+                                         " niveis para a forma completa");
+            stack.push_back({node.child[0], level + 1});
+            stack.push_back({node.child[1], level + 1});
+        }
+    }
+
+    // agrupamento estável por profundidade (votos não dependem da ordem)
+    std::vector<int> order(n_trees);
+    for (int t = 0; t < n_trees; t++) order[t] = t;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](int a, int b) { return depth_of[a] < depth_of[b]; });
+
+    size_t total_nodes = 0, total_leaves = 0;
+    for (int t = 0; t < n_trees; t++) {
+        total_nodes += (size_t(1) << depth_of[t]) - 1;
+        total_leaves += size_t(1) << depth_of[t];
+    }
+    if (total_leaves > (size_t)std::numeric_limits<int32_t>::max())
+        throw std::runtime_error("Forma completa grande demais (indices int32)");
+
+    thresholds.assign(total_nodes, 0.0);
+    features.assign(total_nodes, 0);
+    leaves.assign(total_leaves, -1);
+    tree_depth.resize(n_trees);
+    node_offset.resize(n_trees);
+    leaf_offset.resize(n_trees);
+    tree_position.resize(n_trees);
+    std::fill(std::begin(depth_begin), std::end(depth_begin), n_trees);
+
+    size_t next_node = 0, next_leaf = 0;
+    for (int k = n_trees - 1; k >= 0; k--)
+        depth_begin[depth_of[order[k]]] = k;
+    for (int d = MAX_DEPTH; d >= 0; d--)
+        depth_begin[d] = std::min(depth_begin[d], depth_begin[d + 1]);
+
+    for (int k = 0; k < n_trees; k++) {
+        const int t = order[k];
+        const int depth = depth_of[t];
+        tree_position[t] = k;
+        tree_depth[k] = depth;
+        node_offset[k] = next_node;
+        leaf_offset[k] = next_leaf;
+        fill(forest, flat_roots[t], 0, 0, depth, thresholds.data() + next_node,
+             features.data() + next_node, leaves.data() + next_leaf);
+        next_node += (size_t(1) << depth) - 1;
+        next_leaf += size_t(1) << depth;
+    }
+}
+
+// Nó da origem na posição implícita pos; uma folha acima do último
+// nível vira nós de preenchimento (+inf: tudo à esquerda, NaN à
+// direita) com a mesma classe em todas as folhas abaixo
+void CompleteForest::fill(const FlatForest& forest, int32_t ref, int32_t pos, int level, int depth,
+                          double* node_thr, int32_t* node_feat, int32_t* tree_leaves)
+{
+    if (level == depth) {
+        tree_leaves[pos - ((1 << depth) - 1)] = forest.ref_class(ref);
+        return;
+    }
+    int32_t left = ref, right = ref;
+    if (FlatForest::is_leaf_ref(ref)) {
+        node_thr[pos] = std::numeric_limits<double>::infinity();
+        node_feat[pos] = 0;
+    } else {
+        const FlatNode& node = forest.get_nodes()[ref];
+        node_thr[pos] = node.threshold;
+        node_feat[pos] = node.feature_index;
+        left = node.child[0];
+        right = node.child[1];
+    }
+    fill(forest, left, 2 * pos + 1, level + 1, depth, node_thr, node_feat, tree_leaves);
+    fill(forest, right, 2 * pos + 2, level + 1, depth, node_thr, node_feat, tree_leaves);
+}
+
+int CompleteForest::get_max_tree_depth() const
+{
+    return tree_depth.empty() ? 0 : *std::max_element(tree_depth.begin(), tree_depth.end());
+}
+
+size_t CompleteForest::memory_bytes() const
+{
+    return thresholds.size() * sizeof(double) + features.size() * sizeof(int32_t) +
+           leaves.size() * sizeof(int32_t) +
+           tree_depth.size() * (sizeof(uint8_t) + 2 * sizeof(int32_t));
+}
+
+// ============================================================
+// Predição
+// ============================================================
+int CompleteForest::predict_tree(int t, const double* sample) const
+{
+    const int k = tree_position[t];
+    const double* thr = thresholds.data() + node_offset[k];
+    const int32_t* feat = features.data() + node_offset[k];
+    int leaf = 0;
+    switch (tree_depth[k]) {
+        case 0:  leaf = leaf_of<0>(thr, feat, sample);  break;
+        case 1:  leaf = leaf_of<1>(thr, feat, sample);  break;
+        case 2:  leaf = leaf_of<2>(thr, feat, sample);  break;
+        case 3:  leaf = leaf_of<3>(thr, feat, sample);  break;
+        case 4:  leaf = leaf_of<4>(thr, feat, sample);  break;
+        case 5:  leaf = leaf_of<5>(thr, feat, sample);  break;
+        case 6:  leaf = leaf_of<6>(thr, feat, sample);  break;
+        case 7:  leaf = leaf_of<7>(thr, feat, sample);  break;
+        case 8:  leaf = leaf_of<8>(thr, feat, sample);  break;
+        case 9:  leaf = leaf_of<9>(thr, feat, sample);  break;
+        case 10: leaf = leaf_of<10>(thr, feat, sample); break;
+        case 11: leaf = leaf_of<11>(thr, feat, sample); break;
+        case 12: leaf = leaf_of<12>(thr, feat, sample); break;
+        case 13: leaf = leaf_of<13>(thr, feat, sample); break;
+        case 14: leaf = leaf_of<14>(thr, feat, sample); break;
+        case 15: leaf = leaf_of<15>(thr, feat, sample); break;
+        default: leaf = leaf_of<16>(thr, feat, sample); break;
+    }
+    return leaves[leaf_offset[k] + leaf];
+}
+
+std::vector<int> CompleteForest::predict(const std::vector<std::vector<double>>& X) const
+{
+    std::vector<int> predictions;
+    predictions.reserve(X.size());
+    std::vector<int> votes(num_classes);   // local: predict concorrente no mesmo modelo
+
+    // só os grupos não vazios
+    std::vector<int> groups;
+    for (int d = 0; d <= MAX_DEPTH; d++)
+        if (depth_begin[d] < depth_begin[d + 1]) groups.push_back(d);
+
+    for (const auto& sample : X) {
+        std::fill(votes.begin(), votes.end(), 0);
+        for (int d : groups)
+            group_table[d](*this, sample.data(), votes.data());
+
+        predictions.push_back(FlatForest::majority_class(votes.data(), num_classes));
+    }
+    return predictions;
+}
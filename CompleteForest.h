@@ -0,0 +1,70 @@
+#ifndef COMPLETE_FOREST_H
+#define COMPLETE_FOREST_H
+
+#include <vector>
+#include <cstdint>
+#include "FlatForest.h"
+
+// ------------------------------------------------------------
+// CompleteForest
+// Modelo somente de inferência derivado da FlatForest: cada árvore vira
+// uma árvore binária completa implícita de profundidade D (a da própria
+// árvore), com os filhos do nó i em 2i+1 e 2i+2. Folhas rasas são
+// replicadas até o último nível (nós de preenchimento com threshold
+// +inf), então a travessia não tem ponteiros nem teste de folha:
+//
+//     idx = 2*idx + 1 + !(x[f] <= t)      (D vezes, NaN à direita)
+//
+// O laço é desenrolado por um template na profundidade (0..16); as
+// árvores ficam agrupadas por profundidade e cada grupo é percorrido
+// por uma só instância. O preço é memória: 2^D - 1 nós por árvore,
+// usados ou não. Mesmas predições da floresta; só splits numéricos e
+// votos de classe (lança std::runtime_error com splits categóricos ou
+// árvores mais fundas que MAX_DEPTH).
+// ------------------------------------------------------------
+class CompleteForest {
+public:
+    static constexpr int MAX_DEPTH = 16;
+
+    CompleteForest() = default;
+
+    void build(const FlatForest& forest, int num_classes);
+
+    std::vector<int> predict(const std::vector<std::vector<double>>& X) const;
+    // Voto da árvore t (na ordem da FlatForest)
+    int predict_tree(int t, const double* sample) const;
+
+    int get_num_trees() const            { return tree_depth.size(); }
+    int get_max_tree_depth() const;
+    size_t get_num_slots() const         { return thresholds.size(); }   // nós, com preenchimento
+    size_t get_num_real_nodes() const    { return real_nodes; }          // nós internos da origem
+    // Bytes percorridos na inferência (nós + folhas + índices das árvores)
+    size_t memory_bytes() const;
+
+private:
+    // Nós de todas as árvores em sequência (SoA), árvores agrupadas por
+    // profundidade crescente
+    std::vector<double> thresholds;
+    std::vector<int32_t> features;
+    std::vector<int32_t> leaves;           // classe de cada folha do último nível
+    std::vector<uint8_t> tree_depth;       // por árvore, na ordem agrupada
+    std::vector<int32_t> node_offset;
+    std::vector<int32_t> leaf_offset;
+    std::vector<int32_t> tree_position;    // árvore original -> posição agrupada
+    int depth_begin[MAX_DEPTH + 2] = {};   // grupo de profundidade d: [begin[d], begin[d+1])
+
+    int num_classes = 0;
+    size_t real_nodes = 0;
+
+    template <int D>
+    static int leaf_of(const double* thresholds, const int32_t* features, const double* sample);
+    template <int D>
+    static void vote_group(const CompleteForest& forest, const double* sample, int* votes);
+    using GroupFn = void (*)(const CompleteForest&, const double*, int*);
+    static const GroupFn group_table[MAX_DEPTH + 1];
+
+    void fill(const FlatForest& forest, int32_t ref, int32_t pos, int level, int depth,
+              double* node_thr, int32_t* node_feat, int32_t* tree_leaves);
+};
+
+#endif // COMPLETE_FOREST_H
@@ -0,0 +1,123 @@
+#include "CrossValidation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+CrossValidation::CrossValidation(int n_folds, unsigned int seed)
+    : n_folds(n_folds), seed(seed)
+{
+    if (n_folds < 2)
+        throw std::invalid_argument("validacao cruzada exige pelo menos 2 folds");
+}
+
+std::vector<int> CrossValidation::make_permutation(int n_samples) const
+{
+    std::vector<int> permutation(n_samples);
+    std::iota(permutation.begin(), permutation.end(), 0);
+    std::mt19937 gen(seed);
+    std::shuffle(permutation.begin(), permutation.end(), gen);
+    return permutation;
+}
+
+void CrossValidation::fold_rows(const std::vector<int>& permutation, int fold,
+                                std::vector<int>& train_rows,
+                                std::vector<int>& test_rows) const
+{
+    const long long n = permutation.size();
+    const int begin = (int)(fold * n / n_folds);
+    const int end = (int)((fold + 1) * n / n_folds);
+
+    test_rows.assign(permutation.begin() + begin, permutation.begin() + end);
+    train_rows.clear();
+    train_rows.reserve(n - (end - begin));
+    train_rows.insert(train_rows.end(), permutation.begin(), permutation.begin() + begin);
+    train_rows.insert(train_rows.end(), permutation.begin() + end, permutation.end());
+
+    // ordem crescente: leitura das colunas em sequência
+    std::sort(test_rows.begin(), test_rows.end());
+    std::sort(train_rows.begin(), train_rows.end());
+}
+
+CrossValidation::Report CrossValidation::run(const std::vector<std::vector<double>>& X_col,
+                                             const std::vector<int>& y,
+                                             const ForestFactory& make_forest,
+                                             ThreadPool& pool) const
+{
+    if (X_col.empty() || X_col[0].size() != y.size())
+        throw std::invalid_argument("dataset column-major e labels com tamanhos diferentes");
+    const int n_samples = y.size();
+    if (n_samples < n_folds)
+        throw std::invalid_argument("menos linhas que folds");
+
+    // Crescimento por nível: uma pré-ordenação do dataset inteiro serve
+    // a todos os folds (as árvores só visitam as suas linhas)
+    ColumnOrder presorted;
+    {
+        std::unique_ptr<RandomForestOptimized> probe = make_forest();
+        if (probe->get_level_wise() && !probe->get_extra_trees() &&
+            probe->get_categorical_features().empty())
+            DecisionTree::presort_columns(X_col, std::vector<char>(X_col.size(), 0), presorted);
+    }
+
+    const std::vector<int> permutation = make_permutation(n_samples);
+
+    Report report;
+    report.folds.resize(n_folds);
+    auto wall_start = std::chrono::steady_clock::now();
+
+    pool.parallel_for(n_folds, [&](int fold) {
+        std::vector<int> train_rows, test_rows;
+        fold_rows(permutation, fold, train_rows, test_rows);
+
+        std::unique_ptr<RandomForestOptimized> forest = make_forest();
+        forest->set_thread_pool(&pool);
+        forest->set_seed(seed + fold);
+
+        auto start = std::chrono::steady_clock::now();
+        forest->fit_rows(X_col, y, train_rows, presorted.empty() ? nullptr : &presorted);
+        auto mid = std::chrono::steady_clock::now();
+        const std::vector<int> pred = forest->predict_rows(X_col, test_rows);
+        auto end = std::chrono::steady_clock::now();
+
+        int correct = 0;
+        for (size_t i = 0; i < test_rows.size(); i++)
+            if (pred[i] == y[test_rows[i]]) correct++;
+
+        FoldResult& result = report.folds[fold];
+        result.fold = fold;
+        result.train_rows = train_rows.size();
+        result.test_rows = test_rows.size();
+        result.accuracy = (double)correct / test_rows.size();
+        result.train_ms = std::chrono::duration<double, std::milli>(mid - start).count();
+        result.predict_ms = std::chrono::duration<double, std::milli>(end - mid).count();
+    });
+
+    report.wall_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - wall_start).count();
+
+    auto mean_std = [&](double FoldResult::*field, double& mean, double& stddev) {
+        mean = 0.0;
+        for (const FoldResult& r : report.folds) mean += r.*field;
+        mean /= n_folds;
+        double var = 0.0;
+        for (const FoldResult& r : report.folds) var += (r.*field - mean) * (r.*field - mean);
+        stddev = std::sqrt(var / (n_folds - 1));
+    };
+    double unused;
+    mean_std(&FoldResult::accuracy, report.mean_accuracy, report.std_accuracy);
+    mean_std(&FoldResult::train_ms, report.mean_train_ms, report.std_train_ms);
+    mean_std(&FoldResult::predict_ms, report.mean_predict_ms, unused);
+
+    for (const auto& column : X_col)
+        report.dataset_bytes += column.size() * sizeof(double);
+    // permutação + (treino + teste) de cada fold que pode estar vivo ao mesmo tempo
+    const int live_folds = std::min(n_folds, pool.size());
+    report.index_bytes = (size_t)n_samples * sizeof(int) * (1 + live_folds);
+    for (const auto& column : presorted)
+        report.index_bytes += column.size() * sizeof(SortedEntry);
+    return report;
+}
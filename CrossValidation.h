@@ -0,0 +1,64 @@
+#ifndef CROSS_VALIDATION_H
+#define CROSS_VALIDATION_H
+
+#include "RandomForestOptimized.h"
+#include "ThreadPool.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+// ------------------------------------------------------------
+// CrossValidation
+// Validação cruzada k-fold da floresta otimizada sobre um único dataset
+// column-major compartilhado. Cada fold é só uma lista de índices
+// (linhas de treino e de teste) montada pela própria tarefa a partir de
+// uma permutação comum: a memória do dataset não cresce com k. Os folds
+// treinam em paralelo no mesmo pool das árvores (parallel_for aninhado).
+// ------------------------------------------------------------
+class CrossValidation {
+public:
+    struct FoldResult {
+        int fold = 0;
+        int train_rows = 0;
+        int test_rows = 0;
+        double accuracy = 0.0;
+        double train_ms = 0.0;
+        double predict_ms = 0.0;
+    };
+
+    struct Report {
+        std::vector<FoldResult> folds;
+        double mean_accuracy = 0.0;
+        double std_accuracy = 0.0;       // desvio padrão amostral entre folds
+        double mean_train_ms = 0.0;
+        double std_train_ms = 0.0;
+        double mean_predict_ms = 0.0;
+        double wall_ms = 0.0;            // tempo total (folds simultâneos)
+        size_t dataset_bytes = 0;        // colunas compartilhadas
+        size_t index_bytes = 0;          // permutação + índices dos folds
+    };
+
+    // Cria a floresta de um fold (hiperparâmetros e opções); a validação
+    // define a semente (seed + fold) e o pool
+    using ForestFactory = std::function<std::unique_ptr<RandomForestOptimized>()>;
+
+    explicit CrossValidation(int n_folds, unsigned int seed = 42);
+
+    // Linhas de teste do fold = fatia [fold*n/k, (fold+1)*n/k) da
+    // permutação; treino = o resto. Ambas em ordem crescente.
+    std::vector<int> make_permutation(int n_samples) const;
+    void fold_rows(const std::vector<int>& permutation, int fold,
+                   std::vector<int>& train_rows, std::vector<int>& test_rows) const;
+
+    Report run(const std::vector<std::vector<double>>& X_col,
+               const std::vector<int>& y,
+               const ForestFactory& make_forest,
+               ThreadPool& pool) const;
+
+private:
+    int n_folds;
+    unsigned int seed;
+};
+
+#endif // CROSS_VALIDATION_H
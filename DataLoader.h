@@ -7,15 +7,76 @@
 #include <sstream>
 #include <stdexcept>
 #include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "PerfCounters.h"
 
 class DataLoader {
 public:
+    // --------------------------------------------------------
+    // Formato binário colunar (.rfcol), little-endian:
+    //   "RFCOL001" | uint64 n_rows | uint32 n_features | uint32 n_classes
+    //   n_features colunas contíguas de n_rows doubles
+    //   n_rows labels int32
+    // As colunas podem ser escritas em pedaços (seek por offset), então
+    // o gerador não precisa manter o dataset inteiro em memória.
+    // --------------------------------------------------------
+    static constexpr const char* BINARY_MAGIC = "RFCOL001";
+    static const uint64_t BINARY_HEADER_BYTES = 24;
+
+    static uint64_t binary_column_offset(uint64_t n_rows, uint64_t feature, uint64_t row) {
+        return BINARY_HEADER_BYTES + (feature * n_rows + row) * sizeof(double);
+    }
+
+    static uint64_t binary_label_offset(uint64_t n_rows, uint64_t n_features, uint64_t row) {
+        return BINARY_HEADER_BYTES + n_features * n_rows * sizeof(double) + row * sizeof(int32_t);
+    }
+
+    static void write_binary_header(std::ostream& out, uint64_t n_rows,
+                                    uint32_t n_features, uint32_t n_classes) {
+        out.seekp(0);
+        out.write(BINARY_MAGIC, 8);
+        out.write(reinterpret_cast<const char*>(&n_rows), sizeof(n_rows));
+        out.write(reinterpret_cast<const char*>(&n_features), sizeof(n_features));
+        out.write(reinterpret_cast<const char*>(&n_classes), sizeof(n_classes));
+    }
+
+    static bool is_binary(const std::string& filename) {
+        std::ifstream file(filename, std::ios::binary);
+        char magic[8] = {};
+        file.read(magic, 8);
+        return file.gcount() == 8 && std::memcmp(magic, BINARY_MAGIC, 8) == 0;
+    }
+
+    // Carrega CSV ou binário colunar (detectado pelo cabeçalho).
+    // Label int (classificação) ou double (alvo de regressão).
+    // columns (opcional, em ordem crescente): só essas features entram
+    // em X, na ordem dada; as demais não são convertidas (CSV) nem lidas
+    // do disco (binário).
+    template <typename Label>
+    static void load(const std::string& filename,
+                     std::vector<std::vector<double>>& X,
+                     std::vector<Label>& y,
+                     int max_samples = -1,
+                     const std::vector<int>* columns = nullptr) {
+        if (is_binary(filename))
+            load_binary(filename, X, y, max_samples, columns);
+        else
+            load_csv(filename, X, y, max_samples, columns);
+    }
+
     // Carrega CSV com número automático de features
     // Última coluna = label, demais = features
+    template <typename Label>
     static void load_csv(const std::string& filename,
                         std::vector<std::vector<double>>& X,
-                        std::vector<int>& y,
-                        int max_samples = -1) {
+                        std::vector<Label>& y,
+                        int max_samples = -1,
+                        const std::vector<int>* columns = nullptr) {
+        PERF_SCOPE(CsvLoad);
         std::ifstream file(filename);
         if (!file.is_open()) {
             throw std::runtime_error("Não foi possível abrir o arquivo: " + filename);
@@ -29,11 +90,47 @@ public:
         y.clear();
         
         int samples_loaded = 0;
+        std::vector<size_t> field_starts;
         
         while (std::getline(file, line)) {
             if (max_samples > 0 && samples_loaded >= max_samples) {
                 break;
             }
+
+            // Seleção de colunas: só localiza as vírgulas e converte as
+            // colunas escolhidas e o label
+            if (columns) {
+                field_starts.assign(1, 0);
+                for (size_t p = line.find(','); p != std::string::npos; p = line.find(',', p + 1))
+                    field_starts.push_back(p + 1);
+                if (line.empty()) continue;
+
+                const size_t n_fields = field_starts.size();
+                std::vector<double> features;
+                features.reserve(columns->size());
+                for (int c : *columns) {
+                    if (c < 0 || (size_t)c + 1 >= n_fields)
+                        throw std::runtime_error("Coluna " + std::to_string(c) +
+                                                 " fora do arquivo: " + filename);
+                    const char* begin = line.c_str() + field_starts[c];
+                    char* end = nullptr;
+                    features.push_back(std::strtod(begin, &end));
+                    if (end == begin)
+                        throw std::runtime_error("Valor invalido na coluna " + std::to_string(c) +
+                                                 " de " + filename);
+                }
+
+                Label label;
+                parse_label(line.substr(field_starts.back()), label);
+
+                X.push_back(std::move(features));
+                y.push_back(label);
+                samples_loaded++;
+                if (samples_loaded % 100000 == 0) {
+                    std::cout << "  Carregadas " << samples_loaded << " amostras...\n";
+                }
+                continue;
+            }
             
             std::stringstream ss(line);
             std::string value;
@@ -53,7 +150,8 @@ public:
             }
             
             // Última coluna é o label
-            int label = std::stoi(tokens.back());
+            Label label;
+            parse_label(tokens.back(), label);
             
             X.push_back(features);
             y.push_back(label);
@@ -67,6 +165,135 @@ public:
         
         file.close();
     }
+
+    // Binário colunar já na forma column-major (sem transposição)
+    template <typename Label>
+    static void load_binary_columns(const std::string& filename,
+                                    std::vector<std::vector<double>>& X_col,
+                                    std::vector<Label>& y,
+                                    int max_samples = -1,
+                                    const std::vector<int>* columns = nullptr) {
+        PERF_SCOPE(CsvLoad);
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Não foi possível abrir o arquivo: " + filename);
+        }
+
+        char magic[8];
+        uint64_t total_rows = 0;
+        uint32_t n_features = 0, n_classes = 0;
+        file.read(magic, 8);
+        file.read(reinterpret_cast<char*>(&total_rows), sizeof(total_rows));
+        file.read(reinterpret_cast<char*>(&n_features), sizeof(n_features));
+        file.read(reinterpret_cast<char*>(&n_classes), sizeof(n_classes));
+        if (!file || std::memcmp(magic, BINARY_MAGIC, 8) != 0) {
+            throw std::runtime_error("Arquivo binário inválido: " + filename);
+        }
+
+        uint64_t n_rows = total_rows;
+        if (max_samples > 0) n_rows = std::min<uint64_t>(n_rows, max_samples);
+
+        // Colunas a ler (com seleção, as outras são puladas pelo seek)
+        std::vector<int> selected;
+        if (columns) {
+            selected = *columns;
+            for (int c : selected)
+                if (c < 0 || (uint32_t)c >= n_features)
+                    throw std::runtime_error("Coluna " + std::to_string(c) +
+                                             " fora do arquivo: " + filename);
+        } else {
+            for (uint32_t f = 0; f < n_features; f++) selected.push_back(f);
+        }
+
+        X_col.assign(selected.size(), std::vector<double>(n_rows));
+        for (size_t k = 0; k < selected.size(); k++) {
+            file.seekg(binary_column_offset(total_rows, selected[k], 0));
+            file.read(reinterpret_cast<char*>(X_col[k].data()), n_rows * sizeof(double));
+        }
+
+        std::vector<int32_t> labels(n_rows);
+        file.seekg(binary_label_offset(total_rows, n_features, 0));
+        file.read(reinterpret_cast<char*>(labels.data()), n_rows * sizeof(int32_t));
+        if (!file) {
+            throw std::runtime_error("Arquivo binário truncado: " + filename);
+        }
+        y.assign(labels.begin(), labels.end());
+    }
+
+    template <typename Label>
+    static void load_binary(const std::string& filename,
+                            std::vector<std::vector<double>>& X,
+                            std::vector<Label>& y,
+                            int max_samples = -1,
+                            const std::vector<int>* columns = nullptr) {
+        std::vector<std::vector<double>> X_col;
+        load_binary_columns(filename, X_col, y, max_samples, columns);
+
+        PERF_SCOPE(Transpose);
+        const size_t n_rows = y.size();
+        const size_t n_features = X_col.size();
+        X.assign(n_rows, std::vector<double>(n_features));
+        for (size_t f = 0; f < n_features; ++f) {
+            const double* col = X_col[f].data();
+            for (size_t i = 0; i < n_rows; ++i)
+                X[i][f] = col[i];
+        }
+    }
+
+    // Transpõe para column-major (uma coluna contígua por feature)
+    static void to_column_major(const std::vector<std::vector<double>>& X,
+                                std::vector<std::vector<double>>& X_col) {
+        PERF_SCOPE(Transpose);
+        const size_t n_samples = X.size();
+        const size_t n_features = n_samples > 0 ? X[0].size() : 0;
+
+        X_col.assign(n_features, std::vector<double>(n_samples));
+        for (size_t i = 0; i < n_samples; ++i) {
+            const double* row_ptr = X[i].data();
+            for (size_t j = 0; j < n_features; ++j)
+                X_col[j][i] = row_ptr[j];
+        }
+    }
+
+    // Checksum do conteúdo (FNV-1a por valor de 64 bits, linha a linha):
+    // distingue datasets de mesma forma. O xor-shift após cada produto
+    // leva os bits altos (ex: sinal) para baixo; sem ele, trocas de sinal
+    // aos pares se cancelariam.
+    static uint64_t checksum(const std::vector<std::vector<double>>& X) {
+        uint64_t h = 1469598103934665603ull;
+        for (const auto& row : X) {
+            h = mix_checksum(h, row.size());
+            for (double v : row) {
+                uint64_t bits;
+                std::memcpy(&bits, &v, sizeof(bits));
+                h = mix_checksum(h, bits);
+            }
+        }
+        return h;
+    }
+
+    // Checksum das features e dos labels (int ou double)
+    template <typename Label>
+    static uint64_t checksum(const std::vector<std::vector<double>>& X,
+                             const std::vector<Label>& y) {
+        static_assert(sizeof(Label) <= sizeof(uint64_t), "label de ate 64 bits");
+        uint64_t h = mix_checksum(checksum(X), y.size());
+        for (const Label& label : y) {
+            uint64_t bits = 0;
+            std::memcpy(&bits, &label, sizeof(label));
+            h = mix_checksum(h, bits);
+        }
+        return h;
+    }
+
+    static uint64_t mix_checksum(uint64_t h, uint64_t value) {
+        h = (h ^ value) * 1099511628211ull;
+        return h ^ (h >> 32);
+    }
+
+private:
+    static void parse_label(const std::string& token, int& label)    { label = std::stoi(token); }
+    static void parse_label(const std::string& token, double& label) { label = std::stod(token); }
 };
 
 #endif
@@ -0,0 +1,222 @@
+#include "DatasetGenerator.h"
+#include "DataLoader.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+// ============================================================
+// Construtor: divide as colunas por tipo e sorteia a estrutura
+// fixa do dataset (centróides, pesos redundantes, códigos)
+// ============================================================
+DatasetGenerator::DatasetGenerator(const DatasetSpec& spec_)
+    : spec(spec_)
+{
+    if (spec.n_rows == 0 || spec.n_features < 1)
+        throw std::invalid_argument("dataset precisa de pelo menos 1 linha e 1 feature");
+    if (spec.n_classes < 2)
+        throw std::invalid_argument("dataset precisa de pelo menos 2 classes");
+    if (spec.informative_ratio <= 0.0 || spec.informative_ratio > 1.0 ||
+        spec.redundant_ratio < 0.0 || spec.redundant_ratio >= 1.0)
+        throw std::invalid_argument("frações de informativas/redundantes devem estar em (0,1] e [0,1)");
+    if (spec.label_noise < 0.0 || spec.label_noise > 1.0)
+        throw std::invalid_argument("ruído de label deve estar em [0,1]");
+    if (spec.n_categorical > 0 && spec.cardinality < 2)
+        throw std::invalid_argument("cardinalidade categórica deve ser >= 2");
+
+    n_informative = std::max(1, (int)std::lround(spec.informative_ratio * spec.n_features));
+    n_informative = std::min(n_informative, spec.n_features);
+    n_redundant   = std::min((int)std::lround(spec.redundant_ratio * spec.n_features),
+                             spec.n_features - n_informative);
+    n_categorical = std::min(std::max(0, spec.n_categorical),
+                             spec.n_features - n_informative - n_redundant);
+    n_noise       = spec.n_features - n_informative - n_redundant - n_categorical;
+
+    std::mt19937_64 gen(spec.seed);
+
+    // Centróides em vértices de hipercubo (como make_classification)
+    centroids.resize((size_t)spec.n_classes * n_informative);
+    std::bernoulli_distribution coin(0.5);
+    for (double& c : centroids)
+        c = coin(gen) ? spec.class_sep : -spec.class_sep;
+
+    std::uniform_real_distribution<double> weight(-1.0, 1.0);
+    redundant_weights.resize((size_t)n_redundant * n_informative);
+    for (double& w : redundant_weights)
+        w = weight(gen);
+
+    category_codes.resize((size_t)n_categorical * std::max(0, spec.cardinality));
+    for (int k = 0; k < n_categorical; k++) {
+        auto begin = category_codes.begin() + (size_t)k * spec.cardinality;
+        std::iota(begin, begin + spec.cardinality, 0);
+        std::shuffle(begin, begin + spec.cardinality, gen);
+    }
+}
+
+std::string DatasetGenerator::column_name(int f) const
+{
+    if (f < n_informative) return "inf_" + std::to_string(f);
+    f -= n_informative;
+    if (f < n_redundant) return "red_" + std::to_string(f);
+    f -= n_redundant;
+    if (f < n_categorical) return "cat_" + std::to_string(f);
+    return "noise_" + std::to_string(f - n_categorical);
+}
+
+uint64_t DatasetGenerator::chunk_rows(uint64_t chunk_id) const
+{
+    const uint64_t first = chunk_id * CHUNK_ROWS;
+    return std::min(CHUNK_ROWS, spec.n_rows - first);
+}
+
+// ============================================================
+// Um pedaço de linhas (semente própria: independente dos demais)
+// ============================================================
+void DatasetGenerator::generate_chunk(uint64_t chunk_id,
+                                      std::vector<std::vector<double>>& columns,
+                                      std::vector<int>& labels) const
+{
+    const uint64_t n = chunk_rows(chunk_id);
+    std::mt19937_64 gen(spec.seed ^ (0x9E3779B97F4A7C15ull * (chunk_id + 1)));
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_int_distribution<int> pick_class(0, spec.n_classes - 1);
+
+    columns.resize(spec.n_features);
+    for (auto& col : columns) col.resize(n);
+    labels.resize(n);
+
+    // Faixas das categóricas: [-sep - 2, sep + 2] dividido em cardinality
+    const double cat_low = -spec.class_sep - 2.0;
+    const double cat_width = (2.0 * spec.class_sep + 4.0) / std::max(1, spec.cardinality);
+    const int cat_col = n_informative + n_redundant;
+    const int noise_col = cat_col + n_categorical;
+
+    for (uint64_t i = 0; i < n; i++) {
+        const int label = pick_class(gen);
+        const double* centroid = &centroids[(size_t)label * n_informative];
+
+        for (int j = 0; j < n_informative; j++)
+            columns[j][i] = centroid[j] + normal(gen);
+
+        for (int k = 0; k < n_redundant; k++) {
+            const double* w = &redundant_weights[(size_t)k * n_informative];
+            double v = 0.0;
+            for (int j = 0; j < n_informative; j++) v += w[j] * columns[j][i];
+            columns[n_informative + k][i] = v;
+        }
+
+        for (int k = 0; k < n_categorical; k++) {
+            double v = columns[k % n_informative][i] + 0.5 * normal(gen);
+            int bin = (int)std::floor((v - cat_low) / cat_width);
+            bin = std::min(std::max(bin, 0), spec.cardinality - 1);
+            columns[cat_col + k][i] = category_codes[(size_t)k * spec.cardinality + bin];
+        }
+
+        for (int k = 0; k < n_noise; k++)
+            columns[noise_col + k][i] = normal(gen);
+
+        labels[i] = unit(gen) < spec.label_noise ? pick_class(gen) : label;
+    }
+}
+
+// ============================================================
+// Geração em lotes: um pedaço por tarefa, escrita sequencial
+// ============================================================
+template <typename WriteFn>
+void DatasetGenerator::generate_batches(ThreadPool* pool, WriteFn write) const
+{
+    const uint64_t n_chunks = get_num_chunks();
+    const int batch = pool ? pool->size() : 1;
+    std::vector<Chunk> chunks(batch);
+
+    for (uint64_t first = 0; first < n_chunks; first += batch) {
+        const int count = (int)std::min<uint64_t>(batch, n_chunks - first);
+        auto make = [&](int k) {
+            generate_chunk(first + k, chunks[k].columns, chunks[k].labels);
+        };
+        if (pool) pool->parallel_for(count, make);
+        else      for (int k = 0; k < count; k++) make(k);
+
+        for (int k = 0; k < count; k++)
+            write(first + k, chunks[k]);
+    }
+}
+
+void DatasetGenerator::write_csv(const std::string& filename, ThreadPool* pool) const
+{
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open())
+        throw std::runtime_error("Não foi possível criar o arquivo: " + filename);
+
+    for (int f = 0; f < spec.n_features; f++)
+        out << column_name(f) << ",";
+    out << "label\n";
+
+    std::string buffer;
+    char number[32];
+    generate_batches(pool, [&](uint64_t, const Chunk& chunk) {
+        buffer.clear();
+        const size_t n = chunk.labels.size();
+        for (size_t i = 0; i < n; i++) {
+            // to_chars gera a menor representação que relê o mesmo double
+            for (int f = 0; f < spec.n_features; f++) {
+                auto r = std::to_chars(number, number + sizeof(number), chunk.columns[f][i]);
+                buffer.append(number, r.ptr);
+                buffer.push_back(',');
+            }
+            auto r = std::to_chars(number, number + sizeof(number), chunk.labels[i]);
+            buffer.append(number, r.ptr);
+            buffer.push_back('\n');
+        }
+        out.write(buffer.data(), buffer.size());
+    });
+
+    if (!out)
+        throw std::runtime_error("Erro ao escrever o arquivo: " + filename);
+}
+
+void DatasetGenerator::write_binary(const std::string& filename, ThreadPool* pool) const
+{
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+        throw std::runtime_error("Não foi possível criar o arquivo: " + filename);
+
+    DataLoader::write_binary_header(out, spec.n_rows, spec.n_features, spec.n_classes);
+
+    std::vector<int32_t> labels32;
+    generate_batches(pool, [&](uint64_t chunk_id, const Chunk& chunk) {
+        const uint64_t row0 = chunk_id * CHUNK_ROWS;
+        const size_t n = chunk.labels.size();
+        for (int f = 0; f < spec.n_features; f++) {
+            out.seekp(DataLoader::binary_column_offset(spec.n_rows, f, row0));
+            out.write(reinterpret_cast<const char*>(chunk.columns[f].data()), n * sizeof(double));
+        }
+        labels32.assign(chunk.labels.begin(), chunk.labels.end());
+        out.seekp(DataLoader::binary_label_offset(spec.n_rows, spec.n_features, row0));
+        out.write(reinterpret_cast<const char*>(labels32.data()), n * sizeof(int32_t));
+    });
+
+    if (!out)
+        throw std::runtime_error("Erro ao escrever o arquivo: " + filename);
+}
+
+void DatasetGenerator::generate(std::vector<std::vector<double>>& X, std::vector<int>& y) const
+{
+    X.assign(spec.n_rows, std::vector<double>(spec.n_features));
+    y.resize(spec.n_rows);
+
+    generate_batches(nullptr, [&](uint64_t chunk_id, const Chunk& chunk) {
+        const uint64_t row0 = chunk_id * CHUNK_ROWS;
+        for (size_t i = 0; i < chunk.labels.size(); i++) {
+            for (int f = 0; f < spec.n_features; f++)
+                X[row0 + i][f] = chunk.columns[f][i];
+            y[row0 + i] = chunk.labels[i];
+        }
+    });
+}
@@ -0,0 +1,94 @@
+#ifndef DATASET_GENERATOR_H
+#define DATASET_GENERATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// ------------------------------------------------------------
+// DatasetGenerator
+// Datasets sintéticos de classificação, reprodutíveis, para curvas de
+// escala (linhas x features x threads) sem depender de dados externos.
+//
+// Colunas, nesta ordem:
+//  - informativas: centróide da classe (vértice de hipercubo, ±class_sep)
+//    + ruído N(0,1)
+//  - redundantes: combinações lineares fixas das informativas
+//  - categóricas: uma informativa discretizada em `cardinality` faixas,
+//    com os códigos embaralhados (0..cardinality-1, sem ordem útil)
+//  - ruído: N(0,1), sem relação com a classe
+// Uma fração `label_noise` das linhas recebe classe sorteada.
+//
+// As linhas são geradas em pedaços de CHUNK_ROWS, cada um com sua
+// própria semente derivada de (seed, pedaço): o conteúdo não depende do
+// formato de saída nem do número de threads.
+// ------------------------------------------------------------
+struct DatasetSpec {
+    uint64_t n_rows = 100000;
+    int n_features = 20;
+    int n_classes = 2;
+    double informative_ratio = 0.5;   // fração das features
+    double redundant_ratio = 0.2;     // fração das features
+    int n_categorical = 0;            // número de colunas categóricas
+    int cardinality = 16;             // categorias por coluna categórica
+    double label_noise = 0.01;
+    double class_sep = 1.0;
+    unsigned int seed = 42;
+};
+
+class DatasetGenerator {
+public:
+    static const uint64_t CHUNK_ROWS = 65536;
+
+    explicit DatasetGenerator(const DatasetSpec& spec);
+
+    const DatasetSpec& get_spec() const { return spec; }
+    int get_num_informative() const     { return n_informative; }
+    int get_num_redundant() const       { return n_redundant; }
+    int get_num_categorical() const     { return n_categorical; }
+    int get_num_noise() const           { return n_noise; }
+    uint64_t get_num_chunks() const     { return (spec.n_rows + CHUNK_ROWS - 1) / CHUNK_ROWS; }
+
+    // Nome da coluna f (inf_*, red_*, cat_*, noise_*)
+    std::string column_name(int f) const;
+
+    // Gera o pedaço chunk_id em column-major (n_features colunas)
+    void generate_chunk(uint64_t chunk_id,
+                        std::vector<std::vector<double>>& columns,
+                        std::vector<int>& labels) const;
+
+    // Escrita em streaming: gera lotes de pedaços em paralelo no pool
+    // (se houver) e escreve em ordem, sem manter o dataset em memória
+    void write_csv(const std::string& filename, ThreadPool* pool = nullptr) const;
+    void write_binary(const std::string& filename, ThreadPool* pool = nullptr) const;
+
+    // Carrega tudo em memória (para testes pequenos)
+    void generate(std::vector<std::vector<double>>& X, std::vector<int>& y) const;
+
+private:
+    DatasetSpec spec;
+    int n_informative;
+    int n_redundant;
+    int n_categorical;
+    int n_noise;
+
+    std::vector<double> centroids;          // n_classes x n_informative
+    std::vector<double> redundant_weights;  // n_redundant x n_informative
+    std::vector<int> category_codes;        // n_categorical x cardinality
+
+    struct Chunk {
+        std::vector<std::vector<double>> columns;
+        std::vector<int> labels;
+    };
+
+    uint64_t chunk_rows(uint64_t chunk_id) const;
+
+    // Gera os pedaços em lotes (um por thread) e chama
+    // write(chunk_id, pedaço) para cada um, em ordem
+    template <typename WriteFn>
+    void generate_batches(ThreadPool* pool, WriteFn write) const;
+};
+
+#endif // DATASET_GENERATOR_H
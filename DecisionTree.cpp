@@ -1,11 +1,15 @@
 #include "DecisionTree.h"
+#include "PerfCounters.h"
+#include "TrainingTrace.h"
 
 #include <algorithm>
+#include <chrono>
 #include <numeric>
 #include <cmath>
 #include <iostream>
 #include <limits>
 #include <random> // Necessário para sortear as features
+#include <stdexcept>
 
 // ============================================================
 // Construtor (Compatibilidade)
@@ -14,7 +18,8 @@ DecisionTree::DecisionTree(int max_depth, int min_samples_split, int chunk_size)
     : root(nullptr),
       max_depth(max_depth),
       min_samples_split(min_samples_split),
-      num_classes(0)
+      num_classes(0),
+      rng(12345)
 {
     (void)chunk_size;
 }
@@ -28,6 +33,22 @@ DecisionTree::DecisionTree(DecisionTree&& other) noexcept
     max_depth = other.max_depth;
     min_samples_split = other.min_samples_split;
     num_classes = other.num_classes;
+    rng = other.rng;
+    trace = other.trace;
+    categorical = std::move(other.categorical);
+    extra_trees = other.extra_trees;
+    max_features = other.max_features;
+    tree_seed = other.tree_seed;
+    level_wise = other.level_wise;
+    presorted_columns = other.presorted_columns;
+    gradient_params = other.gradient_params;
+    grad_stats = other.grad_stats;
+    hess_stats = other.hess_stats;
+    leaf_mode = other.leaf_mode;
+    importance = std::move(other.importance);
+    split_counts = std::move(other.split_counts);
+    leaf_values = std::move(other.leaf_values);
+    reg_targets = other.reg_targets;
 }
 
 DecisionTree& DecisionTree::operator=(DecisionTree&& other) noexcept
@@ -37,6 +58,22 @@ DecisionTree& DecisionTree::operator=(DecisionTree&& other) noexcept
         max_depth = other.max_depth;
         min_samples_split = other.min_samples_split;
         num_classes = other.num_classes;
+        rng = other.rng;
+        trace = other.trace;
+        categorical = std::move(other.categorical);
+        extra_trees = other.extra_trees;
+        max_features = other.max_features;
+        tree_seed = other.tree_seed;
+        level_wise = other.level_wise;
+        presorted_columns = other.presorted_columns;
+        gradient_params = other.gradient_params;
+        grad_stats = other.grad_stats;
+        hess_stats = other.hess_stats;
+        leaf_mode = other.leaf_mode;
+        importance = std::move(other.importance);
+        split_counts = std::move(other.split_counts);
+        leaf_values = std::move(other.leaf_values);
+        reg_targets = other.reg_targets;
     }
     return *this;
 }
@@ -52,26 +89,24 @@ void DecisionTree::fit(const std::vector<std::vector<double>>& X,
     (void)use_chunks;
     if (X.empty()) return;
 
-    // 1. Descobrir num_classes
-    int max_label = 0;
-    for (int label : y) if (label > max_label) max_label = label;
-    num_classes = max_label + 1;
-
-    // 2. Transposição Otimizada (Column-Major)
+    // 1. Transposição Otimizada (Column-Major)
     size_t n_samples = X.size();
     size_t n_features = X[0].size();
     std::vector<std::vector<double>> X_col_major(n_features, std::vector<double>(n_samples));
     
     // Loop blocking para melhorar cache na transposição
     // (Otimização extra caso a matriz seja gigante)
-    for (size_t i = 0; i < n_samples; ++i) {
-        const double* row_ptr = X[i].data();
-        for (size_t j = 0; j < n_features; ++j) {
-            X_col_major[j][i] = row_ptr[j];
+    {
+        PERF_SCOPE(Transpose);
+        for (size_t i = 0; i < n_samples; ++i) {
+            const double* row_ptr = X[i].data();
+            for (size_t j = 0; j < n_features; ++j) {
+                X_col_major[j][i] = row_ptr[j];
+            }
         }
     }
 
-    // 3. Índices
+    // 2. Índices
     std::vector<int> indices;
     if (bootstrap_indices) {
         indices = *bootstrap_indices;
@@ -80,8 +115,96 @@ void DecisionTree::fit(const std::vector<std::vector<double>>& X,
         std::iota(indices.begin(), indices.end(), 0);
     }
 
-    // 4. Construir Recursivamente
-    root = build_tree(X_col_major, y, indices, 0);
+    fit_columns(X_col_major, y, indices);
+}
+
+void DecisionTree::fit_columns(const std::vector<std::vector<double>>& X_col_major,
+                               const std::vector<int>& y,
+                               const std::vector<int>& indices)
+{
+    if (X_col_major.empty() || indices.empty()) return;
+    validate_categorical(X_col_major);
+    reset_split_stats(X_col_major.size());
+
+    // Descobrir num_classes
+    int max_label = 0;
+    for (int label : y) if (label > max_label) max_label = label;
+    num_classes = max_label + 1;
+    if (leaf_mode == LeafMode::Regression) leaf_mode = LeafMode::Class;
+    leaf_values.clear();
+
+    // Construir por nível (colunas pré-ordenadas) ou recursivamente
+    if (can_grow_level_wise())
+        root = build_tree_level_wise(X_col_major, y, indices);
+    else
+        root = build_tree(X_col_major, y, indices, 0);
+}
+
+void DecisionTree::fit_regression_columns(const std::vector<std::vector<double>>& X_col_major,
+                                          const std::vector<double>& targets,
+                                          const std::vector<int>& indices)
+{
+    if (X_col_major.empty() || indices.empty()) return;
+    validate_categorical(X_col_major);
+    reset_split_stats(X_col_major.size());
+
+    num_classes = 0;
+    leaf_mode = LeafMode::Regression;
+    leaf_values.clear();
+
+    // y de classes não é usado na regressão: o alvo vem de reg_targets
+    static const std::vector<int> no_labels;
+    reg_targets = &targets;
+    if (can_grow_level_wise())
+        root = build_tree_level_wise(X_col_major, no_labels, indices);
+    else
+        root = build_tree(X_col_major, no_labels, indices, 0);
+    reg_targets = nullptr;
+}
+
+void DecisionTree::fit_gradient_columns(const std::vector<std::vector<double>>& X_col_major,
+                                        const std::vector<double>& gradients,
+                                        const std::vector<double>& hessians,
+                                        const std::vector<int>& indices,
+                                        const GradientParams& params)
+{
+    if (X_col_major.empty() || indices.empty()) return;
+    validate_categorical(X_col_major);
+    reset_split_stats(X_col_major.size());
+
+    num_classes = 0;
+    leaf_mode = LeafMode::Regression;
+    leaf_values.clear();
+    gradient_params = params;
+
+    static const std::vector<int> no_labels;
+    grad_stats = &gradients;
+    hess_stats = &hessians;
+    if (params.max_leaves > 0)
+        root = build_tree_leaf_wise(X_col_major, indices);
+    else
+        root = build_tree(X_col_major, no_labels, indices, 0);
+    grad_stats = nullptr;
+    hess_stats = nullptr;
+}
+
+// Colunas categóricas precisam de códigos inteiros em [0, 64)
+void DecisionTree::validate_categorical(const std::vector<std::vector<double>>& X_col_major) const
+{
+    validate_categorical_columns(X_col_major, categorical);
+}
+
+void DecisionTree::validate_categorical_columns(const std::vector<std::vector<double>>& X_col_major,
+                                                const std::vector<char>& is_categorical)
+{
+    for (size_t f = 0; f < X_col_major.size() && f < is_categorical.size(); f++) {
+        if (!is_categorical[f]) continue;
+        for (double v : X_col_major[f]) {
+            if (!(v >= 0.0 && v < MAX_CATEGORIES) || v != (double)(int)v)
+                throw std::invalid_argument("coluna categorica " + std::to_string(f) +
+                                            " precisa de codigos inteiros em [0, 64)");
+        }
+    }
 }
 
 // ============================================================
@@ -93,6 +216,16 @@ std::unique_ptr<Node> DecisionTree::build_tree(
     const std::vector<int>& indices,
     int depth)
 {
+    // Telemetria do nível (só com trace ligado)
+    TraceLevel* stats = trace ? &trace->level(depth) : nullptr;
+    if (stats) {
+        stats->nodes++;
+        stats->samples += indices.size();
+    }
+
+    const bool regression = (leaf_mode == LeafMode::Regression);
+    const bool gradient = (grad_stats != nullptr);
+
     // Cálculo rápido de pureza
     int majority = -1;
     int max_c = -1;
@@ -102,62 +235,112 @@ std::unique_ptr<Node> DecisionTree::build_tree(
     std::vector<int> counts(num_classes, 0);
     
     bool is_pure = true;
-    int first_label = y[indices[0]];
+    double impurity = 0.0;
+    double mean = 0.0;
 
-    for (int idx : indices) {
-        int label = y[idx];
-        counts[label]++;
-        if (label != first_label) is_pure = false;
-    }
+    if (gradient) {
+        // Boosting: a folha é o passo de Newton; sem hessiana suficiente
+        // para dois filhos não há split possível
+        double G, H;
+        gradient_sums(indices, G, H);
+        mean = -gradient_params.learning_rate * G / (H + gradient_params.lambda);
+        impurity = gradient_score(G, H);
+        is_pure = H < 2.0 * gradient_params.min_child_weight;
+    } else if (regression) {
+        // Variância do alvo no nó (impureza da regressão)
+        const std::vector<double>& targets = *reg_targets;
+        for (int idx : indices) mean += targets[idx];
+        mean /= indices.size();
+        for (int idx : indices) {
+            const double d = targets[idx] - mean;
+            impurity += d * d;
+        }
+        impurity /= indices.size();
+        is_pure = impurity <= 1e-12;
+    } else {
+        int first_label = y[indices[0]];
 
-    // Descobrir majoritária
-    for(int c = 0; c < num_classes; c++) {
-        if(counts[c] > max_c) {
-            max_c = counts[c];
-            majority = c;
+        for (int idx : indices) {
+            int label = y[idx];
+            counts[label]++;
+            if (label != first_label) is_pure = false;
+        }
+
+        // Descobrir majoritária
+        for(int c = 0; c < num_classes; c++) {
+            if(counts[c] > max_c) {
+                max_c = counts[c];
+                majority = c;
+            }
         }
     }
 
+    auto make_leaf = [&]() {
+        if (stats) stats->leaves++;
+        auto leaf = std::make_unique<Node>();
+        leaf->is_leaf = true;
+        leaf->predicted_class = majority;
+        leaf->n_samples = (int)indices.size();
+
+        // Saída da folha na tabela: média do alvo ou fração de cada classe
+        if (leaf_mode != LeafMode::Class) {
+            leaf->leaf_index = get_num_table_leaves();
+            if (regression) {
+                leaf_values.push_back((float)mean);
+            } else {
+                const double inv_total = 1.0 / indices.size();
+                for (int c = 0; c < num_classes; c++)
+                    leaf_values.push_back((float)(counts[c] * inv_total));
+            }
+        }
+        return leaf;
+    };
+
     // Critérios de Parada (Otimização: Early Exit se for puro)
     if (is_pure || 
         depth >= max_depth || 
         indices.size() < (size_t)min_samples_split) 
     {
-        auto leaf = std::make_unique<Node>();
-        leaf->is_leaf = true;
-        leaf->predicted_class = majority;
-        return leaf;
+        return make_leaf();
     }
 
     // Calcular Gini Inicial
-    double gini = calculate_gini_from_counts(counts, indices.size());
-    if (gini <= 1e-6) { // Praticamente puro
-        auto leaf = std::make_unique<Node>();
-        leaf->is_leaf = true;
-        leaf->predicted_class = majority;
-        return leaf;
+    if (!regression) {
+        impurity = calculate_gini_from_counts(counts, indices.size());
+        if (impurity <= 1e-6) { // Praticamente puro
+            return make_leaf();
+        }
     }
 
     int best_feature = -1;
     double best_threshold = 0.0;
+    uint64_t best_mask = 0;
+    double best_gain = 0.0;
     std::vector<int> left_idx, right_idx;
 
     find_best_split(X_col_major, y, indices, 
                     best_feature, best_threshold, 
-                    left_idx, right_idx, gini);
+                    left_idx, right_idx, impurity, stats, best_mask, best_gain);
 
     if (best_feature == -1 || left_idx.empty() || right_idx.empty()) {
-        auto leaf = std::make_unique<Node>();
-        leaf->is_leaf = true;
-        leaf->predicted_class = majority;
-        return leaf;
+        return make_leaf();
     }
 
+    // Importância: redução de impureza ponderada pelas amostras do nó
+    double decrease = best_gain * indices.size();
+    if (gradient) {
+        decrease = gradient_split_gain(left_idx, right_idx);
+        if (decrease <= gradient_params.min_split_gain) return make_leaf();
+    }
+    record_split(best_feature, decrease);
+
     auto node = std::make_unique<Node>();
     node->is_leaf = false;
     node->feature_index = best_feature;
     node->threshold = best_threshold;
+    node->category_mask = best_mask;
     node->predicted_class = majority;
+    node->n_samples = (int)indices.size();
 
     node->left = build_tree(X_col_major, y, left_idx, depth + 1);
     node->right = build_tree(X_col_major, y, right_idx, depth + 1);
@@ -165,6 +348,28 @@ std::unique_ptr<Node> DecisionTree::build_tree(
     return node;
 }
 
+// ============================================================
+// Sorteio das features do nó (mtry)
+// Em Random Forest, não olhamos todas as features, olhamos sqrt(features).
+// Isso dá um speedup massivo (ex: de 100 colunas para 10).
+// ============================================================
+void DecisionTree::sample_features(size_t n_features, std::mt19937& gen,
+                                   std::vector<int>& candidates, size_t& n_to_check) const
+{
+    n_to_check = std::max((size_t)1, (size_t)std::sqrt(n_features));
+    if (max_features > 0)
+        n_to_check = std::min(n_features, (size_t)max_features);
+
+    candidates.resize(n_features);
+    std::iota(candidates.begin(), candidates.end(), 0);
+
+    // Embaralha parcial (Fisher-Yates parcial é mais rápido que shuffle total)
+    for (size_t i = 0; i < n_to_check; ++i) {
+        std::uniform_int_distribution<size_t> dist(i, n_features - 1);
+        std::swap(candidates[i], candidates[dist(gen)]);
+    }
+}
+
 // ============================================================
 // FIND BEST SPLIT (A VERSÃO VENCEDORA)
 // ============================================================
@@ -176,29 +381,24 @@ void DecisionTree::find_best_split(
     double& best_threshold,
     std::vector<int>& left_idx,
     std::vector<int>& right_idx,
-    double parent_gini)
+    double parent_impurity,
+    TraceLevel* stats,
+    uint64_t& best_mask,
+    double& best_gain)
 {
+    PERF_SCOPE(FindBestSplit);
     size_t n_features = X_col_major.size();
     size_t n_samples = indices.size();
     
-    double best_gain = -1.0;
+    best_gain = -1.0;
     best_feature = -1;
+    best_mask = 0;
 
     // --- OTIMIZAÇÃO 1: Feature Subsampling (mtry) ---
-    // Em Random Forest, não olhamos todas as features, olhamos sqrt(features).
-    // Isso dá um speedup massivo (ex: de 100 colunas para 10).
-    size_t n_features_to_check = std::max((size_t)1, (size_t)std::sqrt(n_features));
-    
-    // Gerador aleatório estático para velocidade (thread_local para thread-safety se necessário)
-    static std::mt19937 rng(12345); 
-    std::vector<int> feature_candidates(n_features);
-    std::iota(feature_candidates.begin(), feature_candidates.end(), 0);
-    
-    // Embaralha parcial (Fisher-Yates parcial é mais rápido que shuffle total)
-    for (size_t i = 0; i < n_features_to_check; ++i) {
-        std::uniform_int_distribution<size_t> dist(i, n_features - 1);
-        std::swap(feature_candidates[i], feature_candidates[dist(rng)]);
-    }
+    // Gerador da própria árvore (semente definida pela floresta)
+    std::vector<int> feature_candidates;
+    size_t n_features_to_check = 0;
+    sample_features(n_features, rng, feature_candidates, n_features_to_check);
 
     // --- OTIMIZAÇÃO 2: Hoisting de Memória ---
     // Aloca FORA do loop para reusar a memória em todas as features
@@ -206,20 +406,84 @@ void DecisionTree::find_best_split(
     std::vector<int> total_counts(num_classes, 0);
     std::vector<int> left_counts(num_classes, 0);
     std::vector<int> right_counts(num_classes, 0);
+    std::vector<int> category_counts;
 
-    // Contagem base (uma vez por nó)
-    for (int idx : indices) total_counts[y[idx]]++;
+    // Contagem base (uma vez por nó). Regressão: somas do alvo centradas
+    // na média do nó (total_sum ~ 0, evita cancelamento numérico)
+    const bool regression = (reg_targets != nullptr);
+    const bool gradient = (grad_stats != nullptr);
+    double node_mean = 0.0, total_sum = 0.0, total_sq = 0.0;
+    double total_g = 0.0, total_h = 0.0;
+    if (gradient) {
+        gradient_sums(indices, total_g, total_h);
+    } else if (regression) {
+        for (int idx : indices) node_mean += (*reg_targets)[idx];
+        node_mean /= n_samples;
+        for (int idx : indices) {
+            const double d = (*reg_targets)[idx] - node_mean;
+            total_sum += d;
+            total_sq += d * d;
+        }
+    } else {
+        for (int idx : indices) total_counts[y[idx]]++;
+    }
+
+    // Telemetria: tempos só são medidos com trace ligado
+    using clock = std::chrono::steady_clock;
+    clock::time_point t_start, t_sorted;
+    long long thresholds_evaluated = 0;
+    long long threshold_positions = 0;
 
     // Loop apenas nas features sorteadas
     for (size_t k = 0; k < n_features_to_check; k++) {
         int f = feature_candidates[k];
         
+        if (stats) t_start = clock::now();
+
+        // Coluna categórica: contagem por categoria, sem ordenar amostras
+        if (is_categorical_feature(f)) {
+            uint64_t mask = best_mask;
+            const long long evaluated_before = thresholds_evaluated;
+            const bool improved = gradient
+                ? find_best_category_split_gradient(X_col_major[f], indices, parent_impurity,
+                                                    best_gain, mask, thresholds_evaluated)
+                : regression
+                ? find_best_category_split_mse(X_col_major[f], indices, node_mean,
+                                               parent_impurity, best_gain, mask,
+                                               thresholds_evaluated)
+                : find_best_category_split(X_col_major[f], y, indices, total_counts,
+                                           parent_impurity, category_counts,
+                                           best_gain, mask, thresholds_evaluated);
+            if (improved) {
+                best_feature = f;
+                best_mask = mask;
+            }
+            threshold_positions += thresholds_evaluated - evaluated_before;
+            if (stats)
+                stats->scan_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - t_start).count();
+            continue;
+        }
+
+        // ExtraTrees: threshold sorteado, sem gather nem sort
+        if (extra_trees && !gradient) {
+            if (find_random_split(X_col_major[f], y, indices, total_counts, node_mean,
+                                  parent_impurity, left_counts, best_gain, best_threshold)) {
+                best_feature = f;
+                best_mask = 0;
+            }
+            thresholds_evaluated++;
+            threshold_positions++;
+            if (stats)
+                stats->scan_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - t_start).count();
+            continue;
+        }
+
         // Cópia rápida contígua
         const auto& feature_col = X_col_major[f];
         for (size_t i = 0; i < n_samples; i++) {
             int original_idx = indices[i];
             entries[i].value = feature_col[original_idx];
-            entries[i].label = y[original_idx];
+            entries[i].label = (regression || gradient) ? 0 : y[original_idx];
             entries[i].original_index = original_idx;
         }
 
@@ -228,6 +492,83 @@ void DecisionTree::find_best_split(
             [](const SampleEntry& a, const SampleEntry& b) {
                 return a.value < b.value;
             });
+        if (stats) t_sorted = clock::now();
+        threshold_positions += n_samples - 1;
+
+        if (gradient) {
+            // Boosting: G e H acumulados no mesmo scan; ganho em relação
+            // ao score do pai (parent_impurity = G²/(H+λ))
+            const std::vector<double>& grads = *grad_stats;
+            const std::vector<double>& hess = *hess_stats;
+            const double min_child_weight = gradient_params.min_child_weight;
+            double g_left = 0.0, h_left = 0.0;
+
+            for (size_t i = 0; i < n_samples - 1; i++) {
+                const int idx = entries[i].original_index;
+                g_left += grads[idx];
+                h_left += hess[idx];
+
+                if (entries[i].value == entries[i+1].value) continue;
+                thresholds_evaluated++;
+
+                const double h_right = total_h - h_left;
+                if (h_left < min_child_weight || h_right < min_child_weight) continue;
+                const double gain = gradient_score(g_left, h_left) +
+                                    gradient_score(total_g - g_left, h_right) - parent_impurity;
+
+                if (gain > best_gain) {
+                    best_gain = gain;
+                    best_feature = f;
+                    best_mask = 0;
+                    best_threshold = (entries[i].value + entries[i+1].value) * 0.5;
+                }
+            }
+
+            if (stats) {
+                auto t_scanned = clock::now();
+                stats->sort_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t_sorted - t_start).count();
+                stats->scan_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t_scanned - t_sorted).count();
+            }
+            continue;
+        }
+
+        if (regression) {
+            // Mesmo scan linear, critério MSE: SSE = Σd² - (Σd)²/n de
+            // cada lado; ganho = variância do pai - SSE total / n
+            const std::vector<double>& targets = *reg_targets;
+            double sum_left = 0.0, sq_left = 0.0;
+            int n_left = 0;
+
+            for (size_t i = 0; i < n_samples - 1; i++) {
+                const double d = targets[entries[i].original_index] - node_mean;
+                n_left++;
+                sum_left += d;
+                sq_left += d * d;
+
+                if (entries[i].value == entries[i+1].value) continue;
+                thresholds_evaluated++;
+
+                const int n_right = (int)n_samples - n_left;
+                const double sum_right = total_sum - sum_left;
+                const double sse = (sq_left - sum_left * sum_left / n_left) +
+                                   ((total_sq - sq_left) - sum_right * sum_right / n_right);
+                const double gain = parent_impurity - sse / n_samples;
+
+                if (gain > best_gain) {
+                    best_gain = gain;
+                    best_feature = f;
+                    best_mask = 0;
+                    best_threshold = (entries[i].value + entries[i+1].value) * 0.5;
+                }
+            }
+
+            if (stats) {
+                auto t_scanned = clock::now();
+                stats->sort_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t_sorted - t_start).count();
+                stats->scan_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t_scanned - t_sorted).count();
+            }
+            continue;
+        }
 
         // Reset contadores (sem realocar)
         std::fill(left_counts.begin(), left_counts.end(), 0);
@@ -248,6 +589,7 @@ void DecisionTree::find_best_split(
 
             // Pula duplicatas
             if (entries[i].value == entries[i+1].value) continue;
+            thresholds_evaluated++;
 
             // Gini otimizado (inline calculation)
             double gini_left = 1.0;
@@ -267,30 +609,822 @@ void DecisionTree::find_best_split(
             double weighted_gini = ((double)n_left / n_samples) * gini_left + 
                                    ((double)n_right / n_samples) * gini_right;
 
-            double gain = parent_gini - weighted_gini;
+            double gain = parent_impurity - weighted_gini;
 
             if (gain > best_gain) {
                 best_gain = gain;
                 best_feature = f;
+                best_mask = 0;
                 best_threshold = (entries[i].value + entries[i+1].value) * 0.5;
             }
         }
+
+        if (stats) {
+            auto t_scanned = clock::now();
+            stats->sort_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t_sorted - t_start).count();
+            stats->scan_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t_scanned - t_sorted).count();
+        }
+    }
+
+    if (stats) {
+        stats->features_evaluated += n_features_to_check;
+        stats->thresholds_evaluated += thresholds_evaluated;
+        stats->thresholds_skipped += threshold_positions - thresholds_evaluated;
     }
 
     // Reconstrução Final
     if (best_feature != -1) {
+        PERF_SCOPE(Partition);
+        if (stats) t_start = clock::now();
         left_idx.reserve(n_samples);
         right_idx.reserve(n_samples);
         const auto& feature_col = X_col_major[best_feature];
         
         // Passada rápida linear usando vetor original
+        if (best_mask) {
+            for (int idx : indices) {
+                if (category_in_mask(feature_col[idx], best_mask))
+                    left_idx.push_back(idx);
+                else
+                    right_idx.push_back(idx);
+            }
+        } else {
+            for (int idx : indices) {
+                if (feature_col[idx] <= best_threshold)
+                    left_idx.push_back(idx);
+                else
+                    right_idx.push_back(idx);
+            }
+        }
+        if (stats)
+            stats->partition_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - t_start).count();
+    }
+}
+
+// ============================================================
+// SPLIT CATEGÓRICO
+// Categorias ordenadas pela fração da classe majoritária do nó; o
+// melhor corte é um prefixo dessa ordem (exato para alvo binário,
+// heurística para multiclasse). O(n + k log k) por coluna.
+// ============================================================
+bool DecisionTree::find_best_category_split(
+    const std::vector<double>& feature_col,
+    const std::vector<int>& y,
+    const std::vector<int>& indices,
+    const std::vector<int>& total_counts,
+    double parent_gini,
+    std::vector<int>& category_counts,
+    double& best_gain,
+    uint64_t& best_mask,
+    long long& splits_evaluated) const
+{
+    category_counts.assign((size_t)MAX_CATEGORIES * num_classes, 0);
+    int category_total[MAX_CATEGORIES] = {};
+    for (int idx : indices) {
+        const int c = (int)feature_col[idx];
+        category_counts[c * num_classes + y[idx]]++;
+        category_total[c]++;
+    }
+
+    int target = 0;
+    for (int c = 1; c < num_classes; c++)
+        if (total_counts[c] > total_counts[target]) target = c;
+
+    int present[MAX_CATEGORIES];
+    int n_present = 0;
+    for (int c = 0; c < MAX_CATEGORIES; c++)
+        if (category_total[c] > 0) present[n_present++] = c;
+    if (n_present < 2) return false;
+
+    // razão da classe alvo (empate → menor código, para ser determinístico)
+    std::sort(present, present + n_present, [&](int a, int b) {
+        const long long lhs = (long long)category_counts[a * num_classes + target] * category_total[b];
+        const long long rhs = (long long)category_counts[b * num_classes + target] * category_total[a];
+        return lhs != rhs ? lhs < rhs : a < b;
+    });
+
+    const int n_samples = indices.size();
+    std::vector<int> left_counts(num_classes, 0);
+    int n_left = 0;
+    uint64_t mask = 0;
+    bool improved = false;
+
+    for (int k = 0; k < n_present - 1; k++) {
+        const int c = present[k];
+        mask |= 1ull << c;
+        n_left += category_total[c];
+        for (int j = 0; j < num_classes; j++)
+            left_counts[j] += category_counts[c * num_classes + j];
+
+        const int n_right = n_samples - n_left;
+        double gini_left = 1.0, gini_right = 1.0;
+        for (int j = 0; j < num_classes; j++) {
+            const double pl = (double)left_counts[j] / n_left;
+            const double pr = (double)(total_counts[j] - left_counts[j]) / n_right;
+            gini_left -= pl * pl;
+            gini_right -= pr * pr;
+        }
+        splits_evaluated++;
+
+        const double weighted_gini = ((double)n_left / n_samples) * gini_left +
+                                     ((double)n_right / n_samples) * gini_right;
+        const double gain = parent_gini - weighted_gini;
+        if (gain > best_gain) {
+            best_gain = gain;
+            best_mask = mask;
+            improved = true;
+        }
+    }
+    return improved;
+}
+
+// ============================================================
+// SPLIT ALEATÓRIO (EXTRATREES)
+// Um threshold uniforme em [min, max) da feature no nó: sempre deixa
+// amostras dos dois lados (o máximo vai à direita). Sem sort, o custo
+// por feature cai de O(n log n) para duas passadas O(n).
+// ============================================================
+bool DecisionTree::find_random_split(
+    const std::vector<double>& feature_col,
+    const std::vector<int>& y,
+    const std::vector<int>& indices,
+    const std::vector<int>& total_counts,
+    double node_mean,
+    double parent_impurity,
+    std::vector<int>& left_counts,
+    double& best_gain,
+    double& best_threshold)
+{
+    double min_value = std::numeric_limits<double>::infinity();
+    double max_value = -std::numeric_limits<double>::infinity();
+    for (int idx : indices) {
+        const double v = feature_col[idx];
+        if (v < min_value) min_value = v;
+        if (v > max_value) max_value = v;
+    }
+    if (!(min_value < max_value)) return false;   // coluna constante no nó
+
+    std::uniform_real_distribution<double> dist(min_value, max_value);
+    const double threshold = dist(rng);
+
+    const int n_samples = indices.size();
+    int n_left = 0;
+    double weighted_impurity;
+
+    if (reg_targets) {
+        const std::vector<double>& targets = *reg_targets;
+        double sum_left = 0.0, sq_left = 0.0, total_sum = 0.0, total_sq = 0.0;
         for (int idx : indices) {
-            if (feature_col[idx] <= best_threshold)
-                left_idx.push_back(idx);
-            else
-                right_idx.push_back(idx);
+            const double d = targets[idx] - node_mean;
+            total_sum += d;
+            total_sq += d * d;
+            if (feature_col[idx] <= threshold) {
+                n_left++;
+                sum_left += d;
+                sq_left += d * d;
+            }
+        }
+        const int n_right = n_samples - n_left;
+        if (n_left == 0 || n_right == 0) return false;
+        const double sum_right = total_sum - sum_left;
+        weighted_impurity = ((sq_left - sum_left * sum_left / n_left) +
+                             ((total_sq - sq_left) - sum_right * sum_right / n_right)) / n_samples;
+    } else {
+        std::fill(left_counts.begin(), left_counts.end(), 0);
+        for (int idx : indices) {
+            if (feature_col[idx] <= threshold) {
+                left_counts[y[idx]]++;
+                n_left++;
+            }
+        }
+        const int n_right = n_samples - n_left;
+        if (n_left == 0 || n_right == 0) return false;
+
+        double gini_left = 1.0, gini_right = 1.0;
+        for (int c = 0; c < num_classes; c++) {
+            const double pl = (double)left_counts[c] / n_left;
+            const double pr = (double)(total_counts[c] - left_counts[c]) / n_right;
+            gini_left -= pl * pl;
+            gini_right -= pr * pr;
+        }
+        weighted_impurity = ((double)n_left / n_samples) * gini_left +
+                            ((double)n_right / n_samples) * gini_right;
+    }
+
+    const double gain = parent_impurity - weighted_impurity;
+    if (gain <= best_gain) return false;
+    best_gain = gain;
+    best_threshold = threshold;
+    return true;
+}
+
+// ============================================================
+// SPLIT CATEGÓRICO (BOOSTING)
+// Categorias ordenadas por G/H (o valor de folha de cada categoria)
+// e cortadas num prefixo, como na regressão
+// ============================================================
+bool DecisionTree::find_best_category_split_gradient(
+    const std::vector<double>& feature_col,
+    const std::vector<int>& indices,
+    double parent_score,
+    double& best_gain,
+    uint64_t& best_mask,
+    long long& splits_evaluated) const
+{
+    double category_g[MAX_CATEGORIES] = {};
+    double category_h[MAX_CATEGORIES] = {};
+    int category_total[MAX_CATEGORIES] = {};
+    double total_g = 0.0, total_h = 0.0;
+    for (int idx : indices) {
+        const int c = (int)feature_col[idx];
+        category_g[c] += (*grad_stats)[idx];
+        category_h[c] += (*hess_stats)[idx];
+        category_total[c]++;
+    }
+
+    int present[MAX_CATEGORIES];
+    int n_present = 0;
+    for (int c = 0; c < MAX_CATEGORIES; c++) {
+        if (category_total[c] == 0) continue;
+        present[n_present++] = c;
+        total_g += category_g[c];
+        total_h += category_h[c];
+    }
+    if (n_present < 2) return false;
+
+    const double lambda = gradient_params.lambda;
+    std::sort(present, present + n_present, [&](int a, int b) {
+        const double lhs = category_g[a] / (category_h[a] + lambda);
+        const double rhs = category_g[b] / (category_h[b] + lambda);
+        return lhs != rhs ? lhs < rhs : a < b;
+    });
+
+    double g_left = 0.0, h_left = 0.0;
+    uint64_t mask = 0;
+    bool improved = false;
+
+    for (int k = 0; k < n_present - 1; k++) {
+        const int c = present[k];
+        mask |= 1ull << c;
+        g_left += category_g[c];
+        h_left += category_h[c];
+        splits_evaluated++;
+
+        const double h_right = total_h - h_left;
+        if (h_left < gradient_params.min_child_weight ||
+            h_right < gradient_params.min_child_weight) continue;
+        const double gain = gradient_score(g_left, h_left) +
+                            gradient_score(total_g - g_left, h_right) - parent_score;
+        if (gain > best_gain) {
+            best_gain = gain;
+            best_mask = mask;
+            improved = true;
         }
     }
+    return improved;
+}
+
+// ============================================================
+// BOOSTING: somas de gradiente/hessiana e crescimento por folha
+// ============================================================
+void DecisionTree::gradient_sums(const std::vector<int>& indices, double& G, double& H) const
+{
+    G = 0.0;
+    H = 0.0;
+    for (int idx : indices) {
+        G += (*grad_stats)[idx];
+        H += (*hess_stats)[idx];
+    }
+}
+
+double DecisionTree::gradient_split_gain(const std::vector<int>& left_idx,
+                                         const std::vector<int>& right_idx) const
+{
+    double g_left, h_left, g_right, h_right;
+    gradient_sums(left_idx, g_left, h_left);
+    gradient_sums(right_idx, g_right, h_right);
+    return gradient_score(g_left, h_left) + gradient_score(g_right, h_right) -
+           gradient_score(g_left + g_right, h_left + h_right);
+}
+
+float DecisionTree::gradient_leaf_value(const std::vector<int>& indices) const
+{
+    double G, H;
+    gradient_sums(indices, G, H);
+    return (float)(-gradient_params.learning_rate * G / (H + gradient_params.lambda));
+}
+
+// Best-first: a cada passo divide a folha aberta de maior ganho. As
+// folhas só recebem valor (e índice na tabela) quando o crescimento
+// termina, então nenhuma saída fica órfã na tabela.
+std::unique_ptr<Node> DecisionTree::build_tree_leaf_wise(
+    const std::vector<std::vector<double>>& X_col_major,
+    const std::vector<int>& indices)
+{
+    static const std::vector<int> no_labels;
+
+    struct OpenLeaf {
+        Node* node;
+        int depth;
+        std::vector<int> indices;
+        int feature = -1;
+        double threshold = 0.0;
+        uint64_t mask = 0;
+        double gain = 0.0;
+        std::vector<int> left_idx, right_idx;
+    };
+
+    auto evaluate = [&](Node* node, std::vector<int> node_indices, int depth) {
+        OpenLeaf leaf;
+        leaf.node = node;
+        leaf.depth = depth;
+        leaf.indices = std::move(node_indices);
+
+        TraceLevel* stats = trace ? &trace->level(depth) : nullptr;
+        if (stats) {
+            stats->nodes++;
+            stats->samples += leaf.indices.size();
+        }
+
+        double G, H;
+        gradient_sums(leaf.indices, G, H);
+        if (depth >= max_depth ||
+            leaf.indices.size() < (size_t)min_samples_split ||
+            H < 2.0 * gradient_params.min_child_weight)
+            return leaf;
+
+        double scan_gain = 0.0;
+        find_best_split(X_col_major, no_labels, leaf.indices,
+                        leaf.feature, leaf.threshold, leaf.left_idx, leaf.right_idx,
+                        gradient_score(G, H), stats, leaf.mask, scan_gain);
+        if (leaf.feature != -1 && !leaf.left_idx.empty() && !leaf.right_idx.empty())
+            leaf.gain = gradient_split_gain(leaf.left_idx, leaf.right_idx);
+        else
+            leaf.feature = -1;
+        return leaf;
+    };
+
+    auto root_node = std::make_unique<Node>();
+    root_node->is_leaf = true;
+
+    std::vector<OpenLeaf> open;
+    open.push_back(evaluate(root_node.get(), indices, 0));
+    int n_leaves = 1;
+
+    while (n_leaves < gradient_params.max_leaves) {
+        int best = -1;
+        for (int k = 0; k < (int)open.size(); k++) {
+            if (open[k].feature == -1 || open[k].gain <= gradient_params.min_split_gain) continue;
+            if (best == -1 || open[k].gain > open[best].gain) best = k;
+        }
+        if (best == -1) break;
+
+        OpenLeaf split = std::move(open[best]);
+        if (best != (int)open.size() - 1) open[best] = std::move(open.back());
+        open.pop_back();
+
+        record_split(split.feature, split.gain);
+        Node* node = split.node;
+        node->is_leaf = false;
+        node->n_samples = (int)(split.left_idx.size() + split.right_idx.size());
+        node->feature_index = split.feature;
+        node->threshold = split.threshold;
+        node->category_mask = split.mask;
+        node->left = std::make_unique<Node>();
+        node->right = std::make_unique<Node>();
+        node->left->is_leaf = true;
+        node->right->is_leaf = true;
+
+        open.push_back(evaluate(node->left.get(), std::move(split.left_idx), split.depth + 1));
+        open.push_back(evaluate(node->right.get(), std::move(split.right_idx), split.depth + 1));
+        n_leaves++;
+    }
+
+    for (OpenLeaf& leaf : open) {
+        if (trace) trace->level(leaf.depth).leaves++;
+        leaf.node->leaf_index = get_num_table_leaves();
+        leaf_values.push_back(gradient_leaf_value(leaf.indices));
+    }
+    return root_node;
+}
+
+// ============================================================
+// CRESCIMENTO POR NÍVEL (BREADTH-FIRST)
+// Em vez de cada nó reunir e ordenar o seu pedaço das colunas, cada
+// linha guarda o nó do nível em que está e cada feature é varrida uma
+// vez por nível, na ordem pré-calculada: as estatísticas de todos os
+// nós que sortearam a feature saem da mesma passada sequencial. Depois
+// uma passada pelas linhas move cada uma para o filho do seu nó.
+// ============================================================
+void DecisionTree::presort_columns(const std::vector<std::vector<double>>& X_col_major,
+                                   const std::vector<char>& is_categorical,
+                                   ColumnOrder& order)
+{
+    PERF_SCOPE(Transpose);
+    order.assign(X_col_major.size(), {});
+    for (size_t f = 0; f < X_col_major.size(); f++) {
+        if (f < is_categorical.size() && is_categorical[f]) continue;
+        const auto& col = X_col_major[f];
+        auto& entries = order[f];
+        entries.resize(col.size());
+        for (size_t r = 0; r < col.size(); r++) entries[r] = {col[r], (int)r};
+
+        // NaN no fim: nunca vira threshold e fica sempre à direita
+        std::sort(entries.begin(), entries.end(), [](const SortedEntry& a, const SortedEntry& b) {
+            if (std::isnan(a.value)) return false;
+            if (std::isnan(b.value)) return true;
+            return a.value < b.value;
+        });
+    }
+}
+
+bool DecisionTree::can_grow_level_wise() const
+{
+    if (!level_wise || extra_trees) return false;
+    for (char c : categorical)
+        if (c) return false;
+    return true;
+}
+
+// Semente do nó: splitmix64 de (semente da árvore, id no heap), onde a
+// raiz é 1 e os filhos de h são 2h e 2h+1
+static unsigned int node_seed(unsigned int tree_seed, uint64_t heap_id)
+{
+    uint64_t z = (uint64_t)tree_seed * 0x9E3779B97F4A7C15ull + heap_id;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return (unsigned int)(z ^ (z >> 31));
+}
+
+std::unique_ptr<Node> DecisionTree::build_tree_level_wise(
+    const std::vector<std::vector<double>>& X_col_major,
+    const std::vector<int>& y,
+    const std::vector<int>& indices)
+{
+    const bool regression = (leaf_mode == LeafMode::Regression);
+    const size_t n_features = X_col_major.size();
+    const size_t n_rows = X_col_major[0].size();
+
+    // Ordem compartilhada só vale se for deste dataset
+    ColumnOrder local_order;
+    const ColumnOrder* order = presorted_columns;
+    bool order_ok = order && order->size() == n_features;
+    for (size_t f = 0; order_ok && f < n_features; f++)
+        order_ok = (*order)[f].size() == n_rows;
+    if (!order_ok) {
+        presort_columns(X_col_major, categorical, local_order);
+        order = &local_order;
+    }
+
+    // Estado por linha: nó do nível atual (-1 = fora da amostra ou já
+    // numa folha), multiplicidade na amostra da árvore e classe (junto,
+    // para a varredura fazer um só acesso aleatório por linha)
+    struct RowState {
+        int slot;
+        int weight;
+        int label;
+    };
+    std::vector<RowState> rows(n_rows, RowState{-1, 0, 0});
+    for (int idx : indices) {
+        rows[idx].slot = 0;
+        rows[idx].weight++;
+        if (!regression) rows[idx].label = y[idx];
+    }
+
+    // Nó aberto do nível: contagem por classe ou, na regressão, média e
+    // soma dos quadrados dos desvios (Welford ponderado)
+    struct LevelNode {
+        Node* node;
+        uint64_t heap_id;
+        long long n;
+        double mean;
+        double m2;
+        std::vector<int> counts;
+    };
+    auto open_node = [&](std::vector<LevelNode>& nodes, Node* node, uint64_t heap_id) {
+        nodes.push_back(LevelNode{node, heap_id, 0, 0.0, 0.0,
+                                  std::vector<int>(regression ? 0 : num_classes, 0)});
+    };
+    auto add_row = [&](LevelNode& ln, int r) {
+        const int w = rows[r].weight;
+        ln.n += w;
+        if (regression) {
+            const double x = (*reg_targets)[r];
+            const double delta = x - ln.mean;
+            ln.mean += delta * w / ln.n;
+            ln.m2 += w * delta * (x - ln.mean);
+        } else {
+            ln.counts[rows[r].label] += w;
+        }
+    };
+
+    auto root_node = std::make_unique<Node>();
+    std::vector<LevelNode> level;
+    open_node(level, root_node.get(), 1);
+    size_t n_active = 0;
+    for (size_t r = 0; r < n_rows; r++) {
+        if (rows[r].slot != 0) continue;
+        add_row(level[0], (int)r);
+        n_active++;
+    }
+
+    // Listas varridas: a ordem compartilhada até que as linhas ativas
+    // (na amostra e fora de folhas) caiam abaixo de 7/8 das varridas; aí
+    // a árvore passa a varrer cópias só com as ativas, refeitas a cada
+    // nova queda (custo linear, sem reordenar). Linhas inativas no meio
+    // da lista custam um desvio imprevisível cada.
+    ColumnOrder compacted;
+    const ColumnOrder* scan_order = order;
+    size_t scan_length = n_rows;
+    auto compact_scan_order = [&]() {
+        if (n_active * 8 >= scan_length * 7) return;
+        ColumnOrder next_order(n_features);
+        for (size_t f = 0; f < n_features; f++) {
+            next_order[f].reserve(n_active);
+            for (const SortedEntry& e : (*scan_order)[f])
+                if (rows[e.row].slot >= 0) next_order[f].push_back(e);
+        }
+        compacted = std::move(next_order);
+        scan_order = &compacted;
+        scan_length = n_active;
+    };
+    compact_scan_order();
+
+    const int width = regression ? 0 : num_classes;
+    std::vector<int> candidates;
+
+    for (int depth = 0; !level.empty(); depth++) {
+        TraceLevel* stats = trace ? &trace->level(depth) : nullptr;
+        const size_t n_open = level.size();
+
+        auto make_leaf = [&](LevelNode& ln) {
+            if (stats) stats->leaves++;
+            Node* leaf = ln.node;
+            leaf->is_leaf = true;
+            leaf->n_samples = (int)ln.n;
+            if (leaf_mode != LeafMode::Class) {
+                leaf->leaf_index = get_num_table_leaves();
+                if (regression) {
+                    leaf_values.push_back((float)ln.mean);
+                } else {
+                    const double inv_total = 1.0 / ln.n;
+                    for (int c = 0; c < num_classes; c++)
+                        leaf_values.push_back((float)(ln.counts[c] * inv_total));
+                }
+            }
+        };
+
+        // 1) Critérios de parada; os demais nós sorteiam suas features
+        std::vector<double> impurity(n_open, 0.0);
+        std::vector<char> splitting(n_open, 0);
+        std::vector<char> uses(n_features * n_open, 0);   // feature-major
+        std::vector<char> feature_used(n_features, 0);
+        for (size_t s = 0; s < n_open; s++) {
+            LevelNode& ln = level[s];
+            if (stats) {
+                stats->nodes++;
+                stats->samples += ln.n;
+            }
+
+            bool is_pure;
+            if (regression) {
+                impurity[s] = ln.m2 / ln.n;
+                is_pure = impurity[s] <= 1e-12;
+            } else {
+                int max_c = -1, present = 0;
+                for (int c = 0; c < num_classes; c++) {
+                    if (ln.counts[c] > max_c) {
+                        max_c = ln.counts[c];
+                        ln.node->predicted_class = c;
+                    }
+                    if (ln.counts[c] > 0) present++;
+                }
+                is_pure = present <= 1;
+                impurity[s] = calculate_gini_from_counts(ln.counts, (int)ln.n);
+            }
+
+            if (is_pure || depth >= max_depth || ln.n < min_samples_split ||
+                (!regression && impurity[s] <= 1e-6)) {
+                make_leaf(ln);
+                continue;
+            }
+
+            splitting[s] = 1;
+            std::mt19937 node_rng(node_seed(tree_seed, ln.heap_id));
+            size_t n_to_check = 0;
+            sample_features(n_features, node_rng, candidates, n_to_check);
+            for (size_t k = 0; k < n_to_check; k++) {
+                uses[candidates[k] * n_open + s] = 1;
+                feature_used[candidates[k]] = 1;
+            }
+            if (stats) stats->features_evaluated += n_to_check;
+        }
+
+        // 2) Uma varredura por feature: cada linha soma no lado esquerdo do
+        // seu nó; o corte entre dois valores distintos é avaliado quando o
+        // nó recebe o primeiro valor maior que o anterior
+        std::vector<double> best_gain(n_open, -1.0);
+        std::vector<double> best_threshold(n_open, 0.0);
+        std::vector<int> best_feature(n_open, -1);
+        std::vector<long long> n_left(n_open);
+        std::vector<double> last_value(n_open);
+        std::vector<int> left_counts(n_open * width);
+        std::vector<double> sum_left(regression ? n_open : 0);
+        std::vector<double> sq_left(regression ? n_open : 0);
+        long long thresholds_evaluated = 0, threshold_positions = 0;
+
+        using clock = std::chrono::steady_clock;
+        clock::time_point t_start;
+        if (stats) t_start = clock::now();
+        {
+            PERF_SCOPE(FindBestSplit);
+            for (size_t f = 0; f < n_features; f++) {
+                if (!feature_used[f]) continue;
+                std::fill(n_left.begin(), n_left.end(), 0);
+                std::fill(left_counts.begin(), left_counts.end(), 0);
+                std::fill(sum_left.begin(), sum_left.end(), 0.0);
+                std::fill(sq_left.begin(), sq_left.end(), 0.0);
+
+                const char* uses_f = &uses[f * n_open];
+                for (const SortedEntry& e : (*scan_order)[f]) {
+                    if (std::isnan(e.value)) break;
+                    const RowState& row = rows[e.row];
+                    const int s = row.slot;
+                    if (s < 0 || !uses_f[s]) continue;
+                    const LevelNode& ln = level[s];
+
+                    if (n_left[s] > 0) {
+                        threshold_positions++;
+                        if (e.value != last_value[s]) {
+                            thresholds_evaluated++;
+                            const long long nl = n_left[s];
+                            const long long nr = ln.n - nl;
+                            double gain;
+                            if (regression) {
+                                // somas centradas na média do nó (Σd total = 0)
+                                const double sse = (sq_left[s] - sum_left[s] * sum_left[s] / nl) +
+                                                   ((ln.m2 - sq_left[s]) - sum_left[s] * sum_left[s] / nr);
+                                gain = impurity[s] - sse / ln.n;
+                            } else {
+                                const int* lc = &left_counts[(size_t)s * width];
+                                double gini_left = 1.0, gini_right = 1.0;
+                                for (int c = 0; c < num_classes; c++) {
+                                    const int rc = ln.counts[c] - lc[c];
+                                    if (lc[c] > 0) {
+                                        const double p = (double)lc[c] / nl;
+                                        gini_left -= p * p;
+                                    }
+                                    if (rc > 0) {
+                                        const double p = (double)rc / nr;
+                                        gini_right -= p * p;
+                                    }
+                                }
+                                gain = impurity[s] - ((double)nl / ln.n) * gini_left
+                                                   - ((double)nr / ln.n) * gini_right;
+                            }
+                            if (gain > best_gain[s]) {
+                                best_gain[s] = gain;
+                                best_feature[s] = (int)f;
+                                best_threshold[s] = (last_value[s] + e.value) * 0.5;
+                            }
+                        }
+                    }
+
+                    n_left[s] += row.weight;
+                    if (regression) {
+                        const double d = (*reg_targets)[e.row] - ln.mean;
+                        sum_left[s] += row.weight * d;
+                        sq_left[s] += row.weight * d * d;
+                    } else {
+                        left_counts[(size_t)s * width + row.label] += row.weight;
+                    }
+                    last_value[s] = e.value;
+                }
+            }
+        }
+        if (stats) {
+            stats->scan_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - t_start).count();
+            stats->thresholds_evaluated += thresholds_evaluated;
+            stats->thresholds_skipped += threshold_positions - thresholds_evaluated;
+            t_start = clock::now();
+        }
+
+        // 3) Nós com split ganham dois filhos no próximo nível; as linhas
+        // dos que não acharam corte (ou pararam) saem da árvore
+        std::vector<LevelNode> next;
+        std::vector<int> left_slot(n_open, -1);
+        for (size_t s = 0; s < n_open; s++) {
+            if (!splitting[s]) continue;
+            LevelNode& ln = level[s];
+            if (best_feature[s] == -1) {
+                make_leaf(ln);
+                continue;
+            }
+            record_split(best_feature[s], best_gain[s] * ln.n);
+            Node* node = ln.node;
+            node->n_samples = (int)ln.n;
+            node->feature_index = best_feature[s];
+            node->threshold = best_threshold[s];
+            node->left = std::make_unique<Node>();
+            node->right = std::make_unique<Node>();
+            left_slot[s] = (int)next.size();
+            open_node(next, node->left.get(), ln.heap_id * 2);
+            open_node(next, node->right.get(), ln.heap_id * 2 + 1);
+        }
+
+        {
+            PERF_SCOPE(Partition);
+            n_active = 0;
+            for (size_t r = 0; r < n_rows; r++) {
+                const int s = rows[r].slot;
+                if (s < 0) continue;
+                if (left_slot[s] < 0) {
+                    rows[r].slot = -1;
+                    continue;
+                }
+                const double v = X_col_major[best_feature[s]][r];
+                const int child = left_slot[s] + (v <= best_threshold[s] ? 0 : 1);
+                rows[r].slot = child;
+                add_row(next[child], (int)r);
+                n_active++;
+            }
+            if (!next.empty()) compact_scan_order();
+        }
+        if (stats)
+            stats->partition_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - t_start).count();
+
+        level = std::move(next);
+    }
+
+    return root_node;
+}
+
+// ============================================================
+// SPLIT CATEGÓRICO (REGRESSÃO)
+// Categorias ordenadas pela média do alvo: o melhor agrupamento em
+// dois lados é um prefixo dessa ordem (Breiman), então é exato.
+// ============================================================
+bool DecisionTree::find_best_category_split_mse(
+    const std::vector<double>& feature_col,
+    const std::vector<int>& indices,
+    double node_mean,
+    double parent_variance,
+    double& best_gain,
+    uint64_t& best_mask,
+    long long& splits_evaluated) const
+{
+    double category_sum[MAX_CATEGORIES] = {};
+    double category_sq[MAX_CATEGORIES] = {};
+    int category_total[MAX_CATEGORIES] = {};
+    double total_sum = 0.0, total_sq = 0.0;
+    for (int idx : indices) {
+        const int c = (int)feature_col[idx];
+        const double d = (*reg_targets)[idx] - node_mean;
+        category_sum[c] += d;
+        category_sq[c] += d * d;
+        category_total[c]++;
+        total_sum += d;
+        total_sq += d * d;
+    }
+
+    int present[MAX_CATEGORIES];
+    int n_present = 0;
+    for (int c = 0; c < MAX_CATEGORIES; c++)
+        if (category_total[c] > 0) present[n_present++] = c;
+    if (n_present < 2) return false;
+
+    std::sort(present, present + n_present, [&](int a, int b) {
+        const double lhs = category_sum[a] / category_total[a];
+        const double rhs = category_sum[b] / category_total[b];
+        return lhs != rhs ? lhs < rhs : a < b;
+    });
+
+    const int n_samples = indices.size();
+    double sum_left = 0.0, sq_left = 0.0;
+    int n_left = 0;
+    uint64_t mask = 0;
+    bool improved = false;
+
+    for (int k = 0; k < n_present - 1; k++) {
+        const int c = present[k];
+        mask |= 1ull << c;
+        n_left += category_total[c];
+        sum_left += category_sum[c];
+        sq_left += category_sq[c];
+        splits_evaluated++;
+
+        const int n_right = n_samples - n_left;
+        const double sum_right = total_sum - sum_left;
+        const double sse = (sq_left - sum_left * sum_left / n_left) +
+                           ((total_sq - sq_left) - sum_right * sum_right / n_right);
+        const double gain = parent_variance - sse / n_samples;
+        if (gain > best_gain) {
+            best_gain = gain;
+            best_mask = mask;
+            improved = true;
+        }
+    }
+    return improved;
 }
 
 // ============================================================
@@ -313,6 +1447,51 @@ int DecisionTree::predict_one(const std::vector<double>& sample) const {
     return predict_sample(sample, root.get());
 }
 
+const Node* DecisionTree::find_leaf(const double* sample) const {
+    const Node* node = root.get();
+    while (node && !node->is_leaf) {
+        const double x = sample[node->feature_index];
+        const bool go_left = node->is_categorical() ? category_in_mask(x, node->category_mask)
+                                                    : x <= node->threshold;
+        node = go_left ? node->left.get() : node->right.get();
+    }
+    return node;
+}
+
+void DecisionTree::predict_depths(const double* sample, int max_d, int* classes) const {
+    const Node* node = root.get();
+    int d = 0;
+    for (; d <= max_d; d++) {
+        classes[d] = node ? node->predicted_class : -1;
+        if (!node || node->is_leaf) break;
+        const double x = sample[node->feature_index];
+        const bool go_left = node->is_categorical() ? category_in_mask(x, node->category_mask)
+                                                    : x <= node->threshold;
+        node = go_left ? node->left.get() : node->right.get();
+    }
+    for (d = d + 1; d <= max_d; d++)
+        classes[d] = classes[d - 1];
+}
+
+const float* DecisionTree::predict_leaf_output(const double* sample) const {
+    const Node* leaf = find_leaf(sample);
+    if (!leaf || leaf->leaf_index < 0) return nullptr;
+    return &leaf_values[(size_t)leaf->leaf_index * get_leaf_width()];
+}
+
+int DecisionTree::get_leaf_width() const {
+    switch (leaf_mode) {
+        case LeafMode::Distribution: return num_classes;
+        case LeafMode::Regression:   return 1;
+        default:                     return 0;
+    }
+}
+
+int DecisionTree::get_num_table_leaves() const {
+    const int width = get_leaf_width();
+    return width > 0 ? (int)(leaf_values.size() / width) : 0;
+}
+
 std::vector<int> DecisionTree::predict(const std::vector<std::vector<double>>& X) const {
     std::vector<int> predictions;
     predictions.reserve(X.size());
@@ -327,12 +1506,106 @@ int DecisionTree::predict_sample(const std::vector<double>& sample, const Node*
     if (!node) return -1;
     if (node->is_leaf) return node->predicted_class;
 
-    if (sample[node->feature_index] <= node->threshold)
+    const double x = sample[node->feature_index];
+    const bool go_left = node->is_categorical() ? category_in_mask(x, node->category_mask)
+                                                : x <= node->threshold;
+    if (go_left)
         return predict_sample(sample, node->left.get());
     else
         return predict_sample(sample, node->right.get());
 }
 
+// ============================================================
+// COMPACTAÇÃO
+// ============================================================
+int DecisionTree::compact() {
+    if (leaf_mode != LeafMode::Class) return 0;
+    int removed = 0;
+    collapse_node(root, removed);
+    return removed;
+}
+
+// Retorna a classe se toda a subárvore prediz a mesma classe, senão -1
+int DecisionTree::collapse_node(std::unique_ptr<Node>& node, int& removed) {
+    if (!node) return -1;
+    if (node->is_leaf) return node->predicted_class;
+
+    int left_class = collapse_node(node->left, removed);
+    int right_class = collapse_node(node->right, removed);
+
+    if (left_class >= 0 && left_class == right_class) {
+        removed += 2; // os dois filhos já são folhas após o colapso recursivo
+        node->left.reset();
+        node->right.reset();
+        node->is_leaf = true;
+        node->predicted_class = left_class;
+        return left_class;
+    }
+    return -1;
+}
+
+// ============================================================
+// Árvore montada externamente
+// ============================================================
+void DecisionTree::set_root(std::unique_ptr<Node> new_root, int n_classes) {
+    root = std::move(new_root);
+    num_classes = n_classes;
+    leaf_mode = LeafMode::Class;
+    leaf_values.clear();
+    importance.clear();
+    split_counts.clear();
+}
+
+// ============================================================
+// Features dos splits (seleção de colunas na predição)
+// ============================================================
+void DecisionTree::collect_used_features(std::vector<char>& used) const {
+    std::vector<const Node*> stack;
+    if (root) stack.push_back(root.get());
+    while (!stack.empty()) {
+        const Node* node = stack.back();
+        stack.pop_back();
+        if (node->is_leaf) continue;
+        if (node->feature_index >= (int)used.size()) used.resize(node->feature_index + 1, 0);
+        used[node->feature_index] = 1;
+        stack.push_back(node->left.get());
+        stack.push_back(node->right.get());
+    }
+}
+
+void DecisionTree::remap_features(const std::vector<int>& new_index) {
+    if (root) remap_node(root.get(), new_index);
+    if (!categorical.empty()) {
+        std::vector<char> remapped;
+        for (size_t f = 0; f < categorical.size() && f < new_index.size(); f++) {
+            if (new_index[f] < 0) continue;
+            if (new_index[f] >= (int)remapped.size()) remapped.resize(new_index[f] + 1, 0);
+            remapped[new_index[f]] = categorical[f];
+        }
+        categorical = std::move(remapped);
+    }
+}
+
+void DecisionTree::remap_node(Node* node, const std::vector<int>& new_index) {
+    if (node->is_leaf) return;
+    const int f = node->feature_index;
+    if (f >= (int)new_index.size() || new_index[f] < 0)
+        throw std::invalid_argument("o modelo usa a feature " + std::to_string(f) +
+                                    ", removida da selecao de colunas");
+    node->feature_index = new_index[f];
+    remap_node(node->left.get(), new_index);
+    remap_node(node->right.get(), new_index);
+}
+
+int DecisionTree::count_nodes() const {
+    return count_subtree(root.get());
+}
+
+int DecisionTree::count_subtree(const Node* node) const {
+    if (!node) return 0;
+    return 1 + count_subtree(node->left.get()) + count_subtree(node->right.get());
+}
+
 // ============================================================
 // SERIALIZATION (BOILERPLATE)
 // ============================================================
@@ -348,10 +1621,28 @@ void DecisionTree::save_node(std::ostream& out, const Node* node) const {
     out.write(reinterpret_cast<const char*>(&exists), sizeof(bool));
     if (!exists) return;
 
-    out.write(reinterpret_cast<const char*>(&node->is_leaf), sizeof(bool));
+    // Tipo do nó no antigo byte is_leaf: 0 = split numérico, 1 = folha,
+    // 2 = split categórico (seguido da máscara de 64 bits), 3 = folha com
+    // distribuição (num_classes floats), 4 = folha de regressão (1 float).
+    // NODE_HAS_COUNT marca nós internos com a contagem de amostras.
+    uint8_t kind = node->is_categorical() ? NODE_CATEGORICAL : NODE_NUMERIC;
+    if (node->is_leaf) {
+        kind = node->leaf_index < 0 ? NODE_LEAF
+             : leaf_mode == LeafMode::Regression ? NODE_LEAF_VALUE : NODE_LEAF_DISTRIBUTION;
+    }
+    const bool has_count = !node->is_leaf && node->n_samples > 0;
+    const uint8_t kind_byte = has_count ? (kind | NODE_HAS_COUNT) : kind;
+    out.write(reinterpret_cast<const char*>(&kind_byte), sizeof(uint8_t));
     out.write(reinterpret_cast<const char*>(&node->predicted_class), sizeof(int));
     out.write(reinterpret_cast<const char*>(&node->feature_index), sizeof(int));
     out.write(reinterpret_cast<const char*>(&node->threshold), sizeof(double));
+    if (kind == NODE_CATEGORICAL)
+        out.write(reinterpret_cast<const char*>(&node->category_mask), sizeof(uint64_t));
+    if (has_count)
+        out.write(reinterpret_cast<const char*>(&node->n_samples), sizeof(int));
+    if (kind == NODE_LEAF_DISTRIBUTION || kind == NODE_LEAF_VALUE)
+        out.write(reinterpret_cast<const char*>(&leaf_values[(size_t)node->leaf_index * get_leaf_width()]),
+                  sizeof(float) * get_leaf_width());
 
     save_node(out, node->left.get());
     save_node(out, node->right.get());
@@ -361,6 +1652,9 @@ void DecisionTree::load_model(std::istream& in) {
     in.read(reinterpret_cast<char*>(&max_depth), sizeof(max_depth));
     in.read(reinterpret_cast<char*>(&min_samples_split), sizeof(min_samples_split));
     in.read(reinterpret_cast<char*>(&num_classes), sizeof(num_classes));
+    // modo das folhas vem do tipo gravado nelas
+    leaf_mode = LeafMode::Class;
+    leaf_values.clear();
     root = load_node(in);
 }
 
@@ -370,10 +1664,27 @@ std::unique_ptr<Node> DecisionTree::load_node(std::istream& in) {
     if (!exists) return nullptr;
 
     auto node = std::make_unique<Node>();
-    in.read(reinterpret_cast<char*>(&node->is_leaf), sizeof(bool));
+    uint8_t kind = NODE_NUMERIC;
+    in.read(reinterpret_cast<char*>(&kind), sizeof(uint8_t));
     in.read(reinterpret_cast<char*>(&node->predicted_class), sizeof(int));
     in.read(reinterpret_cast<char*>(&node->feature_index), sizeof(int));
     in.read(reinterpret_cast<char*>(&node->threshold), sizeof(double));
+    const bool has_count = kind & NODE_HAS_COUNT;
+    kind &= ~NODE_HAS_COUNT;
+    if (kind > NODE_LEAF_VALUE)
+        throw std::runtime_error("Tipo de no desconhecido no modelo");
+    node->is_leaf = (kind == NODE_LEAF || kind == NODE_LEAF_DISTRIBUTION || kind == NODE_LEAF_VALUE);
+    if (kind == NODE_CATEGORICAL)
+        in.read(reinterpret_cast<char*>(&node->category_mask), sizeof(uint64_t));
+    if (has_count)
+        in.read(reinterpret_cast<char*>(&node->n_samples), sizeof(int));
+    if (kind == NODE_LEAF_DISTRIBUTION || kind == NODE_LEAF_VALUE) {
+        leaf_mode = (kind == NODE_LEAF_VALUE) ? LeafMode::Regression : LeafMode::Distribution;
+        const int width = get_leaf_width();
+        node->leaf_index = get_num_table_leaves();
+        leaf_values.resize(leaf_values.size() + width);
+        in.read(reinterpret_cast<char*>(&leaf_values[leaf_values.size() - width]), sizeof(float) * width);
+    }
 
     node->left = load_node(in);
     node->right = load_node(in);
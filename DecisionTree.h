@@ -4,18 +4,70 @@
 #include <vector>
 #include <memory>
 #include <iostream>
+#include <random>
+#include <cstdint>
+
+struct TreeTrace;
+struct TraceLevel;
 
 struct Node {
     bool is_leaf = false;
     int predicted_class = -1;
     int feature_index = -1;
     double threshold = 0.0;
+    // Split categórico: categorias com o bit ligado vão para a esquerda
+    // (0 = split numérico por threshold)
+    uint64_t category_mask = 0;
+    // Folha com saída na tabela da árvore (distribuição ou regressão):
+    // posição da folha na tabela (-1 = só predicted_class)
+    int leaf_index = -1;
+    // Amostras de treino que chegaram ao nó (frequência do caminho, usada
+    // no layout guiado por perfil). Só nós internos a gravam no modelo;
+    // 0 = desconhecida (modelo antigo ou folha carregada).
+    int n_samples = 0;
     std::unique_ptr<Node> left = nullptr;
     std::unique_ptr<Node> right = nullptr;
+
+    bool is_categorical() const { return category_mask != 0; }
+};
+
+// Categorias válidas: inteiros em [0, 64). Fora disso (ou NaN) a
+// amostra vai para a direita, como o NaN no split numérico.
+constexpr int MAX_CATEGORIES = 64;
+
+inline bool category_in_mask(double value, uint64_t mask) {
+    if (!(value >= 0.0 && value < MAX_CATEGORIES)) return false;
+    return (mask >> (unsigned)value) & 1;
+}
+
+// Parâmetros do treino por gradiente/hessiana (boosting): o ganho do
+// split é G_L²/(H_L+λ) + G_R²/(H_R+λ) - G²/(H+λ) e a folha vale
+// -learning_rate * G/(H+λ)
+struct GradientParams {
+    double lambda = 1.0;             // regularização L2 das folhas
+    double min_child_weight = 1e-3;  // soma mínima de hessiana por filho
+    double min_split_gain = 0.0;     // ganho mínimo para dividir
+    double learning_rate = 0.1;      // shrinkage (já aplicado na folha)
+    int max_leaves = 0;              // > 0: crescimento por folha (best-first);
+                                     // 0: recursivo, profundidade primeiro
 };
 
+// Coluna pré-ordenada para o crescimento por nível: (valor, linha) em
+// ordem crescente de valor, NaN no fim. O valor vem junto para que a
+// varredura leia a coluna em sequência, sem gather em X.
+struct SortedEntry {
+    double value;
+    int row;
+};
+using ColumnOrder = std::vector<std::vector<SortedEntry>>;
+
 class DecisionTree {
 public:
+    // Saída das folhas: só a classe (padrão), distribuição de classes
+    // (num_classes floats somando 1) ou valor de regressão (1 float).
+    // As saídas ficam numa tabela contígua da árvore, folha por folha.
+    enum class LeafMode : uint8_t { Class, Distribution, Regression };
+
     // === CORREÇÃO DE COMPATIBILIDADE ===
     // Adicionamos esta constante para que a RandomForestOptimized pare de reclamar
     static const int DEFAULT_CHUNK_SIZE = 256;
@@ -35,10 +87,119 @@ public:
              const std::vector<int>& y, 
              bool use_chunks = false, 
              const std::vector<int>* bootstrap_indices = nullptr);
+
+    // Treino a partir de um dataset já transposto (column-major), permitindo
+    // que a floresta transponha uma única vez e reaproveite entre árvores
+    void fit_columns(const std::vector<std::vector<double>>& X_col_major,
+                     const std::vector<int>& y,
+                     const std::vector<int>& indices);
+
+    // Regressão: mesmo motor de sort + scan, critério MSE (redução da
+    // variância do alvo). Liga o modo LeafMode::Regression.
+    void fit_regression_columns(const std::vector<std::vector<double>>& X_col_major,
+                                const std::vector<double>& targets,
+                                const std::vector<int>& indices);
+
+    // Boosting: mesmo motor de split com estatísticas de gradiente e
+    // hessiana por amostra. Folhas de regressão (LeafMode::Regression).
+    // Com params.max_leaves > 0 a árvore cresce pela folha de maior ganho
+    // (limitada também por max_depth); senão, pelo build_tree recursivo
+    // (profundidade primeiro, como a floresta).
+    void fit_gradient_columns(const std::vector<std::vector<double>>& X_col_major,
+                              const std::vector<double>& gradients,
+                              const std::vector<double>& hessians,
+                              const std::vector<int>& indices,
+                              const GradientParams& params);
+
+    int get_num_classes() const { return num_classes; }
+    const Node* get_root() const { return root.get(); }
+    // Árvore montada fora do fit (ex: floresta online), com folhas só de
+    // classe; serializa e prediz como uma árvore treinada
+    void set_root(std::unique_ptr<Node> new_root, int n_classes);
+
+    void set_leaf_mode(LeafMode mode) { leaf_mode = mode; }
+    LeafMode get_leaf_mode() const    { return leaf_mode; }
+    // floats por folha na tabela (0 no modo Class)
+    int get_leaf_width() const;
+    int get_num_table_leaves() const;
+    const std::vector<float>& get_leaf_values() const { return leaf_values; }
+
+    // Importância por feature acumulada no último fit: redução de
+    // impureza (Gini ou variância) x amostras do nó, somada nos splits da
+    // feature; no boosting, o ganho do split. Só existe após o treino
+    // (não vai para o modelo salvo).
+    const std::vector<double>& get_feature_importance() const { return importance; }
+    const std::vector<int>& get_split_counts() const          { return split_counts; }
+
+    // Marca used[f] = 1 para as features usadas em algum split
+    void collect_used_features(std::vector<char>& used) const;
+    // Renumera as features dos splits (f -> new_index[f]) para predizer
+    // sobre linhas com só parte das colunas. Lança invalid_argument se
+    // algum split usar uma feature removida (new_index = -1).
+    void remap_features(const std::vector<int>& new_index);
+
+    // Compactação pós-treino: colapsa subárvores cujas folhas predizem
+    // todas a mesma classe (a predição não muda). Retorna nós removidos.
+    // Só no modo Class: com tabela de saídas o colapso mudaria a saída.
+    int compact();
+    int count_nodes() const;
+
+    // Semente do sorteio de features (mtry) desta árvore
+    void set_seed(unsigned int seed) { rng.seed(seed); tree_seed = seed; }
+
+    // Crescimento por nível (breadth-first): cada nível é construído com
+    // uma varredura sequencial por feature sobre as colunas pré-ordenadas,
+    // acumulando as estatísticas de todos os nós do nível de uma vez.
+    // `presorted` pode ser compartilhado entre árvores (ver presort_columns);
+    // nullptr = a árvore ordena as colunas no fit. O sorteio de features de
+    // cada nó usa uma semente derivada de (semente da árvore, id do nó no
+    // heap), então a árvore não depende da ordem de processamento.
+    // Colunas categóricas e ExtraTrees continuam no crescimento recursivo.
+    void set_level_wise(bool enabled, const ColumnOrder* presorted = nullptr) {
+        level_wise = enabled;
+        presorted_columns = presorted;
+    }
+    bool get_level_wise() const { return level_wise; }
+
+    // Ordena cada coluna numérica uma vez (categóricas ficam vazias)
+    static void presort_columns(const std::vector<std::vector<double>>& X_col_major,
+                                const std::vector<char>& is_categorical,
+                                ColumnOrder& order);
+
+    // ExtraTrees: cada feature sorteada recebe um único threshold
+    // aleatório entre o mínimo e o máximo do nó (sem sort)
+    void set_extra_trees(bool enabled) { extra_trees = enabled; }
+
+    // Features sorteadas por nó (0 = sqrt(total), padrão da Random Forest)
+    void set_max_features(int n) { max_features = n; }
+
+    // Telemetria do próximo fit (nullptr desliga; ver TrainingTrace.h)
+    void set_trace(TreeTrace* t) { trace = t; }
+
+    // Colunas categóricas (is_categorical[f] != 0): os valores devem ser
+    // inteiros em [0, 64) e o split agrupa categorias em vez de ordenar
+    void set_categorical_features(const std::vector<char>& is_categorical) {
+        categorical = is_categorical;
+    }
+
+    // Confere os códigos das colunas categóricas (invalid_argument se
+    // algum valor não for inteiro em [0, 64)). O fit confere de novo;
+    // quem treina árvores em paralelo chama antes, fora das tarefas.
+    static void validate_categorical_columns(const std::vector<std::vector<double>>& X_col_major,
+                                             const std::vector<char>& is_categorical);
     
     std::vector<int> predict(const std::vector<std::vector<double>>& X) const;
     int predict_one(const std::vector<double>& sample) const;
 
+    // Folha alcançada pela amostra (travessia iterativa)
+    const Node* find_leaf(const double* sample) const;
+    // Saída da folha (get_leaf_width() floats) ou nullptr no modo Class
+    const float* predict_leaf_output(const double* sample) const;
+    // Classe da árvore truncada em cada profundidade 0..max_d (classe
+    // majoritária do nó do caminho nessa profundidade, ou da folha se o
+    // caminho acabar antes), numa só travessia. classes: max_d + 1 ints.
+    void predict_depths(const double* sample, int max_d, int* classes) const;
+
     // Serialização
     void save_model(std::ostream& out) const;
     void load_model(std::istream& in);
@@ -48,6 +209,26 @@ private:
     int max_depth;
     int min_samples_split;
     int num_classes; 
+    std::mt19937 rng;
+    TreeTrace* trace = nullptr;
+    std::vector<char> categorical;
+
+    LeafMode leaf_mode = LeafMode::Class;
+    bool extra_trees = false;
+    int max_features = 0;
+    unsigned int tree_seed = 12345;
+
+    bool level_wise = false;
+    const ColumnOrder* presorted_columns = nullptr;
+
+    // Estatísticas do boosting durante fit_gradient_columns
+    const std::vector<double>* grad_stats = nullptr;
+    const std::vector<double>* hess_stats = nullptr;
+    GradientParams gradient_params;
+    std::vector<double> importance;                     // por feature, no último fit
+    std::vector<int> split_counts;
+    std::vector<float> leaf_values;                     // tabela de saídas das folhas
+    const std::vector<double>* reg_targets = nullptr;   // alvo durante o fit de regressão
 
     struct SampleEntry {
         double value;
@@ -69,13 +250,110 @@ private:
         double& best_threshold,
         std::vector<int>& left_idx,
         std::vector<int>& right_idx,
-        double parent_gini);
+        double parent_impurity,
+        TraceLevel* stats,
+        uint64_t& best_mask,
+        double& best_gain);
+
+    void reset_split_stats(size_t n_features) {
+        importance.assign(n_features, 0.0);
+        split_counts.assign(n_features, 0);
+    }
+    void record_split(int feature, double decrease) {
+        importance[feature] += decrease;
+        split_counts[feature]++;
+    }
+
+    // Melhor agrupamento das categorias de uma coluna: categorias ordenadas
+    // pela fração da classe majoritária do nó e cortadas num prefixo (ótimo
+    // para alvo binário). Atualiza best_gain/best_mask se achar ganho maior.
+    bool find_best_category_split(
+        const std::vector<double>& feature_col,
+        const std::vector<int>& y,
+        const std::vector<int>& indices,
+        const std::vector<int>& total_counts,
+        double parent_gini,
+        std::vector<int>& category_counts,
+        double& best_gain,
+        uint64_t& best_mask,
+        long long& splits_evaluated) const;
+
+    // Versão de regressão: categorias ordenadas pela média do alvo
+    // (ótimo exato para MSE); somas centradas na média do nó.
+    bool find_best_category_split_mse(
+        const std::vector<double>& feature_col,
+        const std::vector<int>& indices,
+        double node_mean,
+        double parent_variance,
+        double& best_gain,
+        uint64_t& best_mask,
+        long long& splits_evaluated) const;
+
+    // ExtraTrees: passada de min/max e passada de contagem, O(n) cada.
+    // Atualiza best_gain/best_threshold se o corte sorteado for melhor.
+    bool find_random_split(
+        const std::vector<double>& feature_col,
+        const std::vector<int>& y,
+        const std::vector<int>& indices,
+        const std::vector<int>& total_counts,
+        double node_mean,
+        double parent_impurity,
+        std::vector<int>& left_counts,
+        double& best_gain,
+        double& best_threshold);
+
+    // Versão do boosting: categorias ordenadas por G/H da categoria
+    bool find_best_category_split_gradient(
+        const std::vector<double>& feature_col,
+        const std::vector<int>& indices,
+        double parent_score,
+        double& best_gain,
+        uint64_t& best_mask,
+        long long& splits_evaluated) const;
+
+    // Boosting: soma de G e H das amostras, score G²/(H+λ) e ganho
+    void gradient_sums(const std::vector<int>& indices, double& G, double& H) const;
+    double gradient_score(double G, double H) const {
+        return G * G / (H + gradient_params.lambda);
+    }
+    double gradient_split_gain(const std::vector<int>& left_idx,
+                               const std::vector<int>& right_idx) const;
+    float gradient_leaf_value(const std::vector<int>& indices) const;
+
+    // Crescimento por folha (best-first) até max_leaves folhas
+    std::unique_ptr<Node> build_tree_leaf_wise(
+        const std::vector<std::vector<double>>& X_col_major,
+        const std::vector<int>& indices);
+
+    // Crescimento por nível sobre as colunas pré-ordenadas (classificação
+    // e regressão, só colunas numéricas)
+    bool can_grow_level_wise() const;
+    std::unique_ptr<Node> build_tree_level_wise(
+        const std::vector<std::vector<double>>& X_col_major,
+        const std::vector<int>& y,
+        const std::vector<int>& indices);
+    // Features sorteadas para o nó (mtry), com o gerador dado
+    void sample_features(size_t n_features, std::mt19937& gen,
+                         std::vector<int>& candidates, size_t& n_to_check) const;
+
+    bool is_categorical_feature(int f) const {
+        return f < (int)categorical.size() && categorical[f];
+    }
+    void validate_categorical(const std::vector<std::vector<double>>& X_col_major) const;
 
     // Utilitários
     double calculate_gini_from_counts(const std::vector<int>& counts, int total) const;
     int predict_sample(const std::vector<double>& sample, const Node* node) const;
     
-    // Serialização Helpers
+    int collapse_node(std::unique_ptr<Node>& node, int& removed);
+    void remap_node(Node* node, const std::vector<int>& new_index);
+    int count_subtree(const Node* node) const;
+
+    // Serialização Helpers (tipo do nó gravado num byte)
+    enum NodeKind : uint8_t { NODE_NUMERIC = 0, NODE_LEAF = 1, NODE_CATEGORICAL = 2,
+                              NODE_LEAF_DISTRIBUTION = 3, NODE_LEAF_VALUE = 4 };
+    // Bit no byte do tipo: seguido da contagem de amostras (int) do nó
+    static constexpr uint8_t NODE_HAS_COUNT = 0x80;
     void save_node(std::ostream& out, const Node* node) const;
     std::unique_ptr<Node> load_node(std::istream& in);
 };
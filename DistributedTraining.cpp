@@ -0,0 +1,264 @@
+#include "DistributedTraining.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const uint32_t HELLO_MAGIC = 0x32574652;   // "RFW2" (hello com checksum dos dados)
+const int32_t STATUS_OK = 0;
+const int32_t STATUS_ERROR = 1;
+
+std::string errno_message(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+sockaddr_un make_address(const std::string& path) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path))
+        throw std::invalid_argument("caminho de socket invalido: " + path);
+    std::memcpy(addr.sun_path, path.c_str(), path.size());
+    return addr;
+}
+
+// send/recv completos (MSG_NOSIGNAL: worker morto vira erro, não SIGPIPE)
+void send_all(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t n = ::send(fd, p, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(errno_message("erro ao enviar pelo socket"));
+        }
+        p += n;
+        size -= n;
+    }
+}
+
+void recv_all(int fd, void* data, size_t size) {
+    char* p = static_cast<char*>(data);
+    while (size > 0) {
+        const ssize_t n = ::recv(fd, p, size, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(errno_message("erro ao receber pelo socket"));
+        }
+        if (n == 0)
+            throw std::runtime_error("conexao encerrada pelo outro processo");
+        p += n;
+        size -= n;
+    }
+}
+
+template <typename T>
+void send_value(int fd, T value) { send_all(fd, &value, sizeof(value)); }
+
+template <typename T>
+T recv_value(int fd) {
+    T value;
+    recv_all(fd, &value, sizeof(value));
+    return value;
+}
+
+void send_blob(int fd, int32_t status, const std::string& bytes) {
+    send_value<int32_t>(fd, status);
+    send_value<uint64_t>(fd, bytes.size());
+    send_all(fd, bytes.data(), bytes.size());
+}
+
+} // namespace
+
+uint64_t ShardConfig::hash_options(const std::string& description)
+{
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : description) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// ============================================================
+// Coordenador
+// ============================================================
+ShardCoordinator::ShardCoordinator(const std::string& socket_path, int n_workers, int timeout_ms)
+    : path(socket_path), n_workers(n_workers), timeout_ms(timeout_ms)
+{
+    if (n_workers <= 0)
+        throw std::invalid_argument("numero de workers deve ser positivo");
+
+    const sockaddr_un addr = make_address(path);
+    listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0)
+        throw std::runtime_error(errno_message("erro ao criar socket"));
+
+    ::unlink(path.c_str());
+    if (::bind(listen_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd, n_workers) < 0) {
+        const std::string message = errno_message("erro ao escutar em " + path);
+        ::close(listen_fd);
+        throw std::runtime_error(message);
+    }
+}
+
+ShardCoordinator::~ShardCoordinator()
+{
+    for (int fd : worker_fds) ::close(fd);
+    if (listen_fd >= 0) {
+        ::close(listen_fd);
+        ::unlink(path.c_str());
+    }
+}
+
+void ShardCoordinator::assign(const ShardConfig& config, int forest_trees, unsigned int seed)
+{
+    if (forest_trees < n_workers)
+        throw std::invalid_argument("menos arvores que workers");
+
+    assignments.clear();
+    for (int k = 0; k < n_workers; k++) {
+        // poll antes do accept: worker que não conecta não trava o coordenador
+        pollfd pending = {listen_fd, POLLIN, 0};
+        int ready;
+        do {
+            ready = ::poll(&pending, 1, timeout_ms);
+        } while (ready < 0 && errno == EINTR);
+        if (ready < 0)
+            throw std::runtime_error(errno_message("erro ao esperar worker"));
+        if (ready == 0)
+            throw std::runtime_error("worker " + std::to_string(k) + " nao conectou em " +
+                                     std::to_string(timeout_ms) + " ms");
+
+        int fd;
+        do {
+            fd = ::accept(listen_fd, nullptr, nullptr);
+        } while (fd < 0 && errno == EINTR);
+        if (fd < 0)
+            throw std::runtime_error(errno_message("erro ao aceitar worker"));
+        worker_fds.push_back(fd);
+
+        const uint32_t magic = recv_value<uint32_t>(fd);
+        ShardConfig worker;
+        worker.n_samples = recv_value<uint32_t>(fd);
+        worker.n_features = recv_value<uint32_t>(fd);
+        worker.data_checksum = recv_value<uint64_t>(fd);
+        worker.config_hash = recv_value<uint64_t>(fd);
+
+        const bool accepted = magic == HELLO_MAGIC &&
+                              worker.n_samples == config.n_samples &&
+                              worker.n_features == config.n_features &&
+                              worker.data_checksum == config.data_checksum &&
+                              worker.config_hash == config.config_hash;
+
+        // faixa contígua k de n_workers
+        ShardAssignment a;
+        a.seed = seed;
+        a.forest_trees = forest_trees;
+        a.first_tree = (int)((long long)k * forest_trees / n_workers);
+        a.n_trees = (int)((long long)(k + 1) * forest_trees / n_workers) - a.first_tree;
+
+        send_value<int32_t>(fd, accepted ? STATUS_OK : STATUS_ERROR);
+        send_value<uint32_t>(fd, a.seed);
+        send_value<int32_t>(fd, a.forest_trees);
+        send_value<int32_t>(fd, a.first_tree);
+        send_value<int32_t>(fd, a.n_trees);
+
+        if (!accepted)
+            throw std::runtime_error("worker " + std::to_string(k) + " com dataset ou opcoes "
+                                     "diferentes (" + std::to_string(worker.n_samples) + " x " +
+                                     std::to_string(worker.n_features) + ")");
+        assignments.push_back(a);
+    }
+}
+
+std::vector<std::string> ShardCoordinator::collect()
+{
+    // workers treinam em paralelo; a leitura em ordem só espera o mais lento
+    std::vector<std::string> models;
+    for (size_t k = 0; k < worker_fds.size(); k++) {
+        try {
+            const int32_t status = recv_value<int32_t>(worker_fds[k]);
+            const uint64_t size = recv_value<uint64_t>(worker_fds[k]);
+            std::string bytes(size, '\0');
+            recv_all(worker_fds[k], &bytes[0], size);
+            if (status != STATUS_OK)
+                throw std::runtime_error(bytes);
+            models.push_back(std::move(bytes));
+        } catch (const std::exception& e) {
+            throw std::runtime_error("worker " + std::to_string(k) + ": " + e.what());
+        }
+    }
+    return models;
+}
+
+// ============================================================
+// Worker
+// ============================================================
+ShardWorker::ShardWorker(const std::string& socket_path, int timeout_ms)
+{
+    const sockaddr_un addr = make_address(socket_path);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+    while (true) {
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            throw std::runtime_error(errno_message("erro ao criar socket"));
+        if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0)
+            return;
+
+        const int err = errno;
+        ::close(fd);
+        fd = -1;
+        // socket ainda não criado ou coordenador ainda não escutando
+        const bool retry = (err == ENOENT || err == ECONNREFUSED || err == EINTR);
+        if (!retry || std::chrono::steady_clock::now() >= deadline) {
+            errno = err;
+            throw std::runtime_error(errno_message("erro ao conectar em " + socket_path));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+}
+
+ShardWorker::~ShardWorker()
+{
+    if (fd >= 0) ::close(fd);
+}
+
+ShardAssignment ShardWorker::handshake(const ShardConfig& config)
+{
+    send_value<uint32_t>(fd, HELLO_MAGIC);
+    send_value<uint32_t>(fd, config.n_samples);
+    send_value<uint32_t>(fd, config.n_features);
+    send_value<uint64_t>(fd, config.data_checksum);
+    send_value<uint64_t>(fd, config.config_hash);
+
+    const int32_t status = recv_value<int32_t>(fd);
+    ShardAssignment a;
+    a.seed = recv_value<uint32_t>(fd);
+    a.forest_trees = recv_value<int32_t>(fd);
+    a.first_tree = recv_value<int32_t>(fd);
+    a.n_trees = recv_value<int32_t>(fd);
+    if (status != STATUS_OK)
+        throw std::runtime_error("coordenador recusou o worker: dataset ou opcoes diferentes");
+    return a;
+}
+
+void ShardWorker::send_model(const std::string& model_bytes)
+{
+    send_blob(fd, STATUS_OK, model_bytes);
+}
+
+void ShardWorker::send_error(const std::string& message)
+{
+    send_blob(fd, STATUS_ERROR, message);
+}
@@ -0,0 +1,95 @@
+#ifndef DISTRIBUTED_TRAINING_H
+#define DISTRIBUTED_TRAINING_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------
+// Treino da floresta em vários processos (coordenador + workers)
+//
+// Os processos conversam por um Unix domain socket (SOCK_STREAM):
+//  1. worker -> coordenador: hello (magic, linhas, features, checksum
+//     do conteúdo do dataset e hash da configuração de treino), para
+//     garantir o mesmo dataset e opções
+//  2. coordenador -> worker: faixa de árvores (semente da floresta,
+//     total de árvores, primeira árvore, árvores da faixa)
+//  3. worker -> coordenador: status + tamanho + modelo parcial (formato
+//     .model de RandomForestOptimized) ou mensagem de erro
+// As faixas são contíguas e seguem a ordem de conexão; o coordenador
+// devolve os modelos na ordem das faixas, prontos para merge_models.
+// Inteiros em little-endian, sem padding (campo a campo).
+// ------------------------------------------------------------
+
+// Identificação do treino que todos os processos precisam compartilhar
+struct ShardConfig {
+    uint32_t n_samples = 0;
+    uint32_t n_features = 0;
+    uint64_t data_checksum = 0;  // DataLoader::checksum de X e y
+    uint64_t config_hash = 0;    // hash das opções que mudam as árvores
+
+    // FNV-1a de uma descrição textual das opções
+    static uint64_t hash_options(const std::string& description);
+};
+
+// Faixa de árvores de um worker
+struct ShardAssignment {
+    unsigned int seed = 0;
+    int forest_trees = 0;   // árvores da floresta completa
+    int first_tree = 0;     // primeira árvore da faixa
+    int n_trees = 0;        // árvores da faixa
+};
+
+class ShardCoordinator {
+public:
+    // Cria o socket (removendo um arquivo antigo no mesmo caminho) e
+    // escuta até n_workers conexões. timeout_ms: espera máxima por cada
+    // worker no assign (um worker que morre antes de conectar vira erro)
+    ShardCoordinator(const std::string& socket_path, int n_workers, int timeout_ms = 30000);
+    ~ShardCoordinator();
+
+    ShardCoordinator(const ShardCoordinator&) = delete;
+    ShardCoordinator& operator=(const ShardCoordinator&) = delete;
+
+    // Aceita os workers, confere a configuração de cada um e envia as
+    // faixas de [0, forest_trees). Lança runtime_error se algum worker
+    // vier com dataset/opções diferentes ou não conectar a tempo.
+    void assign(const ShardConfig& config, int forest_trees, unsigned int seed);
+
+    // Recebe os modelos parciais na ordem das faixas. Lança se algum
+    // worker reportar erro ou desconectar.
+    std::vector<std::string> collect();
+
+    const std::vector<ShardAssignment>& get_assignments() const { return assignments; }
+
+private:
+    std::string path;
+    int n_workers;
+    int timeout_ms;
+    int listen_fd = -1;
+    std::vector<int> worker_fds;
+    std::vector<ShardAssignment> assignments;
+};
+
+class ShardWorker {
+public:
+    // Conecta ao coordenador, tentando de novo até timeout_ms (o
+    // coordenador pode ainda não ter criado o socket)
+    explicit ShardWorker(const std::string& socket_path, int timeout_ms = 30000);
+    ~ShardWorker();
+
+    ShardWorker(const ShardWorker&) = delete;
+    ShardWorker& operator=(const ShardWorker&) = delete;
+
+    // Envia o hello e recebe a faixa. Lança runtime_error se o
+    // coordenador recusar a configuração.
+    ShardAssignment handshake(const ShardConfig& config);
+
+    void send_model(const std::string& model_bytes);
+    void send_error(const std::string& message);
+
+private:
+    int fd = -1;
+};
+
+#endif // DISTRIBUTED_TRAINING_H
@@ -0,0 +1,166 @@
+#include "FlatForest.h"
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+
+// ============================================================
+// Construção a partir das árvores treinadas (ponteiros)
+// ============================================================
+void FlatForest::build(const std::vector<DecisionTree>& trees, Layout layout)
+{
+    clear();
+    roots.reserve(trees.size());
+
+    size_t total_nodes = 0;
+    for (const auto& tree : trees)
+        total_nodes += tree.count_nodes();
+    nodes.reserve(total_nodes);
+
+    // Tabelas de saída das árvores concatenadas (sem deduplicação)
+    leaf_width = trees.empty() ? 0 : trees[0].get_leaf_width();
+    for (const auto& tree : trees) {
+        if (tree.get_leaf_width() != leaf_width)
+            throw std::runtime_error("Arvores com modos de folha diferentes na mesma floresta");
+        const int leaf_offset = leaf_classes.size();
+        if (leaf_width) {
+            leaf_values.insert(leaf_values.end(), tree.get_leaf_values().begin(),
+                               tree.get_leaf_values().end());
+            leaf_classes.resize(leaf_offset + tree.get_num_table_leaves(), -1);
+        }
+        const Node* root = tree.get_root();
+        const bool profiled = layout == Layout::Profiled && root && root->n_samples > 0;
+        roots.push_back(profiled ? append_profiled(root, leaf_offset)
+                                 : append_subtree(root, leaf_offset));
+    }
+}
+
+void FlatForest::clear()
+{
+    nodes.clear();
+    roots.clear();
+    leaf_width = 0;
+    leaf_values.clear();
+    leaf_classes.clear();
+}
+
+size_t FlatForest::memory_bytes() const
+{
+    return nodes.size() * sizeof(FlatNode) + roots.size() * sizeof(int32_t) +
+           leaf_values.size() * sizeof(float) + leaf_classes.size() * sizeof(int32_t);
+}
+
+// ============================================================
+// Pré-ordem: o nó é reservado antes dos filhos, então o filho
+// esquerdo interno fica sempre na posição seguinte ao pai
+// ============================================================
+int32_t FlatForest::append_subtree(const Node* node, int leaf_offset)
+{
+    if (!node || node->is_leaf) return terminal_ref(node, leaf_offset);
+
+    int32_t index = append_node(node);
+    int32_t left = append_subtree(node->left.get(), leaf_offset);
+    int32_t right = append_subtree(node->right.get(), leaf_offset);
+    nodes[index].child[0] = left;
+    nodes[index].child[1] = right;
+    return index;
+}
+
+// Referência de folha (ou de árvore vazia)
+int32_t FlatForest::terminal_ref(const Node* node, int leaf_offset)
+{
+    // árvore vazia vota -1 (mesmo comportamento de predict_sample); nos
+    // modos com tabela ganha uma folha de saída zerada
+    if (!node && leaf_width) {
+        leaf_values.resize(leaf_values.size() + leaf_width, 0.0f);
+        leaf_classes.push_back(-1);
+        return leaf_ref(leaf_classes.size() - 1);
+    }
+    if (!node) return leaf_ref(-1);
+    if (!leaf_width) return leaf_ref(node->predicted_class);
+    const int leaf = leaf_offset + node->leaf_index;
+    leaf_classes[leaf] = node->predicted_class;
+    return leaf_ref(leaf);
+}
+
+// Nó interno no fim do vetor (filhos preenchidos por quem chamou)
+int32_t FlatForest::append_node(const Node* node)
+{
+    int32_t index = nodes.size();
+    nodes.push_back(FlatNode{{node->threshold}, node->feature_index, {0, 0}});
+    if (node->is_categorical()) {
+        nodes[index].category_mask = node->category_mask;
+        nodes[index].feature_index = ~node->feature_index;
+    }
+    return index;
+}
+
+// ============================================================
+// Layout guiado por perfil: cadeias quentes. A partir da raiz segue
+// sempre o filho com mais amostras de treino, gravando os nós em
+// sequência (o filho quente fica logo após o pai). Cada filho frio
+// abre uma cadeia pendente; a próxima cadeia gravada é a pendente que
+// recebeu mais amostras, então os caminhos mais percorridos ocupam o
+// início da árvore e os ramos raros vão para o fim.
+// ============================================================
+int32_t FlatForest::append_profiled(const Node* root, int leaf_offset)
+{
+    if (root->is_leaf) return terminal_ref(root, leaf_offset);
+
+    // folhas carregadas de um modelo não têm contagem: vem do irmão
+    auto child_samples = [](const Node* parent, int side) {
+        const Node* child = side ? parent->right.get() : parent->left.get();
+        const Node* sibling = side ? parent->left.get() : parent->right.get();
+        if (child->n_samples > 0 || sibling->n_samples <= 0) return child->n_samples;
+        return std::max(0, parent->n_samples - sibling->n_samples);
+    };
+
+    struct Chain {
+        int samples;
+        int order;            // desempate estável: ordem de descoberta
+        const Node* node;
+        int32_t parent;
+        int side;
+        bool operator<(const Chain& other) const {
+            if (samples != other.samples) return samples < other.samples;
+            return order > other.order;
+        }
+    };
+    std::priority_queue<Chain> pending;
+    int discovered = 0;
+    int32_t root_index = -1;
+    pending.push(Chain{root->n_samples, discovered++, root, -1, 0});
+
+    while (!pending.empty()) {
+        Chain chain = pending.top();
+        pending.pop();
+
+        const Node* node = chain.node;
+        int32_t parent = chain.parent;
+        int side = chain.side;
+        while (node) {
+            const int32_t index = append_node(node);
+            if (parent >= 0) nodes[parent].child[side] = index;
+            else             root_index = index;
+
+            const int left_samples = child_samples(node, 0);
+            const int right_samples = child_samples(node, 1);
+            const int hot = right_samples > left_samples ? 1 : 0;
+            const Node* next = nullptr;
+            for (int s = 0; s < 2; s++) {
+                const Node* child = s ? node->right.get() : node->left.get();
+                if (child->is_leaf)
+                    nodes[index].child[s] = terminal_ref(child, leaf_offset);
+                else if (s == hot)
+                    next = child;
+                else
+                    pending.push(Chain{s ? right_samples : left_samples, discovered++,
+                                       child, index, s});
+            }
+            parent = index;
+            side = hot;
+            node = next;
+        }
+    }
+    return root_index;
+}
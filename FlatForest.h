@@ -0,0 +1,118 @@
+#ifndef FLAT_FOREST_H
+#define FLAT_FOREST_H
+
+#include <vector>
+#include <cstdint>
+#include "DecisionTree.h"
+
+// ------------------------------------------------------------
+// FlatForest
+// Representação achatada (somente inferência) de uma floresta:
+// todos os nós internos de todas as árvores num único vetor contíguo,
+// em pré-ordem ou na ordem guiada por perfil (ver Layout). Folhas não ocupam nós: uma referência de filho negativa
+// codifica a classe (~(classe + 1)), então folhas iguais são deduplicadas.
+// Com folhas de distribuição/regressão, a referência codifica o índice
+// global da folha (~(folha + 1)) numa tabela contígua de saídas.
+// ------------------------------------------------------------
+// Split categórico: feature_index = ~feature e category_mask no lugar
+// do threshold (o nó continua com 16 bytes).
+struct FlatNode {
+    union {
+        double threshold;
+        uint64_t category_mask;
+    };
+    int32_t feature_index;
+    int32_t child[2];   // [0] = x <= threshold, [1] = x > threshold
+
+    bool is_categorical() const { return feature_index < 0; }
+    int feature() const         { return feature_index < 0 ? ~feature_index : feature_index; }
+};
+
+class FlatForest {
+public:
+    // Ordem dos nós de cada árvore no vetor:
+    //  Preorder: pré-ordem (filho esquerdo logo após o pai)
+    //  Profiled: guiada pelas frequências do treino (Node::n_samples). O
+    //   filho mais visitado fica logo após o pai e os caminhos quentes de
+    //   todas as árvores vêm primeiro, nas primeiras linhas de cache da
+    //   árvore. Árvores sem contagem (modelo antigo) ficam em pré-ordem.
+    // A raiz é sempre o primeiro nó da árvore e as árvores são contíguas.
+    enum class Layout : uint8_t { Preorder, Profiled };
+
+    FlatForest() = default;
+
+    void build(const std::vector<DecisionTree>& trees, Layout layout = Layout::Preorder);
+    void clear();
+
+    bool empty() const                 { return roots.empty(); }
+    int get_num_trees() const          { return roots.size(); }
+    size_t get_num_nodes() const       { return nodes.size(); }
+    size_t memory_bytes() const;
+
+    // Acesso somente leitura para representações derivadas (ex: quantizada)
+    const std::vector<FlatNode>& get_nodes() const { return nodes; }
+    const std::vector<int32_t>& get_roots() const  { return roots; }
+    static bool is_leaf_ref(int32_t ref)           { return ref < 0; }
+    static int leaf_class(int32_t ref)             { return ~ref - 1; }
+    // Classe de uma referência de folha (também nos modos com tabela)
+    int ref_class(int32_t ref) const {
+        return leaf_width ? leaf_classes[~ref - 1] : ~ref - 1;
+    }
+
+    // Saídas por folha (0 = só classe); ver DecisionTree::LeafMode
+    int get_leaf_width() const                     { return leaf_width; }
+    const float* leaf_output(int leaf) const       { return &leaf_values[(size_t)leaf * leaf_width]; }
+
+    // Voto da árvore t para uma amostra (vetor de features denso)
+    inline int predict_tree(int t, const double* sample) const {
+        return ref_class(find_leaf_ref(t, sample));
+    }
+
+    // Classe mais votada; no empate, a menor classe (-1 sem votos). Regra
+    // de voto única de todas as florestas e formas de inferência.
+    static inline int majority_class(const int* counts, int n_classes) {
+        int best_class = -1, best_count = 0;
+        for (int c = 0; c < n_classes; c++)
+            if (counts[c] > best_count) {
+                best_count = counts[c];
+                best_class = c;
+            }
+        return best_class;
+    }
+
+    // Índice global da folha alcançada (modos com tabela)
+    inline int find_leaf(int t, const double* sample) const {
+        return ~find_leaf_ref(t, sample) - 1;
+    }
+
+    inline int32_t find_leaf_ref(int t, const double* sample) const {
+        int ref = roots[t];
+        while (ref >= 0) {
+            const FlatNode& node = nodes[ref];
+            // !(x <= t) preserva o mesmo lado da árvore original para NaN
+            if (node.feature_index >= 0)
+                ref = node.child[!(sample[node.feature_index] <= node.threshold)];
+            else
+                ref = node.child[!category_in_mask(sample[~node.feature_index], node.category_mask)];
+        }
+        return ref;
+    }
+
+private:
+    friend class CompactModel;    // decodifica direto nos vetores
+
+    std::vector<FlatNode> nodes;
+    std::vector<int32_t> roots;   // referência da raiz de cada árvore
+
+    int leaf_width = 0;
+    std::vector<float> leaf_values;    // leaf_width floats por folha
+    std::vector<int32_t> leaf_classes; // classe majoritária de cada folha
+
+    static int32_t leaf_ref(int value) { return ~(value + 1); }
+    int32_t terminal_ref(const Node* node, int leaf_offset);
+    int32_t append_subtree(const Node* node, int leaf_offset);
+    int32_t append_profiled(const Node* root, int leaf_offset);
+    int32_t append_node(const Node* node);
+};
+
+#endif // FLAT_FOREST_H
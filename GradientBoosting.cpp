@@ -0,0 +1,334 @@
+#include "GradientBoosting.h"
+#include "DataLoader.h"
+#include "PerfCounters.h"
+
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+// ============================================================
+// Construtor
+// ============================================================
+GradientBoosting::GradientBoosting(int n_rounds,
+                                   int max_depth,
+                                   double learning_rate,
+                                   int max_leaves)
+    : n_rounds(n_rounds),
+      max_depth(max_depth)
+{
+    if (n_rounds < 1 || max_depth < 1)
+        throw std::invalid_argument("boosting precisa de n_rounds >= 1 e max_depth >= 1");
+    if (learning_rate <= 0.0)
+        throw std::invalid_argument("learning_rate deve ser positivo");
+
+    params.learning_rate = learning_rate;
+    params.max_leaves = max_leaves;
+}
+
+// ============================================================
+// Treino
+// ============================================================
+void GradientBoosting::fit(const std::vector<std::vector<double>>& X,
+                           const std::vector<int>& y)
+{
+    train(X, &y, nullptr);
+}
+
+void GradientBoosting::fit_regression(const std::vector<std::vector<double>>& X,
+                                      const std::vector<double>& y)
+{
+    train(X, nullptr, &y);
+}
+
+void GradientBoosting::train(const std::vector<std::vector<double>>& X,
+                             const std::vector<int>* labels,
+                             const std::vector<double>* targets)
+{
+    const int n_samples = X.size();
+    const size_t n_labels = labels ? labels->size() : targets->size();
+    if (n_samples == 0 || n_labels != (size_t)n_samples)
+        throw std::invalid_argument("X e y do boosting vazios ou com tamanhos diferentes");
+
+    // Perda e margem inicial (constante ótima de cada perda)
+    if (targets) {
+        loss = Loss::Squared;
+        n_outputs = 1;
+        base_score.assign(1, std::accumulate(targets->begin(), targets->end(), 0.0) / n_samples);
+    } else {
+        int num_classes = 2;
+        for (int label : *labels) {
+            if (label < 0)
+                throw std::invalid_argument("labels do boosting devem ser >= 0");
+            num_classes = std::max(num_classes, label + 1);
+        }
+        std::vector<double> class_count(num_classes, 0.0);
+        for (int label : *labels) class_count[label]++;
+
+        if (num_classes == 2) {
+            loss = Loss::Logistic;
+            n_outputs = 1;
+            const double p = std::min(std::max(class_count[1] / n_samples, 1e-6), 1.0 - 1e-6);
+            base_score.assign(1, std::log(p / (1.0 - p)));
+        } else {
+            loss = Loss::Softmax;
+            n_outputs = num_classes;
+            base_score.resize(num_classes);
+            for (int k = 0; k < num_classes; k++)
+                base_score[k] = std::log(std::max(class_count[k], 1.0) / n_samples);
+        }
+    }
+
+    // Dataset transposto uma vez e compartilhado por todas as rodadas
+    std::vector<std::vector<double>> X_col;
+    DataLoader::to_column_major(X, X_col);
+    const int n_features = X_col.size();
+
+    std::vector<char> is_categorical(n_features, 0);
+    for (int f : categorical_columns) {
+        if (f < 0 || f >= n_features)
+            throw std::invalid_argument("coluna categorica fora do dataset: " + std::to_string(f));
+        is_categorical[f] = 1;
+    }
+    DecisionTree::validate_categorical_columns(X_col, is_categorical);
+    const int max_features = std::max(1, (int)std::lround(feature_fraction * n_features));
+
+    std::vector<int> indices(n_samples);
+    std::iota(indices.begin(), indices.end(), 0);
+
+    std::vector<double> margins((size_t)n_samples * n_outputs);
+    for (int i = 0; i < n_samples; i++)
+        std::copy(base_score.begin(), base_score.end(), margins.begin() + (size_t)i * n_outputs);
+
+    std::vector<std::vector<double>> grad(n_outputs), hess(n_outputs);
+    trees.clear();
+    trees.reserve((size_t)n_rounds * n_outputs);
+    flat.clear();
+
+    ThreadPool& pool = get_pool();
+    const int block = 1024;
+    const int n_blocks = (n_samples + block - 1) / block;
+
+    for (int round = 0; round < n_rounds; round++) {
+        compute_gradients(margins, labels, targets, grad, hess);
+
+        // Uma árvore por saída; no softmax as classes são independentes
+        const int first = trees.size();
+        trees.resize(first + n_outputs);
+        pool.parallel_for(n_outputs, [&](int k) {
+            DecisionTree tree(max_depth, min_samples_split);
+            tree.set_seed(seed ^ (0x9E3779B9u * (unsigned int)(first + k + 1)));
+            tree.set_max_features(max_features);
+            tree.set_categorical_features(is_categorical);
+            tree.fit_gradient_columns(X_col, grad[k], hess[k], indices, params);
+            trees[first + k] = std::move(tree);
+        });
+
+        // Margens += saída das árvores novas (a folha já tem o shrinkage)
+        pool.parallel_for(n_blocks, [&](int b) {
+            const int end = std::min(n_samples, (b + 1) * block);
+            for (int i = b * block; i < end; i++)
+                for (int k = 0; k < n_outputs; k++) {
+                    const float* leaf = trees[first + k].predict_leaf_output(X[i].data());
+                    if (leaf) margins[(size_t)i * n_outputs + k] += *leaf;
+                }
+        });
+    }
+
+    flat.build(trees);
+}
+
+// ============================================================
+// Gradiente e hessiana da perda em relação à margem
+// ============================================================
+void GradientBoosting::compute_gradients(const std::vector<double>& margins,
+                                         const std::vector<int>* labels,
+                                         const std::vector<double>* targets,
+                                         std::vector<std::vector<double>>& grad,
+                                         std::vector<std::vector<double>>& hess) const
+{
+    const int n_samples = margins.size() / n_outputs;
+    for (int k = 0; k < n_outputs; k++) {
+        grad[k].resize(n_samples);
+        hess[k].resize(n_samples);
+    }
+    const double min_hessian = 1e-16;
+
+    switch (loss) {
+    case Loss::Squared:
+        for (int i = 0; i < n_samples; i++) {
+            grad[0][i] = margins[i] - (*targets)[i];
+            hess[0][i] = 1.0;
+        }
+        break;
+
+    case Loss::Logistic:
+        for (int i = 0; i < n_samples; i++) {
+            const double p = 1.0 / (1.0 + std::exp(-margins[i]));
+            grad[0][i] = p - ((*labels)[i] == 1 ? 1.0 : 0.0);
+            hess[0][i] = std::max(p * (1.0 - p), min_hessian);
+        }
+        break;
+
+    case Loss::Softmax:
+        for (int i = 0; i < n_samples; i++) {
+            const double* m = &margins[(size_t)i * n_outputs];
+            const double max_m = *std::max_element(m, m + n_outputs);
+            double sum = 0.0;
+            for (int k = 0; k < n_outputs; k++) sum += std::exp(m[k] - max_m);
+            for (int k = 0; k < n_outputs; k++) {
+                const double p = std::exp(m[k] - max_m) / sum;
+                grad[k][i] = p - ((*labels)[i] == k ? 1.0 : 0.0);
+                hess[k][i] = std::max(p * (1.0 - p), min_hessian);
+            }
+        }
+        break;
+    }
+}
+
+// ============================================================
+// Predição pela forma achatada: margem = base + soma das folhas da
+// árvore de cada saída (linha por linha, como a floresta achatada)
+// ============================================================
+std::vector<double> GradientBoosting::predict_raw(const std::vector<std::vector<double>>& X) const
+{
+    const int n_rows = X.size();
+    std::vector<double> margins((size_t)n_rows * n_outputs);
+    const int n_trees = flat.get_num_trees();
+
+    const int block = 1024;
+    const int n_blocks = (n_rows + block - 1) / block;
+    get_pool().parallel_for(n_blocks, [&](int b) {
+        PERF_SCOPE(Predict);
+        const int end = std::min(n_rows, (b + 1) * block);
+        for (int i = b * block; i < end; i++) {
+            double* m = &margins[(size_t)i * n_outputs];
+            std::copy(base_score.begin(), base_score.end(), m);
+            const double* sample = X[i].data();
+            for (int t = 0; t < n_trees; t++)
+                m[t % n_outputs] += *flat.leaf_output(flat.find_leaf(t, sample));
+        }
+    });
+    return margins;
+}
+
+std::vector<int> GradientBoosting::predict(const std::vector<std::vector<double>>& X) const
+{
+    if (loss == Loss::Squared)
+        throw std::runtime_error("boosting de regressao: use predict_regression");
+
+    const std::vector<double> margins = predict_raw(X);
+    std::vector<int> predictions(X.size());
+    for (size_t i = 0; i < X.size(); i++) {
+        if (loss == Loss::Logistic) {
+            predictions[i] = margins[i] > 0.0 ? 1 : 0;
+        } else {
+            const double* m = &margins[i * n_outputs];
+            predictions[i] = std::max_element(m, m + n_outputs) - m;
+        }
+    }
+    return predictions;
+}
+
+std::vector<double> GradientBoosting::predict_proba(const std::vector<std::vector<double>>& X) const
+{
+    if (loss == Loss::Squared)
+        throw std::runtime_error("boosting de regressao nao tem probabilidades por classe");
+
+    const std::vector<double> margins = predict_raw(X);
+    const int num_classes = get_num_classes();
+    std::vector<double> proba(X.size() * num_classes);
+    for (size_t i = 0; i < X.size(); i++) {
+        double* p = &proba[i * num_classes];
+        if (loss == Loss::Logistic) {
+            p[1] = 1.0 / (1.0 + std::exp(-margins[i]));
+            p[0] = 1.0 - p[1];
+            continue;
+        }
+        const double* m = &margins[i * n_outputs];
+        const double max_m = *std::max_element(m, m + n_outputs);
+        double sum = 0.0;
+        for (int k = 0; k < n_outputs; k++) sum += (p[k] = std::exp(m[k] - max_m));
+        for (int k = 0; k < n_outputs; k++) p[k] /= sum;
+    }
+    return proba;
+}
+
+std::vector<double> GradientBoosting::predict_regression(const std::vector<std::vector<double>>& X) const
+{
+    if (loss != Loss::Squared)
+        throw std::runtime_error("boosting de classificacao: use predict ou predict_proba");
+    return predict_raw(X);
+}
+
+// ============================================================
+// Paralelismo
+// ============================================================
+void GradientBoosting::set_num_threads(int n)
+{
+    n_threads = std::max(1, n);
+    own_pool.reset();
+}
+
+ThreadPool& GradientBoosting::get_pool() const
+{
+    if (shared_pool) return *shared_pool;
+    return own_pool.get(n_threads);
+}
+
+// ============================================================
+// Serialização: cabeçalho do boosting + árvores no formato de
+// DecisionTree::save_model (folhas de regressão, tipo 4)
+// ============================================================
+void GradientBoosting::save_model(const std::string& filename) const
+{
+    std::ofstream out(filename, std::ios::binary);
+    if (!out)
+        throw std::runtime_error("Erro ao abrir arquivo de modelo de boosting para escrita.");
+
+    const int rounds = trees.size() / n_outputs;
+    const int32_t loss_id = (int32_t)loss;
+    out.write(reinterpret_cast<const char*>(&rounds), sizeof(rounds));
+    out.write(reinterpret_cast<const char*>(&max_depth), sizeof(max_depth));
+    out.write(reinterpret_cast<const char*>(&n_outputs), sizeof(n_outputs));
+    out.write(reinterpret_cast<const char*>(&loss_id), sizeof(loss_id));
+    out.write(reinterpret_cast<const char*>(&params.learning_rate), sizeof(double));
+    out.write(reinterpret_cast<const char*>(&params.max_leaves), sizeof(int));
+    out.write(reinterpret_cast<const char*>(base_score.data()), sizeof(double) * n_outputs);
+
+    for (const auto& tree : trees)
+        tree.save_model(out);
+}
+
+void GradientBoosting::load_model(const std::string& filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("Erro ao abrir arquivo de modelo de boosting para leitura.");
+
+    int32_t loss_id = 0;
+    in.read(reinterpret_cast<char*>(&n_rounds), sizeof(n_rounds));
+    in.read(reinterpret_cast<char*>(&max_depth), sizeof(max_depth));
+    in.read(reinterpret_cast<char*>(&n_outputs), sizeof(n_outputs));
+    in.read(reinterpret_cast<char*>(&loss_id), sizeof(loss_id));
+    in.read(reinterpret_cast<char*>(&params.learning_rate), sizeof(double));
+    in.read(reinterpret_cast<char*>(&params.max_leaves), sizeof(int));
+    if (!in || n_rounds < 0 || n_outputs < 1 || loss_id < 0 || loss_id > (int32_t)Loss::Softmax)
+        throw std::runtime_error("Cabecalho de modelo de boosting invalido: " + filename);
+    loss = (Loss)loss_id;
+
+    base_score.resize(n_outputs);
+    in.read(reinterpret_cast<char*>(base_score.data()), sizeof(double) * n_outputs);
+
+    trees.clear();
+    trees.reserve((size_t)n_rounds * n_outputs);
+    for (int t = 0; t < n_rounds * n_outputs; t++) {
+        DecisionTree tree(max_depth, min_samples_split);
+        tree.load_model(in);
+        trees.emplace_back(std::move(tree));
+    }
+    if (!in)
+        throw std::runtime_error("Modelo de boosting truncado: " + filename);
+
+    flat.build(trees);
+}
@@ -0,0 +1,106 @@
+#ifndef GRADIENT_BOOSTING_H
+#define GRADIENT_BOOSTING_H
+
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "DecisionTree.h"
+#include "FlatForest.h"
+#include "ThreadPool.h"
+
+// ------------------------------------------------------------
+// GradientBoosting
+// Árvores de gradient boosting sobre o mesmo DecisionTree das
+// florestas: cada rodada calcula gradiente e hessiana da perda na
+// margem atual e treina uma árvore (uma por classe no softmax) com
+// fit_gradient_columns. As folhas já carregam o shrinkage.
+//
+// Perdas: quadrática (regressão), logística (2 classes) e softmax
+// (multiclasse). A inferência usa a FlatForest (folhas de regressão
+// endereçadas pela tabela), montada ao fim do fit e no load.
+// ------------------------------------------------------------
+class GradientBoosting {
+public:
+    enum class Loss : int32_t { Squared = 0, Logistic = 1, Softmax = 2 };
+
+    GradientBoosting(int n_rounds = 100,
+                     int max_depth = 6,
+                     double learning_rate = 0.1,
+                     int max_leaves = 0);
+
+    // Classificação: logística se houver 2 classes, softmax se mais
+    void fit(const std::vector<std::vector<double>>& X,
+             const std::vector<int>& y);
+    // Regressão com perda quadrática
+    void fit_regression(const std::vector<std::vector<double>>& X,
+                        const std::vector<double>& y);
+
+    // Margens brutas (n_linhas x n_outputs, row-major)
+    std::vector<double> predict_raw(const std::vector<std::vector<double>>& X) const;
+    std::vector<int> predict(const std::vector<std::vector<double>>& X) const;
+    // Probabilidades (n_linhas x num_classes, row-major)
+    std::vector<double> predict_proba(const std::vector<std::vector<double>>& X) const;
+    std::vector<double> predict_regression(const std::vector<std::vector<double>>& X) const;
+
+    // Hiperparâmetros das árvores (ver GradientParams)
+    void set_lambda(double lambda)               { params.lambda = lambda; }
+    void set_min_child_weight(double w)          { params.min_child_weight = w; }
+    void set_min_split_gain(double gain)         { params.min_split_gain = gain; }
+    void set_min_samples_split(int n)            { min_samples_split = n; }
+    // Fração das features sorteadas por nó (1.0 = todas)
+    void set_feature_fraction(double fraction)   { feature_fraction = fraction; }
+    void set_seed(unsigned int s)                { seed = s; }
+    void set_categorical_features(const std::vector<int>& columns) { categorical_columns = columns; }
+
+    // Threads: árvores das classes de uma rodada em paralelo e
+    // atualização das margens / predição por blocos de linhas
+    void set_num_threads(int n);
+    void set_thread_pool(ThreadPool* pool)       { shared_pool = pool; }
+
+    void save_model(const std::string& filename) const;
+    void load_model(const std::string& filename);
+
+    Loss get_loss() const                 { return loss; }
+    int get_num_rounds() const            { return n_rounds; }
+    int get_num_trees() const             { return trees.size(); }
+    int get_num_outputs() const           { return n_outputs; }
+    int get_num_classes() const           { return loss == Loss::Squared ? 0 : std::max(2, n_outputs); }
+    int get_max_depth() const             { return max_depth; }
+    int get_max_leaves() const            { return params.max_leaves; }
+    double get_learning_rate() const      { return params.learning_rate; }
+    const FlatForest& get_flat() const    { return flat; }
+
+private:
+    int n_rounds;
+    int max_depth;
+    int min_samples_split = 2;
+    double feature_fraction = 1.0;
+    unsigned int seed = 42;
+    GradientParams params;
+
+    Loss loss = Loss::Logistic;
+    int n_outputs = 1;                // árvores por rodada (classes no softmax)
+    std::vector<double> base_score;   // margem inicial por saída
+    std::vector<DecisionTree> trees;  // rodada r, saída k -> trees[r * n_outputs + k]
+    FlatForest flat;
+
+    std::vector<int> categorical_columns;
+
+    int n_threads = 1;
+    mutable LazyThreadPool own_pool;
+    ThreadPool* shared_pool = nullptr;
+
+    ThreadPool& get_pool() const;
+    void train(const std::vector<std::vector<double>>& X,
+               const std::vector<int>* labels,
+               const std::vector<double>* targets);
+    void compute_gradients(const std::vector<double>& margins,
+                           const std::vector<int>* labels,
+                           const std::vector<double>* targets,
+                           std::vector<std::vector<double>>& grad,
+                           std::vector<std::vector<double>>& hess) const;
+};
+
+#endif // GRADIENT_BOOSTING_H
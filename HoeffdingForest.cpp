@@ -0,0 +1,406 @@
+#include "HoeffdingForest.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+HoeffdingForest::HoeffdingForest(int n_trees, int max_depth_, int n_classes)
+    : max_depth(max_depth_), num_classes(n_classes)
+{
+    if (n_trees < 1 || n_classes < 1)
+        throw std::invalid_argument("HoeffdingForest: n_trees e n_classes devem ser >= 1");
+    trees.resize(n_trees);
+    set_seed(seed);
+}
+
+void HoeffdingForest::set_seed(unsigned int s)
+{
+    seed = s;
+    for (size_t t = 0; t < trees.size(); t++)
+        trees[t].rng.seed(seed + t);
+}
+
+// ============================================================
+// Folhas
+// ============================================================
+int HoeffdingForest::new_leaf(OnlineTree& tree, int depth, const std::vector<double>& prior)
+{
+    int slot;
+    if (!tree.free_leaves.empty()) {
+        slot = tree.free_leaves.back();
+        tree.free_leaves.pop_back();
+    } else {
+        slot = tree.leaves.size();
+        tree.leaves.emplace_back();
+    }
+
+    // features sorteadas na primeira linha que chegar (n_features pode
+    // ainda não ser conhecido, ex: árvore importada)
+    LeafStats& leaf = tree.leaves[slot];
+    leaf.class_weight.assign(num_classes, 0.0);
+    leaf.prior = prior;
+    leaf.prior.resize(num_classes, 0.0);
+    leaf.features.clear();
+    leaf.stats.clear();
+    leaf.min_value.clear();
+    leaf.max_value.clear();
+    leaf.total = 0.0;
+    leaf.checked_at = 0.0;
+
+    OnlineNode node;
+    node.leaf = slot;
+    node.depth = depth;
+    for (int c = 0; c < num_classes; c++)
+        if (leaf.prior[c] > 0.0 && (node.predicted_class < 0 || leaf.prior[c] > leaf.prior[node.predicted_class]))
+            node.predicted_class = c;
+    tree.nodes.push_back(node);
+    return tree.nodes.size() - 1;
+}
+
+// ============================================================
+// Atualização: uma linha com peso `weight` numa árvore
+// ============================================================
+void HoeffdingForest::learn_one(OnlineTree& tree, const double* sample, int label, double weight)
+{
+    int n = 0;
+    while (tree.nodes[n].feature >= 0) {
+        OnlineNode& node = tree.nodes[n];
+        node.weight += weight;
+        const double x = sample[node.feature];
+        const bool go_left = node.category_mask ? category_in_mask(x, node.category_mask)
+                                                : x <= node.threshold;
+        n = node.child[go_left ? 0 : 1];
+    }
+
+    OnlineNode& node = tree.nodes[n];
+    node.weight += weight;
+    LeafStats& leaf = tree.leaves[node.leaf];
+
+    if (leaf.features.empty()) {
+        // sorteio parcial de Fisher-Yates, como o mtry do lote
+        const int k = std::min(n_features, max_features > 0 ? max_features
+                                           : std::max(1, (int)std::sqrt((double)n_features)));
+        std::vector<int> all(n_features);
+        std::iota(all.begin(), all.end(), 0);
+        for (int j = 0; j < k; j++) {
+            std::uniform_int_distribution<int> pick(j, n_features - 1);
+            std::swap(all[j], all[pick(tree.rng)]);
+        }
+        leaf.features.assign(all.begin(), all.begin() + k);
+        std::sort(leaf.features.begin(), leaf.features.end());
+        leaf.stats.assign((size_t)k * num_classes, GaussianStats());
+        leaf.min_value.assign(k, std::numeric_limits<double>::infinity());
+        leaf.max_value.assign(k, -std::numeric_limits<double>::infinity());
+    }
+
+    leaf.class_weight[label] += weight;
+    leaf.total += weight;
+    for (size_t j = 0; j < leaf.features.size(); j++) {
+        const double x = sample[leaf.features[j]];
+        if (std::isnan(x)) continue;   // NaN vai para a direita em qualquer threshold
+        GaussianStats& g = leaf.stats[j * num_classes + label];
+        g.weight += weight;
+        const double d = x - g.mean;
+        g.mean += d * weight / g.weight;
+        g.m2 += weight * d * (x - g.mean);
+        leaf.min_value[j] = std::min(leaf.min_value[j], x);
+        leaf.max_value[j] = std::max(leaf.max_value[j], x);
+    }
+
+    // classe da folha: maior peso observado + estimado (menor classe no empate)
+    const int pred = node.predicted_class;
+    auto score = [&](int c) { return leaf.class_weight[c] + leaf.prior[c]; };
+    if (pred < 0 || score(label) > score(pred) || (score(label) == score(pred) && label < pred))
+        node.predicted_class = label;
+
+    if (leaf.total - leaf.checked_at >= grace_period && node.depth < max_depth)
+        try_split(tree, n);
+}
+
+// ============================================================
+// Split: ganho de Gini dos candidatos pela aproximação gaussiana e
+// decisão pelo limite de Hoeffding
+// ============================================================
+void HoeffdingForest::try_split(OnlineTree& tree, int node_index)
+{
+    const int slot = tree.nodes[node_index].leaf;
+    LeafStats& leaf = tree.leaves[slot];
+    leaf.checked_at = leaf.total;
+
+    int classes_seen = 0;
+    for (double w : leaf.class_weight) classes_seen += (w > 0.0);
+    if (classes_seen < 2) return;
+
+    const double W = leaf.total;
+    auto gini = [&](const double* w, double total) {
+        double sum_sq = 0.0;
+        for (int c = 0; c < num_classes; c++) sum_sq += (w[c] / total) * (w[c] / total);
+        return 1.0 - sum_sq;
+    };
+    const double parent_gini = gini(leaf.class_weight.data(), W);
+
+    // melhor feature e ganho da segunda melhor (0 = não dividir)
+    double best_gain = 0.0, second_gain = 0.0, best_threshold = 0.0;
+    int best_j = -1;
+    std::vector<double> left(num_classes), right(num_classes);
+    std::vector<double> best_left(num_classes), feature_left(num_classes);
+
+    for (size_t j = 0; j < leaf.features.size(); j++) {
+        const double lo = leaf.min_value[j], hi = leaf.max_value[j];
+        if (!(hi > lo)) continue;
+
+        double feature_gain = 0.0, feature_threshold = 0.0;
+        for (int k = 1; k <= SPLIT_POINTS; k++) {
+            const double t = lo + (hi - lo) * k / (SPLIT_POINTS + 1);
+            double wl = 0.0;
+            for (int c = 0; c < num_classes; c++) {
+                const GaussianStats& g = leaf.stats[j * num_classes + c];
+                double p_left = 0.0;
+                if (g.weight > 0.0) {
+                    const double sd = std::sqrt(g.m2 / g.weight);
+                    p_left = sd > 0.0 ? 0.5 * std::erfc((g.mean - t) / (sd * std::sqrt(2.0)))
+                                      : (g.mean <= t ? 1.0 : 0.0);
+                }
+                left[c] = g.weight * p_left;
+                right[c] = leaf.class_weight[c] - left[c];
+                wl += left[c];
+            }
+            const double wr = W - wl;
+            if (wl <= 0.0 || wr <= 0.0) continue;
+
+            const double gain = parent_gini - (wl / W) * gini(left.data(), wl)
+                                            - (wr / W) * gini(right.data(), wr);
+            if (gain > feature_gain) {
+                feature_gain = gain;
+                feature_threshold = t;
+                feature_left = left;
+            }
+        }
+
+        if (feature_gain > best_gain) {
+            second_gain = best_gain;
+            best_gain = feature_gain;
+            best_threshold = feature_threshold;
+            best_left = feature_left;
+            best_j = j;
+        } else {
+            second_gain = std::max(second_gain, feature_gain);
+        }
+    }
+    if (best_j < 0) return;
+
+    const double epsilon = std::sqrt(std::log(1.0 / delta) / (2.0 * W));
+    if (!(best_gain - second_gain > epsilon || epsilon < tie_threshold)) return;
+
+    std::vector<double> right_prior(num_classes);
+    for (int c = 0; c < num_classes; c++)
+        right_prior[c] = std::max(0.0, leaf.class_weight[c] - best_left[c]);
+    const int feature = leaf.features[best_j];
+    const int depth = tree.nodes[node_index].depth;
+
+    tree.free_leaves.push_back(slot);
+    const int l = new_leaf(tree, depth + 1, best_left);
+    const int r = new_leaf(tree, depth + 1, right_prior);
+
+    OnlineNode& node = tree.nodes[node_index];
+    node.feature = feature;
+    node.threshold = best_threshold;
+    node.child[0] = l;
+    node.child[1] = r;
+    node.leaf = -1;
+}
+
+// ============================================================
+// Fluxo de linhas
+// ============================================================
+void HoeffdingForest::partial_fit(const std::vector<std::vector<double>>& X,
+                                  const std::vector<int>& y)
+{
+    if (X.size() != y.size())
+        throw std::invalid_argument("HoeffdingForest: X e y com tamanhos diferentes");
+    if (X.empty()) return;
+    if (n_features == 0) n_features = X[0].size();
+    for (size_t i = 0; i < X.size(); i++) {
+        if ((int)X[i].size() != n_features)
+            throw std::invalid_argument("HoeffdingForest: linha com numero de features diferente");
+        if (y[i] < 0 || y[i] >= num_classes)
+            throw std::invalid_argument("HoeffdingForest: rotulo fora de [0, n_classes)");
+    }
+
+    get_pool().parallel_for(trees.size(), [&](int t) {
+        OnlineTree& tree = trees[t];
+        if (tree.nodes.empty()) new_leaf(tree, 0, {});
+        std::poisson_distribution<int> poisson(1.0);
+        for (size_t i = 0; i < X.size(); i++) {
+            const int k = poisson(tree.rng);
+            if (k > 0) learn_one(tree, X[i].data(), y[i], k);
+        }
+    });
+    rows_seen += X.size();
+}
+
+int HoeffdingForest::find_leaf(const OnlineTree& tree, const double* sample) const
+{
+    if (tree.nodes.empty()) return -1;
+    int n = 0;
+    while (tree.nodes[n].feature >= 0) {
+        const OnlineNode& node = tree.nodes[n];
+        const double x = sample[node.feature];
+        const bool go_left = node.category_mask ? category_in_mask(x, node.category_mask)
+                                                : x <= node.threshold;
+        n = node.child[go_left ? 0 : 1];
+    }
+    return n;
+}
+
+std::vector<int> HoeffdingForest::predict(const std::vector<std::vector<double>>& X) const
+{
+    const int n_rows = X.size();
+    std::vector<int> predictions(n_rows);
+
+    const int block = 1024;
+    const int n_blocks = (n_rows + block - 1) / block;
+    get_pool().parallel_for(n_blocks, [&](int b) {
+        const int begin = b * block;
+        const int end = std::min(n_rows, (b + 1) * block);
+        std::vector<int> votes(num_classes);
+        for (int i = begin; i < end; i++) {
+            std::fill(votes.begin(), votes.end(), 0);
+            for (const OnlineTree& tree : trees) {
+                const int n = find_leaf(tree, X[i].data());
+                const int pred = n < 0 ? -1 : tree.nodes[n].predicted_class;
+                if (pred >= 0 && pred < num_classes) votes[pred]++;
+            }
+
+            predictions[i] = FlatForest::majority_class(votes.data(), num_classes);
+        }
+    });
+    return predictions;
+}
+
+long long HoeffdingForest::get_num_leaves() const
+{
+    long long count = 0;
+    for (const auto& tree : trees)
+        for (const auto& node : tree.nodes) count += (node.feature < 0);
+    return count;
+}
+
+long long HoeffdingForest::get_num_splits() const
+{
+    long long count = 0;
+    for (const auto& tree : trees)
+        for (const auto& node : tree.nodes) count += (node.feature >= 0);
+    return count;
+}
+
+// ============================================================
+// Troca de formato: nós do DecisionTree (mesmo arquivo do lote)
+// ============================================================
+std::unique_ptr<Node> HoeffdingForest::export_node(const OnlineTree& tree, int node_index) const
+{
+    auto node = std::make_unique<Node>();
+    if (node_index < 0) {   // árvore que ainda não viu linhas
+        node->is_leaf = true;
+        return node;
+    }
+    const OnlineNode& online = tree.nodes[node_index];
+    node->predicted_class = online.predicted_class;
+    if (online.feature < 0) {
+        node->is_leaf = true;
+        return node;
+    }
+    node->feature_index = online.feature;
+    node->threshold = online.threshold;
+    node->category_mask = online.category_mask;
+    node->n_samples = (int)std::min<double>(online.weight, INT_MAX);
+    node->left = export_node(tree, online.child[0]);
+    node->right = export_node(tree, online.child[1]);
+    return node;
+}
+
+void HoeffdingForest::export_forest(RandomForestOptimized& forest) const
+{
+    std::vector<DecisionTree> exported;
+    exported.reserve(trees.size());
+    for (const auto& tree : trees) {
+        DecisionTree decision_tree(max_depth, 2);
+        decision_tree.set_root(export_node(tree, tree.nodes.empty() ? -1 : 0), num_classes);
+        exported.emplace_back(std::move(decision_tree));
+    }
+    forest.set_trees(std::move(exported));
+}
+
+int HoeffdingForest::import_node(OnlineTree& tree, const Node* node, int depth)
+{
+    if (!node || node->is_leaf) {
+        // folha do lote: a classe dela vale até chegarem linhas novas
+        std::vector<double> prior(num_classes, 0.0);
+        if (node && node->predicted_class >= 0 && node->predicted_class < num_classes)
+            prior[node->predicted_class] = 1.0;
+        return new_leaf(tree, depth, prior);
+    }
+
+    const int index = tree.nodes.size();
+    OnlineNode split;
+    split.feature = node->feature_index;
+    split.threshold = node->threshold;
+    split.category_mask = node->category_mask;
+    split.predicted_class = node->predicted_class;
+    split.depth = depth;
+    split.weight = node->n_samples;
+    tree.nodes.push_back(split);
+
+    const int l = import_node(tree, node->left.get(), depth + 1);
+    const int r = import_node(tree, node->right.get(), depth + 1);
+    tree.nodes[index].child[0] = l;
+    tree.nodes[index].child[1] = r;
+    return index;
+}
+
+void HoeffdingForest::import_forest(const RandomForestOptimized& forest)
+{
+    if (forest.is_inference_only())
+        throw std::invalid_argument("HoeffdingForest: modelo compacto nao tem as arvores");
+    if (forest.is_regression())
+        throw std::invalid_argument("HoeffdingForest: so classificacao");
+
+    num_classes = forest.get_num_classes();
+    rows_seen = 0;
+    trees.clear();
+    trees.resize(forest.get_num_trees());
+    set_seed(seed);
+    for (int t = 0; t < forest.get_num_trees(); t++)
+        import_node(trees[t], forest.get_tree(t).get_root(), 0);
+}
+
+void HoeffdingForest::save_model(const std::string& filename) const
+{
+    RandomForestOptimized forest(trees.size(), max_depth, 2);
+    export_forest(forest);
+    forest.save_model(filename);
+}
+
+void HoeffdingForest::load_model(const std::string& filename)
+{
+    RandomForestOptimized forest(1, 1, 1, 1); // parametros vem do modelo
+    forest.load_model(filename);
+    import_forest(forest);
+}
+
+// ============================================================
+// Paralelismo
+// ============================================================
+void HoeffdingForest::set_num_threads(int n)
+{
+    n_threads = std::max(1, n);
+    own_pool.reset();
+}
+
+ThreadPool& HoeffdingForest::get_pool() const
+{
+    return own_pool.get(n_threads);
+}
@@ -0,0 +1,126 @@
+#ifndef HOEFFDING_FOREST_H
+#define HOEFFDING_FOREST_H
+
+#include "RandomForestOptimized.h"
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------
+// HoeffdingForest
+// Floresta de classificação aprendida em fluxo (linhas rotuladas
+// chegando aos poucos), sem refazer o fit em lote:
+//
+//  - bagging online: cada linha entra em cada árvore com peso
+//    k ~ Poisson(1), sorteado pela semente da árvore;
+//  - cada folha guarda o peso por classe e, para as features sorteadas
+//    na sua criação (sqrt(total), como no lote), média e variância por
+//    classe (Welford ponderado);
+//  - a cada grace_period de peso a folha avalia candidatos de threshold
+//    pela aproximação gaussiana de P(x <= t | classe) e divide quando o
+//    ganho de Gini da melhor feature supera o da segunda pelo limite de
+//    Hoeffding sqrt(ln(1/δ) / 2n), ou quando o limite fica abaixo de
+//    tie_threshold (empate).
+//
+// O NaN vai para a direita, como nas árvores em lote. O modelo exportado
+// (export_forest/save_model) usa os nós e o formato de arquivo do
+// RandomForestOptimized, e um modelo em lote pode ser importado para
+// continuar aprendendo em fluxo. Splits categóricos importados são
+// mantidos, mas os novos splits são sempre numéricos.
+// ------------------------------------------------------------
+class HoeffdingForest {
+public:
+    HoeffdingForest(int n_trees = 10, int max_depth = 10, int n_classes = 2);
+
+    // Parâmetros dos próximos splits
+    void set_grace_period(double weight)   { grace_period = weight; }
+    void set_split_confidence(double d)    { delta = d; }
+    void set_tie_threshold(double tau)     { tie_threshold = tau; }
+    // Features sorteadas por folha (0 = sqrt(total))
+    void set_max_features(int n)           { max_features = n; }
+    void set_seed(unsigned int s);
+    void set_num_threads(int n);
+
+    // Atualiza as árvores com as linhas em ordem (árvores em paralelo;
+    // cada uma usa a sua semente, então o resultado não depende das
+    // threads). Rótulos fora de [0, n_classes) lançam invalid_argument.
+    void partial_fit(const std::vector<std::vector<double>>& X, const std::vector<int>& y);
+
+    std::vector<int> predict(const std::vector<std::vector<double>>& X) const;
+
+    // Troca de formato com a floresta em lote
+    void export_forest(RandomForestOptimized& forest) const;
+    void import_forest(const RandomForestOptimized& forest);
+    void save_model(const std::string& filename) const;
+    void load_model(const std::string& filename);
+
+    int get_num_trees() const       { return trees.size(); }
+    int get_num_classes() const     { return num_classes; }
+    long long get_rows_seen() const { return rows_seen; }
+    long long get_num_leaves() const;
+    long long get_num_splits() const;
+
+private:
+    // Candidatos de threshold por feature entre o mínimo e o máximo da folha
+    static constexpr int SPLIT_POINTS = 10;
+
+    struct OnlineNode {
+        int feature = -1;           // -1 = folha
+        double threshold = 0.0;
+        uint64_t category_mask = 0; // split categórico importado
+        int child[2] = {-1, -1};
+        int leaf = -1;              // estatísticas da folha
+        int predicted_class = -1;
+        int depth = 0;
+        double weight = 0.0;        // peso que passou pelo nó
+    };
+
+    struct GaussianStats {
+        double weight = 0.0, mean = 0.0, m2 = 0.0;
+    };
+
+    struct LeafStats {
+        std::vector<double> class_weight;   // observado na folha
+        std::vector<double> prior;          // estimado no split do pai
+        std::vector<int> features;          // sorteadas na criação
+        std::vector<GaussianStats> stats;   // features x classes
+        std::vector<double> min_value, max_value;
+        double total = 0.0;
+        double checked_at = 0.0;            // total na última tentativa de split
+    };
+
+    struct OnlineTree {
+        std::vector<OnlineNode> nodes;
+        std::vector<LeafStats> leaves;
+        std::vector<int> free_leaves;
+        std::mt19937 rng;
+    };
+
+    int max_depth;
+    int num_classes;
+    int n_features = 0;
+    double grace_period = 200.0;
+    double delta = 1e-7;
+    double tie_threshold = 0.05;
+    int max_features = 0;
+    unsigned int seed = 42;
+    long long rows_seen = 0;
+    std::vector<OnlineTree> trees;
+
+    int n_threads = 1;
+    mutable LazyThreadPool own_pool;
+    ThreadPool& get_pool() const;
+
+    int new_leaf(OnlineTree& tree, int depth, const std::vector<double>& prior);
+    void learn_one(OnlineTree& tree, const double* sample, int label, double weight);
+    void try_split(OnlineTree& tree, int node_index);
+    int find_leaf(const OnlineTree& tree, const double* sample) const;
+    int import_node(OnlineTree& tree, const Node* node, int depth);
+    std::unique_ptr<Node> export_node(const OnlineTree& tree, int node_index) const;
+};
+
+#endif // HOEFFDING_FOREST_H
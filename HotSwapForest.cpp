@@ -0,0 +1,161 @@
+#include "HotSwapForest.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+// ============================================================
+// Snapshot
+// ============================================================
+ForestSnapshot::ForestSnapshot(std::unique_ptr<RandomForestOptimized> model, uint64_t v)
+    : forest(std::move(model)), version(v)
+{
+    forest->set_early_exit(false);
+    forest->set_thread_pool(&pool);
+}
+
+// ============================================================
+// Leitura: anuncia a época num slot livre e só então lê o ponteiro.
+// Todas as operações são seq_cst: um escritor que viu o slot livre já
+// tinha trocado o ponteiro, então o snapshot lido aqui não está entre
+// os que ele libera.
+// ============================================================
+HotSwapForest::ReaderSlot* HotSwapForest::claim_slot() const
+{
+    // Slot inicial por thread: sem disputa enquanto houver slots livres
+    static std::atomic<unsigned> next_reader{0};
+    thread_local const unsigned hint = next_reader.fetch_add(1, std::memory_order_relaxed);
+
+    for (unsigned k = 0;; k++) {
+        ReaderSlot& slot = slots[(hint + k) % MAX_READERS];
+        uint64_t expected = 0;
+        if (slot.epoch.load(std::memory_order_relaxed) == 0 &&
+            slot.epoch.compare_exchange_strong(expected, global_epoch.load()))
+            return &slot;
+        if (k > 0 && k % MAX_READERS == 0)
+            std::this_thread::yield();   // todos ocupados
+    }
+}
+
+HotSwapForest::ReadGuard::ReadGuard(const HotSwapForest& owner)
+    : slot(owner.claim_slot()), current(owner.current.load())
+{
+}
+
+const ForestSnapshot& HotSwapForest::ReadGuard::snapshot() const
+{
+    if (!current) throw std::runtime_error("HotSwapForest: nenhum modelo publicado");
+    return *current;
+}
+
+std::vector<int> HotSwapForest::predict(const std::vector<std::vector<double>>& X,
+                                        uint64_t* version) const
+{
+    ReadGuard guard(*this);
+    const ForestSnapshot& snapshot = guard.snapshot();
+    if (version) *version = snapshot.get_version();
+    return snapshot.get_forest().predict(X);
+}
+
+std::vector<double> HotSwapForest::predict_proba(const std::vector<std::vector<double>>& X,
+                                                 uint64_t* version) const
+{
+    ReadGuard guard(*this);
+    const ForestSnapshot& snapshot = guard.snapshot();
+    if (version) *version = snapshot.get_version();
+    return snapshot.get_forest().predict_proba(X);
+}
+
+std::vector<double> HotSwapForest::predict_regression(const std::vector<std::vector<double>>& X,
+                                                      uint64_t* version) const
+{
+    ReadGuard guard(*this);
+    const ForestSnapshot& snapshot = guard.snapshot();
+    if (version) *version = snapshot.get_version();
+    return snapshot.get_forest().predict_regression(X);
+}
+
+std::shared_ptr<const ForestSnapshot> HotSwapForest::acquire() const
+{
+    // Dentro da leitura o snapshot não pode ser liberado, então a
+    // referência contada pode ser tomada dele mesmo
+    ReadGuard guard(*this);
+    const ForestSnapshot* snapshot = current.load();
+    return snapshot ? snapshot->shared_from_this() : nullptr;
+}
+
+uint64_t HotSwapForest::get_version() const
+{
+    ReadGuard guard(*this);
+    const ForestSnapshot* snapshot = current.load();
+    return snapshot ? snapshot->get_version() : 0;
+}
+
+// ============================================================
+// Escrita
+// ============================================================
+uint64_t HotSwapForest::publish(std::unique_ptr<RandomForestOptimized> forest)
+{
+    if (!forest)
+        throw std::invalid_argument("HotSwapForest: modelo nulo");
+    forest->compact();   // trabalho pesado fora do lock
+
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    auto snapshot = std::make_shared<ForestSnapshot>(std::move(forest), next_version++);
+    const uint64_t version = snapshot->get_version();
+
+    // Troca e só depois avança a época: quem anunciar a época nova já
+    // lê o ponteiro novo
+    current.exchange(snapshot.get());
+    const uint64_t retire_epoch = global_epoch.fetch_add(1);
+    if (current_owner)
+        retired.emplace_back(retire_epoch, std::move(current_owner));
+    current_owner = std::move(snapshot);
+
+    reclaim_locked();
+    return version;
+}
+
+uint64_t HotSwapForest::load(const std::string& path)
+{
+    auto forest = std::make_unique<RandomForestOptimized>(1, 1, 1, 1); // parametros vem do modelo
+    forest->load_model(path);
+    return publish(std::move(forest));
+}
+
+size_t HotSwapForest::reclaim()
+{
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    return reclaim_locked();
+}
+
+size_t HotSwapForest::reclaim_locked()
+{
+    // Menor época anunciada por um leitor ativo
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for (const ReaderSlot& slot : slots) {
+        const uint64_t epoch = slot.epoch.load();
+        if (epoch != 0) oldest = std::min(oldest, epoch);
+    }
+
+    // Aposentado na época r: só leitores com época <= r podem tê-lo lido
+    auto keep_end = std::partition(retired.begin(), retired.end(),
+                                   [&](const auto& entry) { return entry.first >= oldest; });
+    const size_t freed = retired.end() - keep_end;
+    retired.erase(keep_end, retired.end());
+    reclaimed += freed;
+    return freed;
+}
+
+size_t HotSwapForest::get_num_retired() const
+{
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    return retired.size();
+}
+
+uint64_t HotSwapForest::get_num_reclaimed() const
+{
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    return reclaimed;
+}
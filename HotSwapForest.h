@@ -0,0 +1,125 @@
+#ifndef HOT_SWAP_FOREST_H
+#define HOT_SWAP_FOREST_H
+
+#include "RandomForestOptimized.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ------------------------------------------------------------
+// ForestSnapshot
+// Versão imutável de um modelo publicado. A floresta é compactada e
+// prediz num pool próprio de 1 thread (sem workers, roda na thread que
+// chama), então várias threads podem predizer no mesmo snapshot. Early
+// exit fica desligado: com ele ligado o predict grava a média de árvores
+// avaliadas no objeto; sem ele, o predict só lê o modelo.
+// ------------------------------------------------------------
+class ForestSnapshot : public std::enable_shared_from_this<ForestSnapshot> {
+public:
+    ForestSnapshot(std::unique_ptr<RandomForestOptimized> forest, uint64_t version);
+
+    const RandomForestOptimized& get_forest() const { return *forest; }
+    uint64_t get_version() const                    { return version; }
+
+private:
+    ThreadPool pool{1};   // declarado antes: a floresta aponta para ele
+    std::unique_ptr<RandomForestOptimized> forest;
+    uint64_t version;
+};
+
+// ------------------------------------------------------------
+// HotSwapForest
+// Troca do modelo em uso sem pausar a predição (retreino contínuo).
+// O snapshot atual fica num ponteiro atômico: publish troca o ponteiro
+// e as chamadas novas já usam o modelo novo, enquanto as que estavam em
+// andamento terminam no antigo.
+//
+// Recuperação por épocas: cada leitor anuncia a época global num slot
+// (CAS, sem lock) antes de ler o ponteiro e limpa o slot ao terminar. O
+// snapshot trocado é aposentado com a época da troca e só é liberado
+// quando nenhum leitor ativo anunciou uma época anterior ou igual. A
+// liberação acontece no publish/reclaim (thread do escritor), nunca no
+// caminho da predição. Escritores são serializados por um mutex.
+//
+// acquire() devolve uma referência contada ao snapshot atual, para
+// segurar o mesmo modelo em várias chamadas; ele só é liberado quando a
+// última referência cai (nesse caso, na thread que a solta).
+// ------------------------------------------------------------
+class HotSwapForest {
+public:
+    // Leitores simultâneos atendidos sem espera; além disso, quem entra
+    // gira até um slot vagar
+    static constexpr int MAX_READERS = 128;
+
+    HotSwapForest() = default;
+    HotSwapForest(const HotSwapForest&) = delete;
+    HotSwapForest& operator=(const HotSwapForest&) = delete;
+
+    // Publica o modelo (compactado antes de entrar no lock) e retorna a
+    // versão, crescente a partir de 1
+    uint64_t publish(std::unique_ptr<RandomForestOptimized> forest);
+    // Carrega o arquivo (formato padrão ou compacto) e publica
+    uint64_t load(const std::string& path);
+
+    // Predição no snapshot atual; version, se dado, recebe a versão usada.
+    // Lançam std::runtime_error se nenhum modelo foi publicado.
+    std::vector<int> predict(const std::vector<std::vector<double>>& X,
+                             uint64_t* version = nullptr) const;
+    std::vector<double> predict_proba(const std::vector<std::vector<double>>& X,
+                                      uint64_t* version = nullptr) const;
+    std::vector<double> predict_regression(const std::vector<std::vector<double>>& X,
+                                           uint64_t* version = nullptr) const;
+
+    // Snapshot atual (nullptr se nenhum modelo foi publicado)
+    std::shared_ptr<const ForestSnapshot> acquire() const;
+
+    uint64_t get_version() const;
+    // Libera os snapshots aposentados que nenhum leitor pode mais ver;
+    // retorna quantos foram liberados
+    size_t reclaim();
+    size_t get_num_retired() const;
+    uint64_t get_num_reclaimed() const;
+
+private:
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch{0};   // 0 = livre
+    };
+
+    // Slot anunciado durante uma leitura
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const HotSwapForest& owner);
+        ~ReadGuard() { slot->epoch.store(0, std::memory_order_release); }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        const ForestSnapshot& snapshot() const;
+
+    private:
+        ReaderSlot* slot;
+        const ForestSnapshot* current;
+    };
+
+    ReaderSlot* claim_slot() const;
+
+    std::atomic<const ForestSnapshot*> current{nullptr};
+    std::atomic<uint64_t> global_epoch{1};
+    mutable ReaderSlot slots[MAX_READERS];
+
+    // Estado do escritor (protegido por writer_mutex)
+    mutable std::mutex writer_mutex;
+    std::shared_ptr<const ForestSnapshot> current_owner;
+    std::vector<std::pair<uint64_t, std::shared_ptr<const ForestSnapshot>>> retired;
+    uint64_t next_version = 1;
+    uint64_t reclaimed = 0;
+
+    size_t reclaim_locked();
+};
+
+#endif // HOT_SWAP_FOREST_H
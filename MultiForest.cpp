@@ -0,0 +1,111 @@
+#include "MultiForest.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+// ============================================================
+// Modelos
+// ============================================================
+void MultiForest::add_model(const std::string& name, const std::string& path)
+{
+    auto forest = std::make_unique<RandomForestOptimized>(1, 1, 1, 1); // parametros vem do modelo
+    forest->load_model(path);
+    if (forest->is_regression())
+        throw std::runtime_error("Modelo de regressao nao suportado na predicao multipla: " + path);
+    forest->compact();
+
+    max_classes = std::max(max_classes, forest->get_num_classes());
+    names.push_back(name);
+    models.push_back(std::move(forest));
+    rebuild_quantized();
+}
+
+void MultiForest::set_shared_quantization(bool enabled)
+{
+    shared_quantization = enabled;
+    rebuild_quantized();
+}
+
+void MultiForest::rebuild_quantized()
+{
+    quantized.clear();
+    quantization_error.clear();
+    if (!shared_quantization || models.empty()) return;
+
+    std::vector<const FlatForest*> sources;
+    for (const auto& model : models)
+        sources.push_back(&model->get_flat());
+
+    try {
+        quantized.resize(models.size());
+        for (size_t m = 0; m < models.size(); m++)
+            quantized[m].build(models[m]->get_flat(), models[m]->get_num_classes(), sources);
+    } catch (const std::runtime_error& e) {
+        // dicionário comum grande demais (ou feature numérica num modelo
+        // e categórica noutro): cada modelo pela sua forma achatada
+        quantized.clear();
+        quantization_error = e.what();
+    }
+}
+
+// ============================================================
+// Predição: blocos de linhas em paralelo; no bloco, as linhas são
+// quantizadas uma vez e percorridas por todos os modelos
+// ============================================================
+std::vector<std::vector<int>> MultiForest::predict(const std::vector<std::vector<double>>& X) const
+{
+    const int n_rows = X.size();
+    const int n_models = models.size();
+    std::vector<std::vector<int>> predictions(n_models, std::vector<int>(n_rows));
+    if (n_models == 0) return predictions;
+
+    const bool shared = !quantized.empty();
+    const int n_codes = shared ? quantized[0].get_num_used_features() : 0;
+
+    const int block = 256;
+    const int n_blocks = (n_rows + block - 1) / block;
+    get_pool().parallel_for(n_blocks, [&](int b) {
+        const int begin = b * block;
+        const int end = std::min(n_rows, (b + 1) * block);
+
+        std::vector<uint16_t> codes((size_t)(end - begin) * n_codes);
+        if (shared)
+            for (int i = begin; i < end; i++)
+                quantized[0].quantize_row(X[i].data(), &codes[(size_t)(i - begin) * n_codes]);
+
+        // Linha por linha (a linha e seus códigos ficam no cache), como
+        // na predição da forma achatada da floresta
+        std::vector<int> votes(max_classes);
+        for (int m = 0; m < n_models; m++) {
+            const FlatForest& flat = models[m]->get_flat();
+            const int n_trees = flat.get_num_trees();
+            const int n_classes = models[m]->get_num_classes();
+            for (int i = begin; i < end; i++) {
+                std::fill(votes.begin(), votes.end(), 0);
+                const uint16_t* row_codes = shared ? &codes[(size_t)(i - begin) * n_codes] : nullptr;
+                for (int t = 0; t < n_trees; t++) {
+                    const int pred = shared ? quantized[m].predict_tree(t, row_codes)
+                                            : flat.predict_tree(t, X[i].data());
+                    if (pred >= 0 && pred < n_classes) votes[pred]++;
+                }
+
+                predictions[m][i] = FlatForest::majority_class(votes.data(), n_classes);
+            }
+        }
+    });
+    return predictions;
+}
+
+// ============================================================
+// Paralelismo
+// ============================================================
+void MultiForest::set_num_threads(int n)
+{
+    n_threads = std::max(1, n);
+    own_pool.reset();
+}
+
+ThreadPool& MultiForest::get_pool() const
+{
+    return own_pool.get(n_threads);
+}
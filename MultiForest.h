@@ -0,0 +1,64 @@
+#ifndef MULTI_FOREST_H
+#define MULTI_FOREST_H
+
+#include "RandomForestOptimized.h"
+#include "QuantizedForest.h"
+#include "ThreadPool.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------
+// MultiForest
+// Várias florestas de classificação (modelos A/B, um por segmento)
+// pontuando as mesmas linhas numa única passada: cada bloco de linhas
+// passa por todos os modelos enquanto está quente no cache, e sai uma
+// coluna de predições por modelo.
+//
+// Com quantização compartilhada (padrão), todas as florestas usam o
+// mesmo dicionário de thresholds (a união dos thresholds de todas) e
+// cada linha é quantizada uma única vez para todos os modelos. Se o
+// dicionário comum não couber na codificação (ver QuantizedForest), os
+// modelos predizem pela forma achatada de cada um.
+// ------------------------------------------------------------
+class MultiForest {
+public:
+    MultiForest() = default;
+
+    // Carrega o modelo (formato padrão ou compacto) e o compacta.
+    // Lança std::runtime_error para florestas de regressão.
+    void add_model(const std::string& name, const std::string& path);
+
+    void set_shared_quantization(bool enabled);
+    void set_num_threads(int n);
+
+    // predictions[m][i] = classe do modelo m para a linha i
+    std::vector<std::vector<int>> predict(const std::vector<std::vector<double>>& X) const;
+
+    int get_num_models() const                          { return models.size(); }
+    const std::string& get_name(int m) const            { return names[m]; }
+    const RandomForestOptimized& get_model(int m) const { return *models[m]; }
+    // Quantização compartilhada ativa (pedida e possível)
+    bool uses_shared_quantization() const               { return !quantized.empty(); }
+    // Motivo da forma achatada quando a quantização foi pedida
+    const std::string& get_quantization_error() const   { return quantization_error; }
+
+private:
+    std::vector<std::string> names;
+    std::vector<std::unique_ptr<RandomForestOptimized>> models;
+    std::vector<QuantizedForest> quantized;   // mesmo dicionário em todos
+
+    bool shared_quantization = true;
+    std::string quantization_error;
+    int max_classes = 0;
+
+    int n_threads = 1;
+    mutable LazyThreadPool own_pool;
+
+    ThreadPool& get_pool() const;
+    // Refaz os modelos quantizados com o dicionário de todos os modelos
+    void rebuild_quantized();
+};
+
+#endif // MULTI_FOREST_H
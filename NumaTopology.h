@@ -0,0 +1,243 @@
+#ifndef NUMA_TOPOLOGY_H
+#define NUMA_TOPOLOGY_H
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+
+// ------------------------------------------------------------
+// NumaTopology
+// Nós NUMA e CPUs de cada um, lidos de /sys/devices/system/node (sem
+// libnuma). Só entram as CPUs permitidas ao processo. Se o sysfs não
+// existir ou só houver um nó, vira um único nó com todas as CPUs e o
+// modo NUMA da floresta não faz nada.
+//
+// A memória vai para o nó da thread que a toca primeiro (first touch,
+// política padrão do Linux), então uma réplica copiada por uma thread
+// fixada num nó fica nesse nó.
+// ------------------------------------------------------------
+class NumaTopology {
+public:
+    struct Node {
+        int id = 0;                 // número do nó no sistema (nodeN)
+        std::vector<int> cpus;
+    };
+
+    // Vazia (num_nodes() == 0) até detect()/uniform()
+    NumaTopology() = default;
+
+    static NumaTopology detect() {
+        NumaTopology topology;
+        const std::vector<int> allowed = allowed_cpus();
+
+        DIR* dir = opendir("/sys/devices/system/node");
+        if (dir) {
+            while (dirent* entry = readdir(dir)) {
+                const std::string name = entry->d_name;
+                if (name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+                    name.find_first_not_of("0123456789", 4) != std::string::npos)
+                    continue;
+                Node node;
+                node.id = std::stoi(name.substr(4));
+                std::ifstream list("/sys/devices/system/node/" + name + "/cpulist");
+                std::string text;
+                std::getline(list, text);
+                for (int cpu : parse_cpu_list(text))
+                    if (contains(allowed, cpu)) node.cpus.push_back(cpu);
+                if (!node.cpus.empty()) topology.nodes.push_back(node);
+            }
+            closedir(dir);
+        }
+
+        if (topology.nodes.empty()) {
+            Node node;
+            node.cpus = allowed;
+            topology.nodes.push_back(node);
+        }
+        std::sort(topology.nodes.begin(), topology.nodes.end(),
+                  [](const Node& a, const Node& b) { return a.id < b.id; });
+        topology.build_cpu_map();
+        return topology;
+    }
+
+    // Topologia simulada: n_nodes nós com as mesmas CPUs (exercita a
+    // replicação numa máquina de um nó; não separa memória de verdade)
+    static NumaTopology uniform(int n_nodes) {
+        NumaTopology topology;
+        const std::vector<int> allowed = allowed_cpus();
+        for (int k = 0; k < std::max(1, n_nodes); k++) {
+            Node node;
+            node.id = k;
+            node.cpus = allowed;
+            topology.nodes.push_back(node);
+        }
+        topology.build_cpu_map();
+        return topology;
+    }
+
+    int num_nodes() const                       { return nodes.size(); }
+    bool is_numa() const                        { return nodes.size() > 1; }
+    const std::vector<Node>& get_nodes() const  { return nodes; }
+
+    // Nó (índice em get_nodes()) da thread i de um pool com n_threads:
+    // blocos contíguos, para threads vizinhas dividirem o mesmo nó
+    int node_for_thread(int thread, int n_threads) const {
+        if (nodes.size() <= 1 || n_threads <= 0) return 0;
+        return (int)((long long)thread * nodes.size() / n_threads);
+    }
+
+    // Nó da CPU em que a thread atual está rodando agora
+    int current_node() const {
+        if (nodes.size() <= 1) return 0;
+        const int cpu = sched_getcpu();
+        if (cpu < 0 || cpu >= (int)cpu_to_node.size()) return 0;
+        return cpu_to_node[cpu];
+    }
+
+    // Fixa a thread atual nas CPUs do nó
+    bool pin_current_thread(int node) const {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : nodes[node].cpus)
+            if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+
+    // fn(node) em uma thread fixada em cada nó, todas em paralelo
+    // (cada uma aloca e toca a sua réplica)
+    void run_on_each_node(const std::function<void(int)>& fn) const {
+        std::vector<std::thread> threads;
+        for (int k = 0; k < num_nodes(); k++)
+            threads.emplace_back([this, k, &fn] {
+                pin_current_thread(k);
+                fn(k);
+            });
+        for (auto& t : threads) t.join();
+    }
+
+    // Banda de leitura por nó: cada nó toca o seu buffer de bytes_per_node
+    // e uma thread fixada nele lê o buffer local e o do nó seguinte
+    // (remoto; 0 numa máquina de um nó). Os nós são medidos um por vez.
+    struct Bandwidth {
+        double local_gbps = 0.0;
+        double remote_gbps = 0.0;
+    };
+    std::vector<Bandwidth> measure_bandwidth(size_t bytes_per_node = 64u << 20) const {
+        const size_t n = bytes_per_node / sizeof(double);
+        std::vector<std::vector<double>> buffers(num_nodes());
+        run_on_each_node([&](int k) { buffers[k].assign(n, 1.0 + k); });
+
+        std::vector<Bandwidth> result(num_nodes());
+        for (int k = 0; k < num_nodes(); k++) {
+            std::thread([&, k] {
+                pin_current_thread(k);
+                result[k].local_gbps = read_bandwidth(buffers[k].data(), n);
+                if (is_numa()) {
+                    const int remote = (k + 1) % num_nodes();
+                    result[k].remote_gbps = read_bandwidth(buffers[remote].data(), n);
+                }
+            }).join();
+        }
+        return result;
+    }
+
+    // Tabela por nó: CPUs e banda local/remota (measure_bandwidth), mais
+    // o total das cópias mantidas por nó
+    void print_summary(std::ostream& out, size_t replica_bytes) const {
+        const std::vector<Bandwidth> bandwidth = measure_bandwidth();
+        out << "\n================= NUMA ==================================\n";
+        out << std::right << std::setw(6) << "No" << std::setw(8) << "CPUs"
+            << std::setw(16) << "Local (GB/s)" << std::setw(16) << "Remota (GB/s)" << "\n";
+        out << std::fixed << std::setprecision(2);
+        for (int k = 0; k < num_nodes(); k++) {
+            out << std::setw(6) << nodes[k].id << std::setw(8) << nodes[k].cpus.size()
+                << std::setw(16) << bandwidth[k].local_gbps;
+            if (is_numa()) out << std::setw(16) << bandwidth[k].remote_gbps << "\n";
+            else           out << std::setw(16) << "-" << "\n";
+        }
+        if (is_numa())
+            out << "Copias por no: " << replica_bytes / (1024.0 * 1024.0) << " MB no total\n";
+        else
+            out << "Um no so: modo NUMA sem efeito (sem fixar threads nem copiar dados)\n";
+    }
+
+    // Leitura sequencial de n doubles (soma), em GB/s, na thread atual
+    static double read_bandwidth(const double* data, size_t n, int repeats = 3) {
+        if (n == 0) return 0.0;
+        double best = 0.0;
+        volatile double sink = 0.0;
+        for (int r = 0; r < repeats; r++) {
+            const auto start = std::chrono::steady_clock::now();
+            double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                s0 += data[i]; s1 += data[i + 1]; s2 += data[i + 2]; s3 += data[i + 3];
+            }
+            for (; i < n; i++) s0 += data[i];
+            sink = sink + s0 + s1 + s2 + s3;
+            const double seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+            if (seconds > 0.0) best = std::max(best, n * sizeof(double) / seconds / 1e9);
+        }
+        return best;
+    }
+
+private:
+    std::vector<Node> nodes;
+    std::vector<int> cpu_to_node;   // índice em nodes por CPU
+
+    static bool contains(const std::vector<int>& values, int v) {
+        return std::find(values.begin(), values.end(), v) != values.end();
+    }
+
+    static std::vector<int> allowed_cpus() {
+        std::vector<int> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+                if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+        if (cpus.empty()) cpus.push_back(0);
+        return cpus;
+    }
+
+    // "0-3,8-11" -> {0, 1, 2, 3, 8, 9, 10, 11}
+    static std::vector<int> parse_cpu_list(const std::string& text) {
+        std::vector<int> cpus;
+        std::stringstream ss(text);
+        std::string range;
+        while (std::getline(ss, range, ',')) {
+            if (range.empty() || range.find_first_not_of("0123456789-\n ") != std::string::npos)
+                continue;
+            const size_t dash = range.find('-');
+            const int first = std::stoi(range.substr(0, dash));
+            const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    void build_cpu_map() {
+        // na topologia simulada a CPU fica no primeiro nó que a lista
+        cpu_to_node.clear();
+        for (int k = num_nodes() - 1; k >= 0; k--)
+            for (int cpu : nodes[k].cpus) {
+                if (cpu >= (int)cpu_to_node.size()) cpu_to_node.resize(cpu + 1, 0);
+                cpu_to_node[cpu] = k;
+            }
+    }
+};
+
+#endif // NUMA_TOPOLOGY_H
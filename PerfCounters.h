@@ -0,0 +1,291 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+// ------------------------------------------------------------
+// PerfCounters
+// Contadores de hardware por fase (perf_event_open, Linux): ciclos,
+// instruções, misses de L1d/LLC e branch misses, separados em carga do
+// CSV, transposição, find_best_split, partição, predição e votação.
+//
+// Só existe com -DFOREST_PERF (make PERF=1). Sem a flag, PERF_SCOPE e
+// PERF_REPORT viram no-ops e nada deste arquivo entra no binário.
+//
+// Escopos aninhados são exclusivos: enquanto um escopo filho está
+// aberto, o pai não acumula (ex: a partição dentro do find_best_split
+// conta só como "partition").
+// ------------------------------------------------------------
+
+#ifdef FOREST_PERF
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+enum class PerfPhase { CsvLoad, Transpose, FindBestSplit, Partition, Predict, Vote, Count };
+
+namespace perf {
+
+enum Event { Cycles, Instructions, L1dMisses, LlcMisses, BranchMisses, NumEvents };
+
+inline const char* phase_name(PerfPhase phase) {
+    static const char* names[] = {"csv_load", "transpose", "find_best_split",
+                                  "partition", "predict", "vote"};
+    return names[(int)phase];
+}
+
+inline const char* event_name(int e) {
+    static const char* names[] = {"cycles", "instructions", "l1d_misses",
+                                  "llc_misses", "branch_misses"};
+    return names[e];
+}
+
+// ============================================================
+// Grupo de contadores da thread atual (aberto na primeira medição)
+// ============================================================
+class ThreadCounters {
+public:
+    ThreadCounters() {
+        const uint64_t cache_read_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const uint32_t types[NumEvents] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                           PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE,
+                                           PERF_TYPE_HARDWARE};
+        const uint64_t configs[NumEvents] = {PERF_COUNT_HW_CPU_CYCLES,
+                                             PERF_COUNT_HW_INSTRUCTIONS,
+                                             PERF_COUNT_HW_CACHE_L1D | cache_read_miss,
+                                             PERF_COUNT_HW_CACHE_LL | cache_read_miss,
+                                             PERF_COUNT_HW_BRANCH_MISSES};
+
+        // O primeiro evento que abrir vira líder; os demais entram no
+        // grupo (uma única leitura traz todos). Eventos indisponíveis
+        // (VM, perf_event_paranoid) ficam de fora sem derrubar o resto.
+        for (int e = 0; e < NumEvents; e++) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[e];
+            attr.config = configs[e];
+            attr.disabled = (leader < 0);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP |
+                               PERF_FORMAT_TOTAL_TIME_ENABLED |
+                               PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1,
+                                  leader < 0 ? -1 : fds[leader], 0);
+            fds[e] = fd;
+            slot[e] = -1;
+            if (fd < 0) continue;
+            if (leader < 0) leader = e;
+            slot[e] = n_open++;
+        }
+
+        if (leader >= 0) {
+            ioctl(fds[leader], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fds[leader], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    }
+
+    ~ThreadCounters() {
+        for (int e = 0; e < NumEvents; e++)
+            if (fds[e] >= 0) close(fds[e]);
+    }
+
+    ThreadCounters(const ThreadCounters&) = delete;
+    ThreadCounters& operator=(const ThreadCounters&) = delete;
+
+    static ThreadCounters& current() {
+        static thread_local ThreadCounters counters;
+        return counters;
+    }
+
+    bool available(int e) const { return slot[e] >= 0; }
+
+    // Valores acumulados desde a abertura, escalados se houve multiplexação
+    void read(uint64_t out[NumEvents]) const {
+        std::memset(out, 0, sizeof(uint64_t) * NumEvents);
+        if (leader < 0) return;
+
+        uint64_t buffer[3 + NumEvents];
+        if (::read(fds[leader], buffer, sizeof(buffer)) < (ssize_t)(3 * sizeof(uint64_t)))
+            return;
+
+        const uint64_t enabled = buffer[1], running = buffer[2];
+        const double scale = running > 0 ? (double)enabled / running : 1.0;
+        for (int e = 0; e < NumEvents; e++)
+            if (slot[e] >= 0 && (uint64_t)slot[e] < buffer[0])
+                out[e] = (uint64_t)(buffer[3 + slot[e]] * scale);
+    }
+
+private:
+    int fds[NumEvents];
+    int slot[NumEvents];
+    int n_open = 0;
+    int leader = -1;
+};
+
+// ============================================================
+// Totais globais por fase (somados por todas as threads)
+// ============================================================
+struct PhaseTotals {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> time_ns{0};
+    std::atomic<uint64_t> events[NumEvents] = {};
+};
+
+inline PhaseTotals* totals() {
+    static PhaseTotals phases[(int)PerfPhase::Count];
+    return phases;
+}
+
+inline std::atomic<unsigned>& available_mask() {
+    static std::atomic<unsigned> mask{0};
+    return mask;
+}
+
+// ============================================================
+// Escopo medido (RAII). Mantém uma pilha por thread para que o
+// trecho de um escopo filho não seja contado também no pai.
+// ============================================================
+class Scope {
+public:
+    explicit Scope(PerfPhase phase)
+        : phase(phase), counters(ThreadCounters::current()), parent(top())
+    {
+        uint64_t now_events[NumEvents];
+        const uint64_t now_ns = clock_ns();
+        counters.read(now_events);
+        if (parent) parent->flush(now_events, now_ns);
+
+        std::memcpy(last_events, now_events, sizeof(last_events));
+        last_ns = now_ns;
+        top() = this;
+        totals()[(int)phase].calls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~Scope() {
+        uint64_t now_events[NumEvents];
+        counters.read(now_events);
+        flush(now_events, clock_ns());
+
+        top() = parent;
+        if (parent) {
+            std::memcpy(parent->last_events, last_events, sizeof(last_events));
+            parent->last_ns = last_ns;
+        }
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    PerfPhase phase;
+    ThreadCounters& counters;
+    Scope* parent;
+    uint64_t last_events[NumEvents];
+    uint64_t last_ns;
+
+    static Scope*& top() {
+        static thread_local Scope* current = nullptr;
+        return current;
+    }
+
+    static uint64_t clock_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Credita a esta fase o trecho desde a última leitura
+    void flush(const uint64_t now_events[NumEvents], uint64_t now_ns) {
+        PhaseTotals& t = totals()[(int)phase];
+        t.time_ns.fetch_add(now_ns - last_ns, std::memory_order_relaxed);
+
+        unsigned mask = 0;
+        for (int e = 0; e < NumEvents; e++) {
+            if (!counters.available(e)) continue;
+            mask |= 1u << e;
+            t.events[e].fetch_add(now_events[e] - last_events[e], std::memory_order_relaxed);
+        }
+        available_mask().fetch_or(mask, std::memory_order_relaxed);
+
+        std::memcpy(last_events, now_events, sizeof(last_events));
+        last_ns = now_ns;
+    }
+};
+
+inline void reset() {
+    for (int p = 0; p < (int)PerfPhase::Count; p++) {
+        PhaseTotals& t = totals()[p];
+        t.calls = 0;
+        t.time_ns = 0;
+        for (auto& e : t.events) e = 0;
+    }
+}
+
+// Uma linha JSON por fase; contadores indisponíveis saem como null
+inline void write_json(std::ostream& out) {
+    const unsigned mask = available_mask().load();
+    for (int p = 0; p < (int)PerfPhase::Count; p++) {
+        const PhaseTotals& t = totals()[p];
+        if (t.calls == 0) continue;
+
+        out << "{\"phase\": \"" << phase_name((PerfPhase)p) << "\""
+            << ", \"calls\": " << t.calls.load()
+            << ", \"time_ms\": " << std::fixed << std::setprecision(3)
+            << t.time_ns.load() / 1e6;
+        for (int e = 0; e < NumEvents; e++) {
+            out << ", \"" << event_name(e) << "\": ";
+            if (mask & (1u << e)) out << t.events[e].load();
+            else out << "null";
+        }
+        const uint64_t cycles = t.events[Cycles].load();
+        out << ", \"ipc\": ";
+        if ((mask & (1u << Cycles)) && (mask & (1u << Instructions)) && cycles > 0)
+            out << std::setprecision(3) << (double)t.events[Instructions].load() / cycles;
+        else
+            out << "null";
+        out << "}\n";
+    }
+}
+
+// Salva o JSON em path (ou stdout se vazio)
+inline void report(const std::string& path) {
+    if (available_mask().load() == 0)
+        std::cerr << "⚠ perf_event_open indisponivel: apenas tempos por fase.\n";
+
+    if (path.empty()) {
+        std::cout << "\n========== CONTADORES POR FASE ==========\n";
+        write_json(std::cout);
+        return;
+    }
+    std::ofstream out(path);
+    write_json(out);
+    std::cout << "Contadores por fase salvos em: " << path << "\n";
+}
+
+} // namespace perf
+
+#define PERF_CONCAT_INNER(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_INNER(a, b)
+#define PERF_SCOPE(phase) perf::Scope PERF_CONCAT(perf_scope_, __LINE__)(PerfPhase::phase)
+#define PERF_REPORT(path) perf::report(path)
+
+#else
+
+#define PERF_SCOPE(phase) do {} while (0)
+#define PERF_REPORT(path) do {} while (0)
+
+#endif // FOREST_PERF
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,228 @@
+#include "QuantizedForest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+// ============================================================
+// Construção a partir da forma achatada
+// ============================================================
+void QuantizedForest::build(const FlatForest& forest, int n_classes)
+{
+    build(forest, n_classes, {});
+}
+
+void QuantizedForest::build(const FlatForest& forest, int n_classes,
+                            const std::vector<const FlatForest*>& dictionary_sources)
+{
+    const auto& flat_nodes = forest.get_nodes();
+    const auto& flat_roots = forest.get_roots();
+
+    num_classes = n_classes;
+    nodes.clear();
+    tree_base.clear();
+    tree_root.clear();
+    used_features.clear();
+    thresholds.clear();
+    threshold_offset.clear();
+    feature_categorical.clear();
+    category_masks.clear();
+
+    // 1. Dicionário de thresholds por feature usada (categóricas: vazio)
+    std::vector<const FlatForest*> sources = dictionary_sources;
+    sources.push_back(&forest);
+
+    int max_feature = -1;
+    for (const FlatForest* source : sources)
+        for (const auto& node : source->get_nodes())
+            max_feature = std::max(max_feature, node.feature());
+
+    std::vector<std::vector<double>> per_feature(max_feature + 1);
+    std::vector<char> used_as(max_feature + 1, 0);   // bit 1 numérica, bit 2 categórica
+    for (const FlatForest* source : sources) {
+        for (const auto& node : source->get_nodes()) {
+            if (node.is_categorical()) {
+                used_as[node.feature()] |= 2;
+            } else {
+                used_as[node.feature()] |= 1;
+                per_feature[node.feature()].push_back(node.threshold);
+            }
+        }
+    }
+
+    std::vector<int> compact_id(max_feature + 1, -1);
+    threshold_offset.push_back(0);
+    for (int f = 0; f <= max_feature; f++) {
+        if (!used_as[f]) continue;
+        if (used_as[f] == 3)
+            throw std::runtime_error("Feature usada como numerica e categorica no mesmo modelo");
+
+        auto& values = per_feature[f];
+
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        if (values.size() >= NAN_CODE)
+            throw std::runtime_error("Feature com thresholds demais para quantizacao uint16");
+
+        compact_id[f] = used_features.size();
+        used_features.push_back(f);
+        feature_categorical.push_back(used_as[f] == 2);
+        thresholds.insert(thresholds.end(), values.begin(), values.end());
+        threshold_offset.push_back(thresholds.size());
+    }
+    if (used_features.size() > 255)
+        throw std::runtime_error("Modelo usa features demais para quantizacao uint8");
+
+    // 2. Nós: mesma ordem da FlatForest, referências relativas à árvore
+    nodes.reserve(flat_nodes.size());
+    tree_base.reserve(flat_roots.size());
+    tree_root.reserve(flat_roots.size());
+
+    std::vector<int32_t> stack;
+    for (int32_t root : flat_roots) {
+        const int32_t base = nodes.size();
+        tree_base.push_back(base);
+
+        // folhas viram referências de classe (a tabela de saídas da
+        // FlatForest, se houver, não é usada na forma quantizada)
+        auto class_ref = [&](int32_t ref) -> int16_t {
+            return (int16_t)~(forest.ref_class(ref) + 1);
+        };
+        auto convert_ref = [&](int32_t ref) -> int16_t {
+            if (FlatForest::is_leaf_ref(ref)) return class_ref(ref);
+            int32_t local = ref - root;
+            if (local > std::numeric_limits<int16_t>::max())
+                throw std::runtime_error("Arvore grande demais para quantizacao int16");
+            return (int16_t)local;
+        };
+
+        tree_root.push_back(FlatForest::is_leaf_ref(root) ? class_ref(root) : (int16_t)0);
+        if (FlatForest::is_leaf_ref(root)) continue;
+
+        // árvore ocupa [root, root + n) contíguo na FlatForest
+        int32_t end = root;
+        stack.assign(1, root);
+        while (!stack.empty()) {
+            int32_t ref = stack.back();
+            stack.pop_back();
+            end = std::max(end, ref + 1);
+            for (int side = 0; side < 2; side++)
+                if (!FlatForest::is_leaf_ref(flat_nodes[ref].child[side]))
+                    stack.push_back(flat_nodes[ref].child[side]);
+        }
+
+        for (int32_t i = root; i < end; i++) {
+            const FlatNode& src = flat_nodes[i];
+            const int f = compact_id[src.feature()];
+
+            QuantizedNode node;
+            if (src.is_categorical()) {
+                if (category_masks.size() >= NAN_CODE)
+                    throw std::runtime_error("Mascaras categoricas demais para quantizacao uint16");
+                node.code = (uint16_t)category_masks.size();
+                category_masks.push_back(src.category_mask);
+            } else {
+                const double* begin = thresholds.data() + threshold_offset[f];
+                const double* stop = thresholds.data() + threshold_offset[f + 1];
+                node.code = (uint16_t)(std::lower_bound(begin, stop, src.threshold) - begin);
+            }
+            node.feature = (uint8_t)f;
+            node.categorical = src.is_categorical();
+            node.child[0] = convert_ref(src.child[0]);
+            node.child[1] = convert_ref(src.child[1]);
+            nodes.push_back(node);
+        }
+    }
+}
+
+// ============================================================
+// Quantização de uma amostra (uma busca binária por feature usada)
+// ============================================================
+void QuantizedForest::quantize_row(const double* sample, uint16_t* codes) const
+{
+    const int n_used = used_features.size();
+    for (int j = 0; j < n_used; j++) {
+        const double x = sample[used_features[j]];
+        if (std::isnan(x)) {
+            codes[j] = NAN_CODE;
+            continue;
+        }
+        if (feature_categorical[j]) {
+            codes[j] = (x >= 0.0 && x < MAX_CATEGORIES) ? (uint16_t)x : CATEGORY_NONE;
+            continue;
+        }
+        // lower_bound sem desvios (cmov), o dicionário é pequeno e quente
+        const double* base = thresholds.data() + threshold_offset[j];
+        const double* first = base;
+        size_t len = threshold_offset[j + 1] - threshold_offset[j];
+        while (len > 1) {
+            size_t half = len / 2;
+            first += (first[half - 1] < x) ? half : 0;
+            len -= half;
+        }
+        codes[j] = (uint16_t)((first - base) + (*first < x));
+    }
+}
+
+// ============================================================
+// Travessia com comparações inteiras
+// ============================================================
+int QuantizedForest::predict_tree(int t, const uint16_t* codes) const
+{
+    const QuantizedNode* tree = nodes.data() + tree_base[t];
+    int ref = tree_root[t];
+    while (ref >= 0) {
+        const QuantizedNode& node = tree[ref];
+        const uint16_t code = codes[node.feature];
+        if (!node.categorical)
+            ref = node.child[code > node.code];
+        else
+            ref = node.child[!(code < MAX_CATEGORIES && ((category_masks[node.code] >> code) & 1))];
+    }
+    return FlatForest::leaf_class(ref);
+}
+
+std::vector<int> QuantizedForest::predict(const std::vector<std::vector<double>>& X) const
+{
+    std::vector<int> predictions;
+    predictions.reserve(X.size());
+
+    // buffers locais: predict concorrente no mesmo modelo
+    std::vector<int> votes(num_classes);
+    std::vector<uint16_t> codes(used_features.size());
+    const int n_trees = tree_base.size();
+
+    for (const auto& sample : X) {
+        quantize_row(sample.data(), codes.data());
+
+        std::fill(votes.begin(), votes.end(), 0);
+        for (int t = 0; t < n_trees; t++) {
+            int pred = predict_tree(t, codes.data());
+            if (pred >= 0 && pred < num_classes)
+                votes[pred]++;
+        }
+
+        predictions.push_back(FlatForest::majority_class(votes.data(), num_classes));
+    }
+
+    return predictions;
+}
+
+bool QuantizedForest::same_dictionary(const QuantizedForest& other) const
+{
+    return used_features == other.used_features && thresholds == other.thresholds &&
+           threshold_offset == other.threshold_offset &&
+           feature_categorical == other.feature_categorical;
+}
+
+size_t QuantizedForest::memory_bytes() const
+{
+    return nodes.size() * sizeof(QuantizedNode) +
+           tree_base.size() * sizeof(int32_t) +
+           tree_root.size() * sizeof(int16_t) +
+           thresholds.size() * sizeof(double) +
+           threshold_offset.size() * sizeof(int32_t) +
+           used_features.size() * sizeof(int) +
+           category_masks.size() * sizeof(uint64_t);
+}
@@ -0,0 +1,75 @@
+#ifndef QUANTIZED_FOREST_H
+#define QUANTIZED_FOREST_H
+
+#include <vector>
+#include <cstdint>
+#include "FlatForest.h"
+
+// ------------------------------------------------------------
+// QuantizedForest
+// Modelo somente de inferência derivado da FlatForest. Os thresholds de
+// cada feature viram códigos de posto (uint16) num dicionário ordenado
+// por feature; cada amostra é quantizada uma vez (busca binária por
+// feature usada) e a travessia passa a ser comparação de inteiros:
+//
+//     x <= t_k  <=>  lower_bound(t_f, x) <= k
+//
+// Mesmas predições da floresta original (NaN sempre vai à direita).
+// Features categóricas não têm dicionário: o código é a própria
+// categoria e o nó guarda o índice da sua máscara de 64 bits.
+// ------------------------------------------------------------
+struct QuantizedNode {          // 8 bytes
+    uint16_t code;              // posto do threshold (ou índice da máscara categórica)
+    uint8_t feature;            // índice compacto da feature (< 255)
+    uint8_t categorical;        // 1 = split categórico
+    int16_t child[2];           // relativo à raiz da árvore; < 0 = folha
+};
+
+class QuantizedForest {
+public:
+    QuantizedForest() = default;
+
+    // Lança std::runtime_error se o modelo não couber na codificação
+    // (>255 features usadas, >65534 thresholds numa feature ou árvore
+    // com mais de 32767 nós internos) ou se uma feature aparecer como
+    // numérica e categórica ao mesmo tempo.
+    void build(const FlatForest& forest, int num_classes);
+    // Dicionário montado com os thresholds de todas as florestas em
+    // dictionary_sources (e da própria): modelos construídos com as mesmas
+    // fontes quantizam a linha do mesmo jeito (ver same_dictionary)
+    void build(const FlatForest& forest, int num_classes,
+               const std::vector<const FlatForest*>& dictionary_sources);
+    bool same_dictionary(const QuantizedForest& other) const;
+
+    std::vector<int> predict(const std::vector<std::vector<double>>& X) const;
+
+    // Quantiza uma amostra para os códigos das features usadas
+    void quantize_row(const double* sample, uint16_t* codes) const;
+    int predict_tree(int t, const uint16_t* codes) const;
+
+    int get_num_trees() const            { return tree_base.size(); }
+    int get_num_used_features() const    { return used_features.size(); }
+    int get_num_classes() const          { return num_classes; }
+    size_t get_num_nodes() const         { return nodes.size(); }
+    size_t get_num_thresholds() const    { return thresholds.size(); }
+    // Bytes percorridos na inferência (nós + raízes + dicionário)
+    size_t memory_bytes() const;
+
+private:
+    std::vector<QuantizedNode> nodes;
+    std::vector<int32_t> tree_base;        // início de cada árvore em nodes
+    std::vector<int16_t> tree_root;        // raiz relativa (< 0 = folha)
+
+    std::vector<int> used_features;        // índice compacto -> feature original
+    std::vector<double> thresholds;        // dicionários concatenados
+    std::vector<int32_t> threshold_offset; // [f, f+1) em thresholds
+    std::vector<char> feature_categorical; // por índice compacto
+    std::vector<uint64_t> category_masks;
+
+    int num_classes = 0;
+
+    static constexpr uint16_t NAN_CODE = 0xFFFF;
+    static constexpr uint16_t CATEGORY_NONE = MAX_CATEGORIES;
+};
+
+#endif // QUANTIZED_FOREST_H
@@ -1,9 +1,13 @@
 #include "RandomForestBaseline.h"
+#include "PerfCounters.h"
+#include "DataLoader.h"
 #include <fstream>
+#include <sstream>
 #include <numeric>
 #include <random>
 #include <algorithm>
 #include <unordered_map>
+#include <stdexcept>
 
 // ============================================================
 // Construtor
@@ -13,18 +17,28 @@ RandomForestBaseline::RandomForestBaseline(int n_trees,
                                            int min_samples_split)
     : n_trees(n_trees),
       max_depth(max_depth),
-      min_samples_split(min_samples_split)
+      min_samples_split(min_samples_split),
+      seed(std::random_device{}())
 {
     trees.reserve(n_trees);
 }
 
+// ============================================================
+// Semente de cada árvore (derivada da semente da floresta)
+// ============================================================
+unsigned int RandomForestBaseline::tree_seed(int tree_id) const
+{
+    return seed ^ (0x9E3779B9u * (unsigned int)(tree_id + 1));
+}
+
 // ============================================================
 // Bootstrap (amostragem com reposição)
 // ============================================================
 void RandomForestBaseline::bootstrap_indices(int n_samples,
+                                             int tree_id,
                                              std::vector<int>& out) const
 {
-    static thread_local std::mt19937 gen(std::random_device{}());
+    std::mt19937 gen(tree_seed(tree_id));
     std::uniform_int_distribution<int> dist(0, n_samples - 1);
 
     out.clear();
@@ -43,20 +57,150 @@ void RandomForestBaseline::fit(const std::vector<std::vector<double>>& X,
     trees.clear();
     trees.reserve(n_trees);
 
+    // OOB: votos zerados a cada fit
+    oob_votes.clear();
+    oob_class_error.clear();
+    oob_accuracy = 0.0;
+    oob_scored_samples = 0;
+    if (compute_oob) {
+        oob_num_classes = 0;
+        for (int label : y)
+            if (label + 1 > oob_num_classes) oob_num_classes = label + 1;
+        oob_votes.assign(X.size() * oob_num_classes, 0);
+        oob_checksum = DataLoader::checksum(X, y);
+    }
+
+    train_trees(X, y, n_trees);
+}
+
+// ============================================================
+// Warm start: acrescenta árvores novas (sementes novas) à floresta
+// ============================================================
+void RandomForestBaseline::grow(const std::vector<std::vector<double>>& X,
+                                const std::vector<int>& y,
+                                int n_new_trees)
+{
+    if (n_new_trees <= 0) return;
+
+    // Votos OOB só continuam se X e y têm o mesmo checksum do fit que os
+    // gerou; caso contrário (ex: modelo carregado, outro dataset) o OOB
+    // não é reportado.
+    if (oob_votes.empty() ||
+        oob_votes.size() != X.size() * (size_t)oob_num_classes ||
+        DataLoader::checksum(X, y) != oob_checksum) {
+        oob_votes.clear();
+        oob_class_error.clear();
+        oob_accuracy = 0.0;
+        oob_scored_samples = 0;
+    }
+
+    n_trees = trees.size() + n_new_trees;
+    trees.reserve(n_trees);
+
+    train_trees(X, y, n_trees);
+}
+
+// ============================================================
+// Treina as árvores [trees.size(), n_total)
+// ============================================================
+void RandomForestBaseline::train_trees(const std::vector<std::vector<double>>& X,
+                                       const std::vector<int>& y,
+                                       int n_total)
+{
     int n_samples = X.size();
     std::vector<int> sample_indices;
     sample_indices.reserve(n_samples);
 
-    for (int t = 0; t < n_trees; t++)
+    const bool track_oob = compute_oob && !oob_votes.empty();
+    std::vector<char> in_bag;
+    if (track_oob)
+        in_bag.resize(n_samples);
+    if (training_trace) training_trace->prepare(n_total);
+
+    for (int t = trees.size(); t < n_total; t++)
     {
-        bootstrap_indices(n_samples, sample_indices);
+        bootstrap_indices(n_samples, t, sample_indices);
 
         // Criar árvore usando índices diretamente (sem copiar dados)
         DecisionTree tree(max_depth, min_samples_split);
+        tree.set_seed(tree_seed(t));
+        TreeTrace* tree_trace = training_trace ? training_trace->start_tree(t, 0) : nullptr;
+        tree.set_trace(tree_trace);
         tree.fit(X, y, false, &sample_indices);
+        tree.set_trace(nullptr);
+        if (training_trace) training_trace->finish_tree(tree_trace);
+
+        if (track_oob)
+            accumulate_oob_votes(tree, X, sample_indices, in_bag);
 
         trees.emplace_back(std::move(tree));
     }
+
+    if (track_oob)
+        finalize_oob(y);
+}
+
+// ============================================================
+// OOB: votos da árvore recém-treinada nas amostras fora do bootstrap
+// ============================================================
+void RandomForestBaseline::accumulate_oob_votes(
+    const DecisionTree& tree,
+    const std::vector<std::vector<double>>& X,
+    const std::vector<int>& sample_indices,
+    std::vector<char>& in_bag)
+{
+    std::fill(in_bag.begin(), in_bag.end(), 0);
+    for (int idx : sample_indices)
+        in_bag[idx] = 1;
+
+    const int n_samples = X.size();
+    for (int i = 0; i < n_samples; i++) {
+        if (in_bag[i]) continue;
+        int pred = tree.predict_one(X[i]);
+        if (pred >= 0 && pred < oob_num_classes)
+            oob_votes[(size_t)i * oob_num_classes + pred]++;
+    }
+}
+
+// ============================================================
+// OOB: acurácia e erro por classe a partir dos votos acumulados
+// ============================================================
+void RandomForestBaseline::finalize_oob(const std::vector<int>& y)
+{
+    std::vector<int> class_total(oob_num_classes, 0);
+    std::vector<int> class_wrong(oob_num_classes, 0);
+    int correct = 0;
+    oob_scored_samples = 0;
+
+    const int n_samples = y.size();
+    for (int i = 0; i < n_samples; i++) {
+        const int* votes = &oob_votes[(size_t)i * oob_num_classes];
+
+        int best_class = -1;
+        int best_count = 0;
+        for (int c = 0; c < oob_num_classes; c++)
+            if (votes[c] > best_count) {
+                best_count = votes[c];
+                best_class = c;
+            }
+
+        // amostra que esteve em todos os bootstraps não é pontuada
+        if (best_class < 0) continue;
+
+        oob_scored_samples++;
+        class_total[y[i]]++;
+        if (best_class == y[i]) correct++;
+        else class_wrong[y[i]]++;
+    }
+
+    oob_accuracy = oob_scored_samples > 0
+                 ? (double)correct / oob_scored_samples
+                 : 0.0;
+
+    oob_class_error.assign(oob_num_classes, 0.0);
+    for (int c = 0; c < oob_num_classes; c++)
+        if (class_total[c] > 0)
+            oob_class_error[c] = (double)class_wrong[c] / class_total[c];
 }
 
 // ============================================================
@@ -87,6 +231,7 @@ int RandomForestBaseline::majority_vote(const std::vector<int>& votes) const
 std::vector<int> RandomForestBaseline::predict(
     const std::vector<std::vector<double>>& X) const
 {
+    PERF_SCOPE(Predict);
     std::vector<int> predictions;
     predictions.reserve(X.size());
 
@@ -106,8 +251,13 @@ std::vector<int> RandomForestBaseline::predict(
 // ============================================================
 // Salvar modelo
 // ============================================================
-void RandomForestBaseline::save_model(const std::string& filename) const
+void RandomForestBaseline::save_model(const std::string& filename, bool append) const
 {
+    if (append) {
+        append_model(filename);
+        return;
+    }
+
     std::ofstream out(filename, std::ios::binary);
     if (!out)
         throw std::runtime_error("Erro ao abrir arquivo de modelo para escrita");
@@ -122,6 +272,55 @@ void RandomForestBaseline::save_model(const std::string& filename) const
         tree.save_model(out);
 }
 
+// ============================================================
+// Acrescentar ao modelo existente: grava só as árvores que o arquivo
+// ainda não tem e reescreve n_trees no cabeçalho
+// ============================================================
+void RandomForestBaseline::append_model(const std::string& filename) const
+{
+    std::fstream file(filename, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file)
+        throw std::runtime_error("Erro ao abrir arquivo de modelo para acrescentar");
+
+    int file_trees = 0, file_depth = 0, file_min_split = 0;
+    file.read(reinterpret_cast<char*>(&file_trees), sizeof(file_trees));
+    file.read(reinterpret_cast<char*>(&file_depth), sizeof(file_depth));
+    file.read(reinterpret_cast<char*>(&file_min_split), sizeof(file_min_split));
+    if (!file)
+        throw std::runtime_error("Cabecalho de modelo invalido: " + filename);
+
+    if (file_depth != max_depth || file_min_split != min_samples_split)
+        throw std::runtime_error("Hiperparametros do modelo em disco diferem da floresta");
+    if (file_trees > (int)trees.size())
+        throw std::runtime_error("Modelo em disco tem mais arvores que a floresta");
+
+    // as árvores do arquivo precisam ser exatamente as primeiras desta
+    // floresta (byte a byte), sem nada depois delas
+    std::ostringstream prefix(std::ios::binary);
+    for (int t = 0; t < file_trees; t++)
+        trees[t].save_model(prefix);
+    const std::string expected = prefix.str();
+    const std::streampos trees_begin = file.tellg();
+    std::string on_disk(expected.size(), '\0');
+    file.read(&on_disk[0], on_disk.size());
+    const bool same_prefix = file && on_disk == expected && file.peek() == EOF;
+    file.clear();
+    if (!same_prefix)
+        throw std::runtime_error("Arvores do modelo em disco nao sao o inicio desta floresta");
+
+    // novas árvores no fim do arquivo
+    file.seekp(trees_begin + (std::streamoff)expected.size());
+    for (size_t t = file_trees; t < trees.size(); t++)
+        trees[t].save_model(file);
+
+    // novo total no cabeçalho
+    int total = trees.size();
+    file.seekp(0, std::ios::beg);
+    file.write(reinterpret_cast<const char*>(&total), sizeof(total));
+    if (!file)
+        throw std::runtime_error("Erro ao acrescentar arvores em: " + filename);
+}
+
 // ============================================================
 // Carregar modelo
 // ============================================================
@@ -136,6 +335,12 @@ void RandomForestBaseline::load_model(const std::string& filename)
     in.read(reinterpret_cast<char*>(&max_depth), sizeof(max_depth));
     in.read(reinterpret_cast<char*>(&min_samples_split), sizeof(min_samples_split));
 
+    // votos OOB não pertencem ao modelo carregado
+    oob_votes.clear();
+    oob_class_error.clear();
+    oob_accuracy = 0.0;
+    oob_scored_samples = 0;
+
     // recriar floresta
     trees.clear();
     trees.reserve(n_trees);
@@ -2,8 +2,10 @@
 #define RANDOM_FOREST_BASELINE_H
 
 #include <vector>
+#include <cstdint>
 #include <string>
 #include "DecisionTree.h"
+#include "TrainingTrace.h"
 
 // ------------------------------------------------------------
 // RandomForestBaseline
@@ -19,13 +21,38 @@ public:
     void fit(const std::vector<std::vector<double>>& X,
              const std::vector<int>& y);
 
+    // Warm start: acrescenta n_new_trees árvores (sementes novas) a uma
+    // floresta já treinada ou carregada, sem retreinar as existentes
+    void grow(const std::vector<std::vector<double>>& X,
+              const std::vector<int>& y,
+              int n_new_trees);
+
+    // Semente da floresta (cada árvore deriva a sua a partir dela)
+    void set_seed(unsigned int s)      { seed = s; }
+
+    // Telemetria por árvore/nível dos próximos treinos (nullptr desliga)
+    void set_training_trace(TrainingTrace* trace) { training_trace = trace; }
+
     // Predição em várias amostras
     std::vector<int> predict(const std::vector<std::vector<double>>& X) const;
 
+    // --------------------------------------------------------
+    // Out-of-bag: cada árvore vota nas amostras que ficaram fora
+    // do seu bootstrap, acumulado durante o fit (sem segunda passada)
+    // --------------------------------------------------------
+    void set_oob_score(bool enabled)   { compute_oob = enabled; }
+    bool has_oob_score() const         { return oob_scored_samples > 0; }
+    double get_oob_accuracy() const    { return oob_accuracy; }
+    int get_oob_scored_samples() const { return oob_scored_samples; }
+    // Erro OOB por classe (fração de amostras da classe c classificadas errado)
+    const std::vector<double>& get_oob_class_error() const { return oob_class_error; }
+
     // --------------------------------------------------------
     // Serialização binária (modelo completo da floresta)
     // --------------------------------------------------------
-    void save_model(const std::string& filename) const;
+    // append = true: acrescenta ao arquivo só as árvores que ele ainda
+    // não tem e reescreve n_trees no cabeçalho
+    void save_model(const std::string& filename, bool append = false) const;
     void load_model(const std::string& filename);
 
     // Getters úteis
@@ -37,15 +64,36 @@ private:
     int n_trees;
     int max_depth;
     int min_samples_split;
+    unsigned int seed;
 
     std::vector<DecisionTree> trees;
+    TrainingTrace* training_trace = nullptr;
 
     // Buffers para votação (evita realocação)
     mutable std::vector<int> vote_buffer;
 
+    // Estado OOB (votos n_samples x n_classes acumulados por árvore)
+    bool compute_oob = false;
+    int oob_num_classes = 0;
+    std::vector<int> oob_votes;
+    uint64_t oob_checksum = 0;       // DataLoader::checksum(X, y) dos votos
+    double oob_accuracy = 0.0;
+    int oob_scored_samples = 0;
+    std::vector<double> oob_class_error;
+
     // Auxiliares
-    void bootstrap_indices(int n_samples, std::vector<int>& out) const;
+    unsigned int tree_seed(int tree_id) const;
+    void bootstrap_indices(int n_samples, int tree_id, std::vector<int>& out) const;
+    void train_trees(const std::vector<std::vector<double>>& X,
+                     const std::vector<int>& y,
+                     int n_total);
+    void append_model(const std::string& filename) const;
     int majority_vote(const std::vector<int>& votes) const;
+    void accumulate_oob_votes(const DecisionTree& tree,
+                              const std::vector<std::vector<double>>& X,
+                              const std::vector<int>& sample_indices,
+                              std::vector<char>& in_bag);
+    void finalize_oob(const std::vector<int>& y);
 };
 
 #endif // RANDOM_FOREST_BASELINE_H
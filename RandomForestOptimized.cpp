@@ -1,9 +1,14 @@
 #include "RandomForestOptimized.h"
+#include "CompactModel.h"
+#include "DataLoader.h"
+#include "PerfCounters.h"
 #include <fstream>
+#include <sstream>
 #include <random>
 #include <numeric>
 #include <algorithm>
-#include <unordered_map>
+#include <stdexcept>
+#include <mutex>
 
 // ============================================================
 // Construtor
@@ -15,35 +20,86 @@ RandomForestOptimized::RandomForestOptimized(int n_trees,
     : n_trees(n_trees),
       max_depth(max_depth),
       min_samples_split(min_samples_split),
-      chunk_size(chunk_size)
+      chunk_size(chunk_size),
+      seed(std::random_device{}())
 {
     trees.reserve(n_trees);
 }
 
+// ============================================================
+// Semente de cada árvore (derivada da semente da floresta)
+// ============================================================
+unsigned int RandomForestOptimized::tree_seed(int tree_id) const
+{
+    return seed ^ (0x9E3779B9u * (unsigned int)(tree_id + 1));
+}
+
 // ============================================================
 // Inicializa ordem base de índices (embaralhados uma vez)
 // ============================================================
-void RandomForestOptimized::init_base_indices(int n_samples)
+void RandomForestOptimized::init_base_indices(int n_samples, const std::vector<int>* rows)
 {
-    base_indices.resize(n_samples);
-    std::iota(base_indices.begin(), base_indices.end(), 0);
+    if (rows) {
+        base_indices = *rows;
+    } else {
+        base_indices.resize(n_samples);
+        std::iota(base_indices.begin(), base_indices.end(), 0);
+    }
 
-    static thread_local std::mt19937 gen(std::random_device{}());
+    std::mt19937 gen(seed);
     std::shuffle(base_indices.begin(), base_indices.end(), gen);
 }
 
+// ============================================================
+// Cache column-major do dataset (transposto uma vez por floresta,
+// compartilhado por todas as árvores e reaproveitado no warm start)
+// ============================================================
+void RandomForestOptimized::build_column_cache(const std::vector<std::vector<double>>& X)
+{
+    DataLoader::to_column_major(X, X_col_cache);
+    X_col_checksum = keep_dataset_cache ? DataLoader::checksum(X) : 0;
+    presorted_cache.clear();
+    X_col_replicas.clear();
+    presorted_replicas.clear();
+}
+
+bool RandomForestOptimized::column_cache_matches(const std::vector<std::vector<double>>& X) const
+{
+    if (X.empty()) return false;
+    return X_col_cache.size() == X[0].size() &&
+           !X_col_cache.empty() &&
+           X_col_cache[0].size() == X.size() &&
+           DataLoader::checksum(X) == X_col_checksum;
+}
+
+void RandomForestOptimized::clear_dataset_cache()
+{
+    std::vector<std::vector<double>>().swap(X_col_cache);
+    X_col_checksum = 0;
+    ColumnOrder().swap(presorted_cache);
+    X_col_replicas.clear();
+    presorted_replicas.clear();
+}
+
 // ============================================================
 // Rearranja índices de forma cache-friendly para cada árvore
 // ============================================================
+int RandomForestOptimized::window_offset(int n_samples, int tree_id) const
+{
+    // Com OOB as janelas são espalhadas uniformemente pela ordem base,
+    // para que cada amostra fique fora de ~holdout das árvores
+    return compute_oob
+         ? (int)(((long long)tree_id * n_samples / n_trees) % n_samples)
+         : (tree_id * chunk_size) % n_samples;
+}
+
 void RandomForestOptimized::make_cache_friendly_indices(
     int n_samples,
-    int tree_id,
+    int offset,
     std::vector<int>& out_indices) const
 {
     out_indices.resize(n_samples);
 
-    int offset = (tree_id * chunk_size) % n_samples;
-
     for (int i = 0; i < n_samples; i++)
         out_indices[i] = base_indices[(i + offset) % n_samples];
 }
@@ -54,47 +110,416 @@ void RandomForestOptimized::make_cache_friendly_indices(
 void RandomForestOptimized::fit(const std::vector<std::vector<double>>& X,
                                 const std::vector<int>& y)
 {
+    if (range_forest_trees > 0 && compute_oob)
+        throw std::invalid_argument("OOB nao suportado no treino por faixas de arvores");
+
     const int n_samples = X.size();
     init_base_indices(n_samples);
+    build_column_cache(X);
+    reset_training_state();
+    leaf_mode = probability_leaves ? LeafMode::Distribution : LeafMode::Class;
 
+    // OOB: votos zerados a cada fit
+    if (compute_oob) {
+        oob_num_classes = 0;
+        for (int label : y)
+            if (label + 1 > oob_num_classes) oob_num_classes = label + 1;
+        oob_votes.assign((size_t)n_samples * oob_num_classes, 0);
+        oob_checksum = DataLoader::checksum(X, y);
+    }
+
+    train_trees(&X, X_col_cache, nullptr, y, n_trees);
+    if (!keep_dataset_cache) clear_dataset_cache();
+}
+
+// ============================================================
+// Treino sobre um subconjunto de linhas de um dataset column-major
+// externo (ex: folds de validação cruzada): a ordem base é feita só com
+// essas linhas e as árvores leem as colunas compartilhadas direto
+// ============================================================
+void RandomForestOptimized::fit_rows(const std::vector<std::vector<double>>& X_col,
+                                     const std::vector<int>& y,
+                                     const std::vector<int>& rows,
+                                     const ColumnOrder* presorted)
+{
+    if (compute_oob)
+        throw std::invalid_argument("OOB nao suportado no treino por subconjunto de linhas");
+    if (rows.empty() || X_col.empty())
+        throw std::invalid_argument("nenhuma linha para treino");
+    for (int row : rows)
+        if (row < 0 || row >= (int)y.size() || row >= (int)X_col[0].size())
+            throw std::invalid_argument("linha fora do dataset: " + std::to_string(row));
+
+    init_base_indices(rows.size(), &rows);
+    reset_training_state();
+    leaf_mode = probability_leaves ? LeafMode::Distribution : LeafMode::Class;
+
+    train_trees(nullptr, X_col, presorted, y, n_trees);
+}
+
+// ============================================================
+// Regressão: mesmo fluxo do fit, com alvo contínuo e sem OOB
+// ============================================================
+void RandomForestOptimized::fit_regression(const std::vector<std::vector<double>>& X,
+                                           const std::vector<double>& y)
+{
+    if (X.size() != y.size())
+        throw std::invalid_argument("X e y da regressao com tamanhos diferentes");
+
+    init_base_indices(X.size());
+    build_column_cache(X);
+    reset_training_state();
+    leaf_mode = LeafMode::Regression;
+
+    train_trees(&X, X_col_cache, nullptr, std::vector<int>(), n_trees, &y);
+    if (!keep_dataset_cache) clear_dataset_cache();
+}
+
+void RandomForestOptimized::set_tree_range(int first_tree, int forest_trees)
+{
+    if (forest_trees > 0 && (first_tree < 0 || first_tree + n_trees > forest_trees))
+        throw std::invalid_argument("faixa de arvores fora da floresta: [" +
+                                    std::to_string(first_tree) + ", " +
+                                    std::to_string(first_tree + n_trees) + ") de " +
+                                    std::to_string(forest_trees));
+    range_first_tree = forest_trees > 0 ? first_tree : 0;
+    range_forest_trees = std::max(0, forest_trees);
+}
+
+void RandomForestOptimized::reset_training_state()
+{
     trees.clear();
     trees.reserve(n_trees);
+    tree_quality.clear();
+    tree_oob_offset.clear();
+    num_classes = 0;
+    importance_sum.clear();
+    split_counts.clear();
 
-    temp_indices.reserve(n_samples);
+    oob_votes.clear();
+    oob_class_error.clear();
+    oob_accuracy = 0.0;
+    oob_scored_samples = 0;
+}
+
+// ============================================================
+// Warm start: acrescenta árvores novas (sementes novas) à floresta,
+// reaproveitando o cache column-major e a ordem base do último fit
+// ============================================================
+void RandomForestOptimized::grow(const std::vector<std::vector<double>>& X,
+                                 const std::vector<int>& y,
+                                 int n_new_trees)
+{
+    if (n_new_trees <= 0) return;
+    require_trees("grow");
+    if (leaf_mode == LeafMode::Regression)
+        throw std::invalid_argument("warm start nao suportado em floresta de regressao");
+    if (range_forest_trees > 0)
+        throw std::invalid_argument("warm start nao suportado no treino por faixas de arvores");
+
+    const int n_samples = X.size();
+    if ((int)base_indices.size() != n_samples)
+        init_base_indices(n_samples);
+    if (!column_cache_matches(X))
+        build_column_cache(X);
+
+    // Votos OOB só continuam se X e y têm o mesmo checksum do fit que os
+    // gerou (e as árvores atuais são as que votaram); caso contrário
+    // (ex: modelo carregado, outro dataset) o OOB não é reportado.
+    if (oob_votes.empty() ||
+        oob_votes.size() != (size_t)n_samples * oob_num_classes ||
+        tree_quality.size() != trees.size() ||
+        DataLoader::checksum(X, y) != oob_checksum) {
+        tree_quality.clear();
+        tree_oob_offset.clear();
+        oob_votes.clear();
+        oob_class_error.clear();
+        oob_accuracy = 0.0;
+        oob_scored_samples = 0;
+    }
+
+    n_trees = trees.size() + n_new_trees;
+    trees.reserve(n_trees);
+
+    train_trees(&X, X_col_cache, nullptr, y, n_trees);
+    if (!keep_dataset_cache) clear_dataset_cache();
+}
+
+// ============================================================
+// Treina as árvores [trees.size(), n_total) sobre as colunas (o cache
+// column-major ou um dataset externo, com a sua pré-ordenação) e as
+// linhas da ordem base. X (linhas) só é usado pelo OOB.
+// ============================================================
+void RandomForestOptimized::train_trees(const std::vector<std::vector<double>>* X,
+                                        const std::vector<std::vector<double>>& columns,
+                                        const ColumnOrder* presorted,
+                                        const std::vector<int>& y,
+                                        int n_total,
+                                        const std::vector<double>* targets)
+{
+    const int n_samples = base_indices.size();
+    const bool own_columns = (&columns == &X_col_cache);
+    const int first_tree = trees.size();
+
+    // Colunas categóricas conferidas antes de mexer nas árvores: nenhuma
+    // tarefa do parallel_for lança por entrada inválida
+    std::vector<char> is_categorical(columns.size(), 0);
+    for (int f : categorical_columns) {
+        if (f < 0 || f >= (int)is_categorical.size())
+            throw std::invalid_argument("coluna categorica fora do dataset: " + std::to_string(f));
+        is_categorical[f] = 1;
+    }
+    DecisionTree::validate_categorical_columns(columns, is_categorical);
+
+    flat.clear();
+
+    const bool track_oob = compute_oob && !oob_votes.empty() && X;
+    int n_in_bag = n_samples;
+    if (track_oob) {
+        int n_oob = (int)(n_samples * oob_holdout);
+        n_in_bag = std::max(1, n_samples - n_oob);
+        tree_quality.resize(n_total);
+        tree_oob_offset.resize(n_total);
+    }
+
+    for (int label : y)
+        if (label + 1 > num_classes) num_classes = label + 1;
+
+    // Árvores são independentes (semente por árvore): cada tarefa treina
+    // uma árvore no seu slot; só os votos OOB compartilhados usam lock.
+    trees.resize(n_total);
+    std::mutex oob_mutex;
+    if (training_trace) training_trace->prepare(n_total);
+
+    // Pré-ordenação única para todas as árvores do crescimento por nível
+    // (dataset externo: só com a pré-ordenação dele; senão, recursivo)
+    const bool grow_level_wise = level_wise && !extra_trees && categorical_columns.empty() &&
+                                 (own_columns || presorted);
+    if (grow_level_wise && own_columns && presorted_cache.empty())
+        DecisionTree::presort_columns(X_col_cache, is_categorical, presorted_cache);
+    const ColumnOrder& base_order = own_columns ? presorted_cache
+                                  : presorted ? *presorted : presorted_cache;
+    const bool use_replicas = numa_active() && own_columns;
+    if (use_replicas)
+        replicate_dataset(grow_level_wise);
+
+    get_pool().parallel_for(n_total - first_tree, [&](int k) {
+        const int t = first_tree + k;
+        std::vector<int> indices;
+        std::vector<int> oob_rows;
 
-    for (int t = 0; t < n_trees; t++)
-    {
         // reorganiza índices para esta árvore
-        make_cache_friendly_indices(n_samples, t, temp_indices);
+        const int tree_id = range_first_tree + t;   // id na floresta completa
+        const int offset = window_offset(n_samples, tree_id);
+        make_cache_friendly_indices(n_samples, offset, indices);
+
+        if (track_oob) {
+            oob_rows.assign(indices.begin() + n_in_bag, indices.end());
+            indices.resize(n_in_bag);
+        }
+
+        // cópia do dataset no nó desta thread (modo NUMA)
+        const int node = current_numa_node();
+        const auto& X_col = use_replicas ? X_col_replicas[node] : columns;
+        const ColumnOrder& order = use_replicas && grow_level_wise ? presorted_replicas[node]
+                                                                   : base_order;
 
         // Criar árvore usando índices diretamente (sem copiar dados)
         DecisionTree tree(max_depth, min_samples_split, chunk_size);
-        tree.fit(X, y, true, &temp_indices); // ← usa chunked = otimizado
+        tree.set_seed(tree_seed(tree_id));
+        tree.set_categorical_features(is_categorical);
+        tree.set_extra_trees(extra_trees);
+        tree.set_level_wise(grow_level_wise, &order);
+        TreeTrace* tree_trace = training_trace
+            ? training_trace->start_tree(t, ThreadPool::current_worker()) : nullptr;
+        tree.set_trace(tree_trace);
+        if (targets) {
+            tree.fit_regression_columns(X_col, *targets, indices);
+        } else {
+            tree.set_leaf_mode(leaf_mode);
+            tree.fit_columns(X_col, y, indices);
+        }
+        tree.set_trace(nullptr);
+        if (training_trace) training_trace->finish_tree(tree_trace);
+
+        if (track_oob) {
+            tree_quality[t] = accumulate_oob_votes(tree, *X, y, oob_rows, oob_mutex);
+            tree_oob_offset[t] = offset;
+        }
 
-        trees.emplace_back(std::move(tree));
+        trees[t] = std::move(tree);
+    });
+
+    // Importância: cada árvore acumulou a sua no próprio fit (sem
+    // disputa entre threads); a soma é feita aqui, em ordem de árvore
+    for (int t = first_tree; t < n_total; t++) {
+        const std::vector<double>& importance = trees[t].get_feature_importance();
+        const std::vector<int>& counts = trees[t].get_split_counts();
+        if (importance_sum.size() < importance.size()) {
+            importance_sum.resize(importance.size(), 0.0);
+            split_counts.resize(importance.size(), 0);
+        }
+        for (size_t f = 0; f < importance.size(); f++) {
+            importance_sum[f] += importance[f];
+            split_counts[f] += counts[f];
+        }
     }
+
+    if (track_oob)
+        finalize_oob(y);
+    replicate_model();
 }
 
 // ============================================================
-// Votação majoritária
+// Importância das features e seleção de colunas na predição
 // ============================================================
-int RandomForestOptimized::majority_vote(const std::vector<int>& votes) const
+std::vector<double> RandomForestOptimized::get_feature_importance() const
 {
-    std::unordered_map<int,int> freq;
+    std::vector<double> normalized = importance_sum;
+    double total = 0.0;
+    for (double v : normalized) total += v;
+    if (total > 0.0)
+        for (double& v : normalized) v /= total;
+    return normalized;
+}
 
-    for (int v : votes)
-        freq[v]++;
+std::vector<int> RandomForestOptimized::get_used_features() const
+{
+    std::vector<char> used;
+    for (const auto& tree : trees)
+        tree.collect_used_features(used);
 
-    int best_class = -1;
-    int best_count = -1;
+    std::vector<int> features;
+    for (size_t f = 0; f < used.size(); f++)
+        if (used[f]) features.push_back(f);
+    return features;
+}
 
-    for (auto& kv : freq)
-        if (kv.second > best_count) {
-            best_class = kv.first;
-            best_count = kv.second;
-        }
+void RandomForestOptimized::select_features(const std::vector<int>& columns)
+{
+    require_trees("select_features");
+    if (!std::is_sorted(columns.begin(), columns.end()))
+        throw std::invalid_argument("colunas selecionadas devem estar em ordem crescente");
+
+    // f -> posição em columns (-1 = coluna removida)
+    const int n_original = columns.empty() ? 0 : columns.back() + 1;
+    std::vector<int> new_index(n_original, -1);
+    for (size_t k = 0; k < columns.size(); k++) {
+        if (columns[k] < 0)
+            throw std::invalid_argument("coluna selecionada negativa");
+        new_index[columns[k]] = k;
+    }
+
+    // valida antes de alterar qualquer árvore
+    for (int f : get_used_features())
+        if (f >= n_original || new_index[f] < 0)
+            throw std::invalid_argument("o modelo usa a feature " + std::to_string(f) +
+                                        ", removida da selecao de colunas");
+
+    for (auto& tree : trees)
+        tree.remap_features(new_index);
+
+    std::vector<int> categorical;
+    for (int f : categorical_columns)
+        if (f < n_original && new_index[f] >= 0) categorical.push_back(new_index[f]);
+    categorical_columns = std::move(categorical);
+
+    // cache do dataset não corresponde mais às colunas do modelo
+    clear_dataset_cache();
+    importance_sum.clear();
+    split_counts.clear();
+    if (!flat.empty()) flat.build(trees, flat_layout);
+    replicate_model();
+}
 
-    return best_class;
+// ============================================================
+// Configuração OOB
+// ============================================================
+void RandomForestOptimized::set_oob_score(bool enabled, double holdout_fraction)
+{
+    if (enabled && (holdout_fraction <= 0.0 || holdout_fraction >= 1.0))
+        throw std::invalid_argument("holdout OOB deve estar em (0, 1)");
+
+    compute_oob = enabled;
+    if (enabled) oob_holdout = holdout_fraction;
+}
+
+// ============================================================
+// OOB: votos da árvore recém-treinada na sua janela fora do treino
+// ============================================================
+double RandomForestOptimized::accumulate_oob_votes(
+    const DecisionTree& tree,
+    const std::vector<std::vector<double>>& X,
+    const std::vector<int>& y,
+    const std::vector<int>& oob_rows,
+    std::mutex& votes_mutex)
+{
+    // predições fora do lock; só a soma nos votos compartilhados é serial
+    std::vector<int> preds(oob_rows.size());
+    int correct = 0;
+    for (size_t i = 0; i < oob_rows.size(); i++) {
+        preds[i] = tree.predict_one(X[oob_rows[i]]);
+        if (preds[i] == y[oob_rows[i]]) correct++;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(votes_mutex);
+        for (size_t i = 0; i < oob_rows.size(); i++)
+            if (preds[i] >= 0 && preds[i] < oob_num_classes)
+                oob_votes[(size_t)oob_rows[i] * oob_num_classes + preds[i]]++;
+    }
+
+    // acurácia OOB individual da árvore (métrica de qualidade)
+    return oob_rows.empty() ? 0.0 : (double)correct / oob_rows.size();
+}
+
+// ============================================================
+// OOB: acurácia e erro por classe a partir dos votos acumulados
+// ============================================================
+void RandomForestOptimized::finalize_oob(const std::vector<int>& y)
+{
+    std::vector<int> class_total(oob_num_classes, 0);
+    std::vector<int> class_wrong(oob_num_classes, 0);
+    int correct = 0;
+    oob_scored_samples = 0;
+
+    const int n_samples = y.size();
+    for (int i = 0; i < n_samples; i++) {
+        const int* votes = &oob_votes[(size_t)i * oob_num_classes];
+
+        int best_class = -1;
+        int best_count = 0;
+        for (int c = 0; c < oob_num_classes; c++)
+            if (votes[c] > best_count) {
+                best_count = votes[c];
+                best_class = c;
+            }
+
+        // amostra que nunca caiu numa janela OOB não é pontuada
+        if (best_class < 0) continue;
+
+        oob_scored_samples++;
+        class_total[y[i]]++;
+        if (best_class == y[i]) correct++;
+        else class_wrong[y[i]]++;
+    }
+
+    oob_accuracy = oob_scored_samples > 0
+                 ? (double)correct / oob_scored_samples
+                 : 0.0;
+
+    oob_class_error.assign(oob_num_classes, 0.0);
+    for (int c = 0; c < oob_num_classes; c++)
+        if (class_total[c] > 0)
+            oob_class_error[c] = (double)class_wrong[c] / class_total[c];
+}
+
+// ============================================================
+// Votação majoritária (contagem por classe; empate → menor classe)
+// ============================================================
+int RandomForestOptimized::majority_vote(const std::vector<int>& counts) const
+{
+    return FlatForest::majority_class(counts.data(), counts.size());
 }
 
 // ============================================================
@@ -103,31 +528,678 @@ int RandomForestOptimized::majority_vote(const std::vector<int>& votes) const
 std::vector<int> RandomForestOptimized::predict(
     const std::vector<std::vector<double>>& X) const
 {
-    std::vector<int> predictions;
-    predictions.reserve(X.size());
+    if (leaf_mode == LeafMode::Regression)
+        throw std::runtime_error("floresta de regressao: use predict_regression");
 
-    vote_buffer.resize(n_trees);
+    const int n_rows = X.size();
+    std::vector<int> predictions(n_rows);
 
-    for (const auto& sample : X)
-    {
-        for (int t = 0; t < n_trees; t++)
-            vote_buffer[t] = trees[t].predict_one(sample);
+    // Blocos de linhas independentes, cada um com seu buffer de votos
+    const int block = 1024;
+    const int n_blocks = (n_rows + block - 1) / block;
+    std::vector<long long> evaluated_per_block(n_blocks, 0);
+
+    get_pool().parallel_for(n_blocks, [&](int b) {
+        PERF_SCOPE(Predict);
+        const int begin = b * block;
+        const int end = std::min(n_rows, (b + 1) * block);
+        const FlatForest& flat = local_flat();   // cópia do nó (modo NUMA)
+
+        if (!early_exit) {
+            // Travessia primeiro (votos do bloco inteiro), votação depois.
+            // Árvores de ponteiros: árvore por árvore sobre o bloco, para
+            // os nós ficarem quentes no cache. Forma achatada: já é
+            // compacta, então linha por linha (a linha fica no cache).
+            std::vector<int> block_counts((size_t)(end - begin) * num_classes, 0);
+            auto add_vote = [&](int i, int pred) {
+                if (pred >= 0 && pred < num_classes)
+                    block_counts[(size_t)(i - begin) * num_classes + pred]++;
+            };
+            if (flat.empty()) {
+                for (int t = 0; t < n_trees; t++)
+                    for (int i = begin; i < end; i++)
+                        add_vote(i, trees[t].predict_one(X[i]));
+            } else {
+                for (int i = begin; i < end; i++)
+                    for (int t = 0; t < n_trees; t++)
+                        add_vote(i, flat.predict_tree(t, X[i].data()));
+            }
+
+            PERF_SCOPE(Vote);
+            std::vector<int> counts(num_classes);
+            for (int i = begin; i < end; i++)
+            {
+                auto row = block_counts.begin() + (size_t)(i - begin) * num_classes;
+                std::copy(row, row + num_classes, counts.begin());
+                predictions[i] = majority_vote(counts);
+            }
+            evaluated_per_block[b] = (long long)(end - begin) * n_trees;
+            return;
+        }
+
+        // Early exit: linha por linha, parando quando o voto decide
+        std::vector<int> counts(num_classes);
+        long long evaluated_total = 0;
+
+        for (int i = begin; i < end; i++)
+        {
+            const auto& sample = X[i];
+            std::fill(counts.begin(), counts.end(), 0);
+
+            int evaluated = 0;
+            for (int t = 0; t < n_trees; t++)
+            {
+                int pred = flat.empty() ? trees[t].predict_one(sample)
+                                        : flat.predict_tree(t, sample.data());
+                if (pred >= 0 && pred < num_classes)
+                    counts[pred]++;
+                evaluated++;
 
-        predictions.push_back(majority_vote(vote_buffer));
+                if (vote_is_decided(counts, evaluated))
+                    break;
+            }
+            evaluated_total += evaluated;
+
+            predictions[i] = majority_vote(counts);
+        }
+        evaluated_per_block[b] = evaluated_total;
+    });
+
+    // Estatística só com early exit (sem ele são todas as árvores): com
+    // early exit desligado o predict não escreve nada no objeto e pode
+    // rodar em várias threads sobre o mesmo modelo
+    if (early_exit) {
+        long long evaluated_total = 0;
+        for (long long e : evaluated_per_block) evaluated_total += e;
+        last_avg_trees_evaluated = X.empty() ? 0.0 : (double)evaluated_total / X.size();
     }
+    return predictions;
+}
+
+// ============================================================
+// Predição por índices de linha sobre colunas (ex: fold de teste da
+// validação cruzada), sem montar uma cópia row-major das linhas
+// ============================================================
+std::vector<int> RandomForestOptimized::predict_rows(
+    const std::vector<std::vector<double>>& X_col,
+    const std::vector<int>& rows) const
+{
+    if (leaf_mode == LeafMode::Regression)
+        throw std::runtime_error("floresta de regressao: use predict_regression");
+
+    const int n_rows = rows.size();
+    const size_t n_features = X_col.size();
+    std::vector<int> predictions(n_rows);
+
+    const int block = 1024;
+    const int n_blocks = (n_rows + block - 1) / block;
+    get_pool().parallel_for(n_blocks, [&](int b) {
+        PERF_SCOPE(Predict);
+        const int begin = b * block;
+        const int end = std::min(n_rows, (b + 1) * block);
+        const FlatForest& flat = local_flat();   // cópia do nó (modo NUMA)
 
+        std::vector<double> sample(n_features);
+        std::vector<int> counts(num_classes);
+        for (int i = begin; i < end; i++) {
+            for (size_t f = 0; f < n_features; f++)
+                sample[f] = X_col[f][rows[i]];
+            std::fill(counts.begin(), counts.end(), 0);
+            for (int t = 0; t < n_trees; t++) {
+                const int pred = flat.empty() ? trees[t].predict_one(sample)
+                                              : flat.predict_tree(t, sample.data());
+                if (pred >= 0 && pred < num_classes)
+                    counts[pred]++;
+            }
+            predictions[i] = majority_vote(counts);
+        }
+    });
     return predictions;
 }
 
+// ============================================================
+// Probabilidades / regressão: soma das saídas das folhas por linha.
+// Cada bloco acumula direto na sua faixa da saída; a soma de uma folha
+// é um laço contíguo de width floats (vetorizado pelo compilador), sem
+// tabela de votos por classe.
+// ============================================================
+std::vector<double> RandomForestOptimized::predict_proba(
+    const std::vector<std::vector<double>>& X) const
+{
+    if (leaf_mode == LeafMode::Regression)
+        throw std::runtime_error("floresta de regressao nao tem probabilidades por classe");
+    return predict_leaf_average(X, num_classes);
+}
+
+std::vector<double> RandomForestOptimized::predict_regression(
+    const std::vector<std::vector<double>>& X) const
+{
+    if (leaf_mode != LeafMode::Regression)
+        throw std::runtime_error("floresta de classificacao: use predict ou predict_proba");
+    return predict_leaf_average(X, 1);
+}
+
+std::vector<double> RandomForestOptimized::predict_leaf_average(
+    const std::vector<std::vector<double>>& X,
+    int width) const
+{
+    const int n_rows = X.size();
+    std::vector<double> output((size_t)n_rows * width, 0.0);
+    if (n_trees == 0 || width == 0) return output;
+
+    const bool hard_votes = (leaf_mode == LeafMode::Class);
+    const double inv_trees = 1.0 / n_trees;
+    const int block = 1024;
+    const int n_blocks = (n_rows + block - 1) / block;
+
+    get_pool().parallel_for(n_blocks, [&](int b) {
+        PERF_SCOPE(Predict);
+        const int begin = b * block;
+        const int end = std::min(n_rows, (b + 1) * block);
+        const FlatForest& flat = local_flat();   // cópia do nó (modo NUMA)
+
+        auto add_tree = [&](int t, int i) {
+            double* acc = &output[(size_t)i * width];
+            const double* sample = X[i].data();
+            if (hard_votes) {
+                int pred = flat.empty() ? trees[t].predict_one(X[i])
+                                        : flat.predict_tree(t, sample);
+                if (pred >= 0 && pred < width) acc[pred] += 1.0;
+                return;
+            }
+            const float* leaf = flat.empty() ? trees[t].predict_leaf_output(sample)
+                                             : flat.leaf_output(flat.find_leaf(t, sample));
+            if (!leaf) return;
+            for (int j = 0; j < width; j++)
+                acc[j] += leaf[j];
+        };
+
+        // mesma ordem de travessia do predict (ver comentário lá)
+        if (flat.empty()) {
+            for (int t = 0; t < n_trees; t++)
+                for (int i = begin; i < end; i++)
+                    add_tree(t, i);
+        } else {
+            for (int i = begin; i < end; i++)
+                for (int t = 0; t < n_trees; t++)
+                    add_tree(t, i);
+        }
+
+        PERF_SCOPE(Vote);
+        double* first = &output[(size_t)begin * width];
+        double* last = &output[(size_t)end * width];
+        for (double* p = first; p != last; ++p)
+            *p *= inv_trees;
+    });
+
+    return output;
+}
+
+// ============================================================
+// Grade profundidade x árvores: blocos de linhas em paralelo; em cada
+// bloco, árvore por árvore, uma travessia por linha dá a classe em
+// todas as profundidades e os votos de todas as profundidades são
+// somados juntos. Ao completar um prefixo pedido, o bloco conta acertos.
+// ============================================================
+RandomForestOptimized::DepthGrid RandomForestOptimized::depth_grid(
+    const std::vector<std::vector<double>>& X,
+    const std::vector<int>& y,
+    const std::vector<int>& depths,
+    const std::vector<int>& tree_counts) const
+{
+    return depth_grid_impl(X, y, depths, tree_counts, false);
+}
+
+RandomForestOptimized::DepthGrid RandomForestOptimized::oob_depth_grid(
+    const std::vector<std::vector<double>>& X,
+    const std::vector<int>& y,
+    const std::vector<int>& depths,
+    const std::vector<int>& tree_counts) const
+{
+    return depth_grid_impl(X, y, depths, tree_counts, true);
+}
+
+RandomForestOptimized::DepthGrid RandomForestOptimized::depth_grid_impl(
+    const std::vector<std::vector<double>>& X,
+    const std::vector<int>& y,
+    const std::vector<int>& depths,
+    const std::vector<int>& tree_counts,
+    bool oob) const
+{
+    if (leaf_mode == LeafMode::Regression)
+        throw std::runtime_error("grade de acuracia so para classificacao");
+    if (trees.empty() || X.size() != y.size())
+        throw std::invalid_argument("grade exige floresta treinada e X/y do mesmo tamanho");
+
+    DepthGrid grid;
+    grid.depths = depths;
+    std::sort(grid.depths.begin(), grid.depths.end());
+    grid.depths.erase(std::unique(grid.depths.begin(), grid.depths.end()), grid.depths.end());
+    grid.tree_counts = tree_counts.empty() ? std::vector<int>{(int)trees.size()} : tree_counts;
+    std::sort(grid.tree_counts.begin(), grid.tree_counts.end());
+    grid.tree_counts.erase(std::unique(grid.tree_counts.begin(), grid.tree_counts.end()),
+                           grid.tree_counts.end());
+    if (grid.depths.empty() || grid.depths[0] < 0)
+        throw std::invalid_argument("profundidades da grade devem ser >= 0");
+    if (grid.tree_counts[0] < 1 || grid.tree_counts.back() > (int)trees.size())
+        throw std::invalid_argument("prefixos da grade fora de [1, " +
+                                    std::to_string(trees.size()) + "] arvores");
+
+    const int n_rows = X.size();
+    const int n_depths = grid.depths.size();
+    const int n_prefixes = grid.tree_counts.size();
+    const int max_d = grid.depths.back();
+    const int n_used_trees = grid.tree_counts.back();
+
+    // OOB: a linha é OOB da árvore t se cai no fim da janela rotacionada
+    // (mesma reconstrução do drop_trees_by_oob)
+    std::vector<int> position;
+    int n_in_bag = n_rows;
+    if (oob) {
+        if (tree_oob_offset.size() != trees.size() || (int)base_indices.size() != n_rows)
+            throw std::runtime_error("grade OOB exige o fit com OOB sobre este dataset");
+        position.resize(n_rows);
+        for (int p = 0; p < n_rows; p++) position[base_indices[p]] = p;
+        n_in_bag = std::max(1, n_rows - (int)(n_rows * oob_holdout));
+    }
+
+    std::vector<long long> correct((size_t)n_prefixes * n_depths, 0);
+    std::vector<long long> scored(n_prefixes, 0);
+    std::mutex merge_mutex;
+
+    const int block = 256;
+    const int n_blocks = (n_rows + block - 1) / block;
+    get_pool().parallel_for(n_blocks, [&](int b) {
+        const int begin = b * block;
+        const int end = std::min(n_rows, (b + 1) * block);
+        const int width = n_depths * num_classes;
+
+        std::vector<int> votes((size_t)(end - begin) * width, 0);
+        std::vector<char> has_vote(end - begin, 0);
+        std::vector<int> path(max_d + 1);
+        std::vector<int> counts(num_classes);
+        std::vector<long long> local_correct((size_t)n_prefixes * n_depths, 0);
+        std::vector<long long> local_scored(n_prefixes, 0);
+
+        int prefix = 0;
+        for (int t = 0; t < n_used_trees; t++) {
+            for (int i = begin; i < end; i++) {
+                if (oob && ((position[i] - tree_oob_offset[t] + n_rows) % n_rows) < n_in_bag)
+                    continue;
+                trees[t].predict_depths(X[i].data(), max_d, path.data());
+                int* v = &votes[(size_t)(i - begin) * width];
+                for (int k = 0; k < n_depths; k++) {
+                    const int c = path[grid.depths[k]];
+                    if (c >= 0 && c < num_classes) v[k * num_classes + c]++;
+                }
+                has_vote[i - begin] = 1;
+            }
+
+            if (t + 1 != grid.tree_counts[prefix]) continue;
+            for (int i = begin; i < end; i++) {
+                if (!has_vote[i - begin]) continue;
+                local_scored[prefix]++;
+                const int* v = &votes[(size_t)(i - begin) * width];
+                for (int k = 0; k < n_depths; k++) {
+                    std::copy(v + k * num_classes, v + (k + 1) * num_classes, counts.begin());
+                    if (majority_vote(counts) == y[i])
+                        local_correct[(size_t)prefix * n_depths + k]++;
+                }
+            }
+            prefix++;
+        }
+
+        std::lock_guard<std::mutex> lock(merge_mutex);
+        for (size_t k = 0; k < correct.size(); k++) correct[k] += local_correct[k];
+        for (int p = 0; p < n_prefixes; p++) scored[p] += local_scored[p];
+    });
+
+    grid.accuracy.resize(correct.size());
+    grid.scored_samples.resize(n_prefixes);
+    for (int p = 0; p < n_prefixes; p++) {
+        grid.scored_samples[p] = scored[p];
+        for (int k = 0; k < n_depths; k++)
+            grid.accuracy[(size_t)p * n_depths + k] =
+                scored[p] ? (double)correct[(size_t)p * n_depths + k] / scored[p] : 0.0;
+    }
+    return grid;
+}
+
+// ============================================================
+// Paralelismo (treino por árvore, predição por blocos de linhas)
+// ============================================================
+void RandomForestOptimized::set_num_threads(int n)
+{
+    n_threads = std::max(1, n);
+    own_pool.reset();
+}
+
+void RandomForestOptimized::set_thread_pool(ThreadPool* external_pool)
+{
+    shared_pool = external_pool;
+}
+
+ThreadPool& RandomForestOptimized::get_pool() const
+{
+    if (shared_pool) return *shared_pool;
+    // modo NUMA: thread i fixada no nó node_for_thread(i)
+    std::function<void(int)> pin;
+    if (numa_active())
+        pin = [this](int i) {
+            numa_topology.pin_current_thread(numa_topology.node_for_thread(i, n_threads));
+        };
+    return own_pool.get(n_threads, pin);
+}
+
+// ============================================================
+// NUMA: cópias do dataset e do modelo por nó
+// ============================================================
+void RandomForestOptimized::set_numa(bool enabled)
+{
+    numa = enabled;
+    if (numa && numa_topology.num_nodes() == 0)
+        numa_topology = NumaTopology::detect();
+    own_pool.reset();
+    X_col_replicas.clear();
+    presorted_replicas.clear();
+    replicate_model();
+}
+
+void RandomForestOptimized::set_numa_topology(const NumaTopology& topology)
+{
+    numa_topology = topology;
+    set_numa(numa);
+}
+
+// Thread do pool próprio: o nó em que foi fixada. Thread chamadora ou
+// pool externo: o nó da CPU atual.
+int RandomForestOptimized::current_numa_node() const
+{
+    if (!numa_active()) return 0;
+    const int worker = ThreadPool::current_worker();
+    if (worker == 0 || shared_pool) return numa_topology.current_node();
+    return numa_topology.node_for_thread(worker, n_threads);
+}
+
+// Cada cópia é alocada e preenchida por uma thread fixada no nó
+// (first touch), todas em paralelo
+void RandomForestOptimized::replicate_dataset(bool with_order)
+{
+    const int n_nodes = numa_topology.num_nodes();
+    if ((int)X_col_replicas.size() != n_nodes) {
+        X_col_replicas.assign(n_nodes, {});
+        numa_topology.run_on_each_node([&](int node) { X_col_replicas[node] = X_col_cache; });
+    }
+    if (with_order && (int)presorted_replicas.size() != n_nodes) {
+        presorted_replicas.assign(n_nodes, {});
+        numa_topology.run_on_each_node([&](int node) { presorted_replicas[node] = presorted_cache; });
+    }
+}
+
+// Modelo da predição por nó: a forma achatada (a de compact() ou uma
+// gerada das árvores atuais). Chamado a cada mudança nas árvores.
+void RandomForestOptimized::replicate_model()
+{
+    flat_replicas.clear();
+    if (!numa_active() || (trees.empty() && flat.empty())) return;
+
+    flat_replicas.resize(numa_topology.num_nodes());
+    numa_topology.run_on_each_node([&](int node) {
+        if (flat.empty()) flat_replicas[node].build(trees, flat_layout);
+        else              flat_replicas[node] = flat;
+    });
+}
+
+const FlatForest& RandomForestOptimized::local_flat() const
+{
+    return flat_replicas.empty() ? flat : flat_replicas[current_numa_node()];
+}
+
+size_t RandomForestOptimized::numa_replica_bytes() const
+{
+    size_t bytes = 0;
+    for (const auto& columns : X_col_replicas)
+        for (const auto& column : columns)
+            bytes += column.size() * sizeof(double);
+    for (const ColumnOrder& order : presorted_replicas)
+        for (const auto& column : order)
+            bytes += column.size() * sizeof(SortedEntry);
+    for (const FlatForest& replica : flat_replicas)
+        bytes += replica.memory_bytes();
+    return bytes;
+}
+
+// ============================================================
+// Early exit: o voto já está decidido?
+//  1) o líder não pode mais ser alcançado pelas árvores restantes; ou
+//  2) o líder já tem >= confidence dos votos avaliados (após min_trees)
+// ============================================================
+bool RandomForestOptimized::vote_is_decided(const std::vector<int>& counts,
+                                            int evaluated) const
+{
+    int leader = 0, second = 0;
+    for (int c : counts) {
+        if (c > leader) { second = leader; leader = c; }
+        else if (c > second) second = c;
+    }
+
+    const int remaining = n_trees - evaluated;
+    if (leader - second > remaining)
+        return true;
+
+    return early_exit_confidence < 1.0 &&
+           evaluated >= early_exit_min_trees &&
+           leader >= early_exit_confidence * evaluated;
+}
+
+void RandomForestOptimized::set_early_exit(bool enabled, double confidence, int min_trees)
+{
+    if (confidence <= 0.5 || confidence > 1.0)
+        throw std::invalid_argument("confianca do early exit deve estar em (0.5, 1]");
+
+    early_exit = enabled;
+    early_exit_confidence = confidence;
+    early_exit_min_trees = std::max(1, min_trees);
+}
+
+// ============================================================
+// Ordena as árvores pela acurácia OOB (melhores primeiro), para que o
+// early exit decida o voto com menos árvores. Deve ser chamado antes de
+// save_model; a ordem é persistida pelo próprio formato do modelo.
+// ============================================================
+bool RandomForestOptimized::order_trees_by_quality()
+{
+    if (tree_quality.size() != trees.size())
+        return false;
+
+    std::vector<int> order(trees.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return tree_quality[a] > tree_quality[b];
+    });
+
+    std::vector<DecisionTree> sorted;
+    std::vector<double> sorted_quality;
+    std::vector<int> sorted_offset;
+    sorted.reserve(trees.size());
+    sorted_quality.reserve(trees.size());
+    sorted_offset.reserve(trees.size());
+    for (int t : order) {
+        sorted.emplace_back(std::move(trees[t]));
+        sorted_quality.push_back(tree_quality[t]);
+        sorted_offset.push_back(tree_oob_offset[t]);
+    }
+
+    trees = std::move(sorted);
+    tree_quality = std::move(sorted_quality);
+    tree_oob_offset = std::move(sorted_offset);
+    flat.clear();
+    replicate_model();
+    return true;
+}
+
+// ============================================================
+// Compactação pós-treino
+//  1) (opcional) remove árvores cuja retirada não reduz os acertos OOB
+//  2) colapsa subárvores redundantes em cada árvore
+//  3) gera a forma achatada com folhas deduplicadas, usada no predict
+// ============================================================
+RandomForestOptimized::CompactionReport RandomForestOptimized::compact()
+{
+    return compact_impl(nullptr, nullptr, false);
+}
+
+RandomForestOptimized::CompactionReport RandomForestOptimized::compact(
+    const std::vector<std::vector<double>>& X,
+    const std::vector<int>& y,
+    bool drop_redundant_trees)
+{
+    return compact_impl(&X, &y, drop_redundant_trees);
+}
+
+RandomForestOptimized::CompactionReport RandomForestOptimized::compact_impl(
+    const std::vector<std::vector<double>>* X,
+    const std::vector<int>* y,
+    bool drop_redundant_trees)
+{
+    CompactionReport report;
+    if (is_inference_only()) {
+        // modelo compacto: a forma achatada já é a única representação
+        report.trees_before = report.trees_after = flat.get_num_trees();
+        report.flat_nodes = flat.get_num_nodes();
+        report.flat_bytes = flat.memory_bytes();
+        return report;
+    }
+    report.trees_before = trees.size();
+    report.model_bytes_before = serialized_size();
+    for (const auto& tree : trees)
+        report.nodes_before += tree.count_nodes();
+
+    if (drop_redundant_trees && X && y)
+        report.oob_trees_checked = drop_trees_by_oob(*X, *y);
+
+    for (auto& tree : trees)
+        tree.compact();
+    flat.build(trees, flat_layout);
+    replicate_model();
+
+    report.trees_after = trees.size();
+    report.model_bytes_after = serialized_size();
+    for (const auto& tree : trees)
+        report.nodes_after += tree.count_nodes();
+    report.flat_nodes = flat.get_num_nodes();
+    report.flat_bytes = flat.memory_bytes();
+    return report;
+}
+
+// ============================================================
+// Remoção gulosa de árvores (piores primeiro) usando os votos OOB
+// acumulados no fit: uma árvore sai se, ao retirar seus votos da sua
+// janela OOB, o número de acertos OOB não diminui. Retorna false se
+// não houver estado OOB do fit para este dataset.
+// ============================================================
+bool RandomForestOptimized::drop_trees_by_oob(const std::vector<std::vector<double>>& X,
+                                              const std::vector<int>& y)
+{
+    const int n_samples = X.size();
+    if (tree_quality.size() != trees.size() ||
+        oob_votes.size() != (size_t)n_samples * oob_num_classes ||
+        (int)base_indices.size() != n_samples)
+        return false;
+
+    const int n_oob = (int)(n_samples * oob_holdout);
+    const int n_in_bag = std::max(1, n_samples - n_oob);
+
+    auto row_correct = [&](int row) {
+        const int* votes = &oob_votes[(size_t)row * oob_num_classes];
+        int best_class = -1, best_count = 0;
+        for (int c = 0; c < oob_num_classes; c++)
+            if (votes[c] > best_count) { best_count = votes[c]; best_class = c; }
+        return best_class == y[row] ? 1 : 0;
+    };
+
+    std::vector<int> order(trees.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return tree_quality[a] < tree_quality[b];
+    });
+
+    std::vector<char> keep(trees.size(), 1);
+    int kept = trees.size();
+    std::vector<int> rows, preds;
+
+    for (int t : order) {
+        if (kept <= 1) break;
+
+        make_cache_friendly_indices(n_samples, tree_oob_offset[t], temp_indices);
+        rows.assign(temp_indices.begin() + n_in_bag, temp_indices.end());
+        preds.resize(rows.size());
+
+        int delta = 0;
+        for (size_t i = 0; i < rows.size(); i++) {
+            preds[i] = trees[t].predict_one(X[rows[i]]);
+            if (preds[i] < 0 || preds[i] >= oob_num_classes) continue;
+            int before = row_correct(rows[i]);
+            oob_votes[(size_t)rows[i] * oob_num_classes + preds[i]]--;
+            delta += row_correct(rows[i]) - before;
+        }
+
+        if (delta >= 0) {
+            keep[t] = 0;
+            kept--;
+        } else {
+            for (size_t i = 0; i < rows.size(); i++)
+                if (preds[i] >= 0 && preds[i] < oob_num_classes)
+                    oob_votes[(size_t)rows[i] * oob_num_classes + preds[i]]++;
+        }
+    }
+
+    std::vector<DecisionTree> kept_trees;
+    std::vector<double> kept_quality;
+    std::vector<int> kept_offset;
+    for (size_t t = 0; t < trees.size(); t++) {
+        if (!keep[t]) continue;
+        kept_trees.emplace_back(std::move(trees[t]));
+        kept_quality.push_back(tree_quality[t]);
+        kept_offset.push_back(tree_oob_offset[t]);
+    }
+    trees = std::move(kept_trees);
+    tree_quality = std::move(kept_quality);
+    tree_oob_offset = std::move(kept_offset);
+    n_trees = trees.size();
+
+    finalize_oob(y);
+    return true;
+}
+
+// Tamanho do modelo no formato de save_model
+size_t RandomForestOptimized::serialized_size() const
+{
+    std::ostringstream out(std::ios::binary);
+    for (const auto& tree : trees)
+        tree.save_model(out);
+    return 4 * sizeof(int) + out.str().size();
+}
+
 // ============================================================
 // Salvamento do modelo completo
 // ============================================================
-void RandomForestOptimized::save_model(const std::string& filename) const
+void RandomForestOptimized::save_model(const std::string& filename, bool append) const
 {
+    if (append) {
+        append_model(filename);
+        return;
+    }
+
     std::ofstream out(filename, std::ios::binary);
     if (!out)
         throw std::runtime_error("Erro ao abrir arquivo de modelo otimizado para escrita.");
+    save_model(out);
+}
 
+void RandomForestOptimized::save_model(std::ostream& out) const
+{
+    require_trees("save_model");
     // hiperparâmetros
     out.write(reinterpret_cast<const char*>(&n_trees), sizeof(n_trees));
     out.write(reinterpret_cast<const char*>(&max_depth), sizeof(max_depth));
@@ -139,6 +1211,58 @@ void RandomForestOptimized::save_model(const std::string& filename) const
         tree.save_model(out);
 }
 
+// ============================================================
+// Acrescentar ao modelo existente: grava só as árvores que o arquivo
+// ainda não tem e reescreve n_trees no cabeçalho
+// ============================================================
+void RandomForestOptimized::append_model(const std::string& filename) const
+{
+    require_trees("save_model");
+    std::fstream file(filename, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file)
+        throw std::runtime_error("Erro ao abrir arquivo de modelo otimizado para acrescentar.");
+
+    int file_trees = 0, file_depth = 0, file_min_split = 0, file_chunk = 0;
+    file.read(reinterpret_cast<char*>(&file_trees), sizeof(file_trees));
+    file.read(reinterpret_cast<char*>(&file_depth), sizeof(file_depth));
+    file.read(reinterpret_cast<char*>(&file_min_split), sizeof(file_min_split));
+    file.read(reinterpret_cast<char*>(&file_chunk), sizeof(file_chunk));
+    if (!file)
+        throw std::runtime_error("Cabecalho de modelo invalido: " + filename);
+
+    if (file_depth != max_depth || file_min_split != min_samples_split ||
+        file_chunk != chunk_size)
+        throw std::runtime_error("Hiperparametros do modelo em disco diferem da floresta.");
+    if (file_trees > (int)trees.size())
+        throw std::runtime_error("Modelo em disco tem mais arvores que a floresta.");
+
+    // as árvores do arquivo precisam ser exatamente as primeiras desta
+    // floresta (byte a byte), sem nada depois delas
+    std::ostringstream prefix(std::ios::binary);
+    for (int t = 0; t < file_trees; t++)
+        trees[t].save_model(prefix);
+    const std::string expected = prefix.str();
+    const std::streampos trees_begin = file.tellg();
+    std::string on_disk(expected.size(), '\0');
+    file.read(&on_disk[0], on_disk.size());
+    const bool same_prefix = file && on_disk == expected && file.peek() == EOF;
+    file.clear();
+    if (!same_prefix)
+        throw std::runtime_error("Arvores do modelo em disco nao sao o inicio desta floresta.");
+
+    // novas árvores no fim do arquivo
+    file.seekp(trees_begin + (std::streamoff)expected.size());
+    for (size_t t = file_trees; t < trees.size(); t++)
+        trees[t].save_model(file);
+
+    // novo total no cabeçalho
+    int total = trees.size();
+    file.seekp(0, std::ios::beg);
+    file.write(reinterpret_cast<const char*>(&total), sizeof(total));
+    if (!file)
+        throw std::runtime_error("Erro ao acrescentar arvores em: " + filename);
+}
+
 // ============================================================
 // Carregamento do modelo completo
 // ============================================================
@@ -147,6 +1271,15 @@ void RandomForestOptimized::load_model(const std::string& filename)
     std::ifstream in(filename, std::ios::binary);
     if (!in)
         throw std::runtime_error("Erro ao abrir arquivo de modelo otimizado para leitura.");
+    load_model(in);
+}
+
+void RandomForestOptimized::load_model(std::istream& in)
+{
+    if (CompactModel::is_compact(in)) {
+        load_compact_model(in);
+        return;
+    }
 
     // hiperparâmetros
     in.read(reinterpret_cast<char*>(&n_trees), sizeof(n_trees));
@@ -154,14 +1287,160 @@ void RandomForestOptimized::load_model(const std::string& filename)
     in.read(reinterpret_cast<char*>(&min_samples_split), sizeof(min_samples_split));
     in.read(reinterpret_cast<char*>(&chunk_size), sizeof(chunk_size));
 
+    clear_training_state();
+
     // recriar floresta
+    flat.clear();
     trees.clear();
     trees.reserve(n_trees);
 
+    num_classes = 0;
     for (int t = 0; t < n_trees; t++)
     {
         DecisionTree tree(max_depth, min_samples_split, chunk_size);
         tree.load_model(in);
+        num_classes = std::max(num_classes, tree.get_num_classes());
         trees.emplace_back(std::move(tree)); // ← movimento, não cópia
     }
+    leaf_mode = trees.empty() ? LeafMode::Class : trees[0].get_leaf_mode();
+    replicate_model();
+}
+
+void RandomForestOptimized::set_trees(std::vector<DecisionTree> new_trees)
+{
+    clear_training_state();
+    flat.clear();
+    trees = std::move(new_trees);
+    n_trees = trees.size();
+
+    num_classes = 0;
+    for (const auto& tree : trees)
+        num_classes = std::max(num_classes, tree.get_num_classes());
+    leaf_mode = trees.empty() ? LeafMode::Class : trees[0].get_leaf_mode();
+    replicate_model();
+}
+
+void RandomForestOptimized::clear_training_state()
+{
+    // votos OOB e importância não pertencem ao modelo carregado
+    importance_sum.clear();
+    split_counts.clear();
+    tree_quality.clear();
+    tree_oob_offset.clear();
+    oob_votes.clear();
+    oob_class_error.clear();
+    oob_accuracy = 0.0;
+    oob_scored_samples = 0;
+}
+
+// ============================================================
+// Formato compacto: grava a forma achatada (a atual ou uma gerada das
+// árvores) e carrega só ela
+// ============================================================
+void RandomForestOptimized::save_compact_model(const std::string& filename) const
+{
+    std::ofstream out(filename, std::ios::binary);
+    if (!out)
+        throw std::runtime_error("Erro ao abrir arquivo de modelo compacto para escrita.");
+    save_compact_model(out);
+}
+
+void RandomForestOptimized::save_compact_model(std::ostream& out) const
+{
+    if (!flat.empty()) {
+        CompactModel::write(flat, num_classes, leaf_mode, out);
+        return;
+    }
+    FlatForest generated;
+    generated.build(trees);
+    CompactModel::write(generated, num_classes, leaf_mode, out);
+}
+
+void RandomForestOptimized::load_compact_model(std::istream& in)
+{
+    clear_training_state();
+    trees.clear();
+
+    CompactModel::read(in, flat, num_classes, leaf_mode);
+    n_trees = flat.get_num_trees();
+    replicate_model();
+}
+
+void RandomForestOptimized::require_trees(const char* operation) const
+{
+    if (is_inference_only())
+        throw std::runtime_error(std::string(operation) +
+                                 " exige as arvores; o modelo compacto carregado e so de inferencia");
+}
+
+// ============================================================
+// Junção de modelos (faixas treinadas em processos separados)
+// ============================================================
+int RandomForestOptimized::merge_models(const std::vector<std::istream*>& inputs, std::ostream& out)
+{
+    if (inputs.empty())
+        throw std::invalid_argument("nenhum modelo para juntar");
+
+    // cabeçalho com total provisório; reescrito no fim
+    int header[4] = {0, 0, 0, 0};     // n_trees, max_depth, min_samples_split, chunk_size
+    const std::streampos header_pos = out.tellp();
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+    int total = 0;
+    bool have_mode = false;
+    LeafMode mode = LeafMode::Class;
+    for (size_t k = 0; k < inputs.size(); k++) {
+        std::istream& in = *inputs[k];
+        int part[4];
+        in.read(reinterpret_cast<char*>(part), sizeof(part));
+        if (!in || part[0] < 0)
+            throw std::runtime_error("Cabecalho de modelo invalido na entrada " + std::to_string(k));
+        if (k == 0) {
+            std::copy(part + 1, part + 4, header + 1);
+        } else if (part[1] != header[1] || part[2] != header[2] || part[3] != header[3]) {
+            throw std::runtime_error("Hiperparametros da entrada " + std::to_string(k) +
+                                     " diferem da primeira");
+        }
+
+        for (int t = 0; t < part[0]; t++) {
+            DecisionTree tree(part[1], part[2], part[3]);
+            tree.load_model(in);
+            if (!in)
+                throw std::runtime_error("Modelo truncado na entrada " + std::to_string(k));
+            if (have_mode && tree.get_leaf_mode() != mode)
+                throw std::runtime_error("Tipo de folha da entrada " + std::to_string(k) +
+                                         " difere das anteriores");
+            mode = tree.get_leaf_mode();
+            have_mode = true;
+            tree.save_model(out);
+        }
+        total += part[0];
+    }
+
+    header[0] = total;
+    const std::streampos end_pos = out.tellp();
+    out.seekp(header_pos);
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.seekp(end_pos);
+    if (!out)
+        throw std::runtime_error("Erro ao gravar o modelo combinado");
+    return total;
+}
+
+int RandomForestOptimized::merge_models(const std::vector<std::string>& inputs, const std::string& output)
+{
+    std::vector<std::ifstream> files;
+    std::vector<std::istream*> streams;
+    files.reserve(inputs.size());
+    for (const std::string& path : inputs) {
+        files.emplace_back(path, std::ios::binary);
+        if (!files.back())
+            throw std::runtime_error("Erro ao abrir modelo para juntar: " + path);
+    }
+    for (auto& file : files) streams.push_back(&file);
+
+    std::ofstream out(output, std::ios::binary);
+    if (!out)
+        throw std::runtime_error("Erro ao abrir arquivo de modelo otimizado para escrita.");
+    return merge_models(streams, out);
 }
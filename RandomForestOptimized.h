@@ -4,6 +4,12 @@
 #include <vector>
 #include <string>
 #include "DecisionTree.h"
+#include "TrainingTrace.h"
+#include "FlatForest.h"
+#include "ThreadPool.h"
+#include "NumaTopology.h"
+#include <memory>
+#include <mutex>
 
 // ------------------------------------------------------------
 // RandomForestOptimized
@@ -11,6 +17,8 @@
 // ------------------------------------------------------------
 class RandomForestOptimized {
 public:
+    using LeafMode = DecisionTree::LeafMode;
+
     RandomForestOptimized(int n_trees = 10,
                           int max_depth = 10,
                           int min_samples_split = 2,
@@ -20,12 +28,240 @@ public:
     void fit(const std::vector<std::vector<double>>& X,
              const std::vector<int>& y);
 
+    // Regressão (critério MSE): folhas guardam a média do alvo e a
+    // floresta prediz a média das árvores (sem OOB)
+    void fit_regression(const std::vector<std::vector<double>>& X,
+                        const std::vector<double>& y);
+
+    // Treino só nas linhas `rows` de um dataset column-major externo,
+    // sem copiá-lo (ex: folds de validação cruzada sobre um único
+    // dataset). y é indexado pelas mesmas linhas. Crescimento por nível
+    // só com a pré-ordenação do dataset inteiro em `presorted` (senão,
+    // recursivo). Sem OOB.
+    void fit_rows(const std::vector<std::vector<double>>& X_col,
+                  const std::vector<int>& y,
+                  const std::vector<int>& rows,
+                  const ColumnOrder* presorted = nullptr);
+
+    // Warm start: acrescenta n_new_trees árvores (sementes novas) a uma
+    // floresta já treinada ou carregada. Reaproveita o cache column-major
+    // do último treino (ver set_keep_dataset_cache) só quando X tem a
+    // mesma forma e o mesmo conteúdo (checksum); senão, refaz o cache.
+    void grow(const std::vector<std::vector<double>>& X,
+              const std::vector<int>& y,
+              int n_new_trees);
+
+    // Mantém o cache column-major (e a pré-ordenação) após o treino para
+    // o próximo grow. Desligado (padrão): o cache é liberado ao fim de
+    // cada fit/grow, sem dobrar a memória do dataset.
+    void set_keep_dataset_cache(bool keep) { keep_dataset_cache = keep; }
+
+    // Libera o cache column-major mantido para o warm start
+    void clear_dataset_cache();
+
+    // Semente da floresta (cada árvore deriva a sua a partir dela)
+    void set_seed(unsigned int s)      { seed = s; }
+    unsigned int get_seed() const      { return seed; }
+
+    // Treino por faixas (vários processos): os próximos fits treinam só
+    // as árvores [first_tree, first_tree + n_trees) de uma floresta de
+    // forest_trees árvores, com as mesmas sementes e janelas que o treino
+    // num só processo. Concatenar as faixas em ordem (merge_models) dá a
+    // mesma floresta. forest_trees = 0 desliga. Sem OOB nem warm start.
+    void set_tree_range(int first_tree, int forest_trees);
+
+    // Telemetria por árvore/nível dos próximos treinos (nullptr desliga)
+    void set_training_trace(TrainingTrace* trace) { training_trace = trace; }
+
+    // Colunas categóricas (códigos inteiros em [0, 64)): splits por
+    // agrupamento de categorias em vez de threshold
+    void set_categorical_features(const std::vector<int>& columns) { categorical_columns = columns; }
+    const std::vector<int>& get_categorical_features() const     { return categorical_columns; }
+
+    // Folhas com distribuição de classes nos próximos fits (probabilidades
+    // calibradas pela média das distribuições, em vez da fração de votos)
+    void set_probability_leaves(bool enabled) { probability_leaves = enabled; }
+    LeafMode get_leaf_mode() const            { return leaf_mode; }
+    bool is_regression() const                { return leaf_mode == LeafMode::Regression; }
+
+    // ExtraTrees: thresholds sorteados entre min e max de cada feature
+    // no nó, sem ordenar (treino bem mais rápido, árvores mais variadas)
+    void set_extra_trees(bool enabled)  { extra_trees = enabled; }
+    bool get_extra_trees() const        { return extra_trees; }
+
+    // Crescimento por nível: as colunas são pré-ordenadas uma vez por
+    // dataset (junto do cache column-major) e compartilhadas entre as
+    // árvores. Com colunas categóricas ou ExtraTrees, fica o recursivo.
+    void set_level_wise(bool enabled)   { level_wise = enabled; }
+    bool get_level_wise() const         { return level_wise; }
+
+    // Importância das features nas árvores treinadas desde o último fit
+    // (soma das reduções de impureza de cada árvore, normalizada para
+    // somar 1) e número de splits por feature. Vazia para modelo carregado.
+    std::vector<double> get_feature_importance() const;
+    const std::vector<long long>& get_split_counts() const { return split_counts; }
+
+    // Features usadas em algum split, em ordem crescente
+    std::vector<int> get_used_features() const;
+    // Passa a predizer sobre linhas só com as colunas `columns` (índices
+    // do dataset original, em ordem crescente), como as carregadas pelo
+    // DataLoader com seleção de colunas. Lança invalid_argument se o
+    // modelo usar uma coluna fora da lista.
+    void select_features(const std::vector<int>& columns);
+
     // Predição
     std::vector<int> predict(const std::vector<std::vector<double>>& X) const;
 
+    // Predição das linhas `rows` de um dataset column-major (cada linha é
+    // montada num buffer da thread; sem early exit)
+    std::vector<int> predict_rows(const std::vector<std::vector<double>>& X_col,
+                                  const std::vector<int>& rows) const;
+
+    // Probabilidades por classe, n_linhas x num_classes (row-major): média
+    // das distribuições das folhas; no modo Class, fração dos votos
+    std::vector<double> predict_proba(const std::vector<std::vector<double>>& X) const;
+    // Média das folhas de regressão
+    std::vector<double> predict_regression(const std::vector<std::vector<double>>& X) const;
+
+    // --------------------------------------------------------
+    // Grade de acurácia por profundidade x número de árvores, numa só
+    // passada pelas árvores já treinadas: a floresta truncada na
+    // profundidade d prediz pela classe majoritária do nó do caminho
+    // nessa profundidade, e os prefixos de tree_counts árvores são
+    // avaliados à medida que as árvores são somadas. Com crescimento por
+    // nível (sementes por nó) a árvore truncada é exatamente a árvore
+    // treinada com max_depth = d; no recursivo é uma aproximação.
+    // tree_counts vazio = só a floresta inteira. Só classificação.
+    // --------------------------------------------------------
+    struct DepthGrid {
+        std::vector<int> depths;
+        std::vector<int> tree_counts;
+        std::vector<double> accuracy;      // tree_counts.size() x depths.size()
+        std::vector<int> scored_samples;   // por prefixo (OOB: amostras com voto)
+        double at(size_t tree_index, size_t depth_index) const {
+            return accuracy[tree_index * depths.size() + depth_index];
+        }
+    };
+    // Acurácia em um conjunto de validação
+    DepthGrid depth_grid(const std::vector<std::vector<double>>& X,
+                         const std::vector<int>& y,
+                         const std::vector<int>& depths,
+                         const std::vector<int>& tree_counts = {}) const;
+    // Acurácia OOB (exige o fit com OOB sobre este mesmo X/y)
+    DepthGrid oob_depth_grid(const std::vector<std::vector<double>>& X,
+                             const std::vector<int>& y,
+                             const std::vector<int>& depths,
+                             const std::vector<int>& tree_counts = {}) const;
+
+    // --------------------------------------------------------
+    // Out-of-bag: a rotação cobre todas as amostras, então com OOB
+    // ligado cada árvore treina só nas primeiras (1 - holdout) posições
+    // da sua janela rotacionada; as demais (contíguas na ordem base)
+    // são votadas por ela logo após o treino.
+    // --------------------------------------------------------
+    void set_oob_score(bool enabled, double holdout_fraction = 0.368);
+    bool has_oob_score() const         { return oob_scored_samples > 0; }
+    double get_oob_accuracy() const    { return oob_accuracy; }
+    int get_oob_scored_samples() const { return oob_scored_samples; }
+    // Erro OOB por classe (fração de amostras da classe c classificadas errado)
+    const std::vector<double>& get_oob_class_error() const { return oob_class_error; }
+
+    // Threads de treino (uma árvore por tarefa) e de predição (blocos de
+    // linhas). O resultado não depende do número de threads. Um pool
+    // externo pode ser compartilhado entre várias florestas.
+    void set_num_threads(int n);
+    void set_thread_pool(ThreadPool* pool);
+    int get_num_threads() const        { return shared_pool ? shared_pool->size() : n_threads; }
+
+    // --------------------------------------------------------
+    // Modo NUMA: as threads do pool próprio são fixadas por nó (blocos
+    // contíguos de threads), o cache column-major e a pré-ordenação
+    // ganham uma cópia em cada nó no treino, e o modelo achatado ganha
+    // uma cópia por nó para a predição. Cada tarefa lê a cópia do nó em
+    // que roda. Numa máquina de um nó não muda nada. set_numa_topology
+    // troca a topologia detectada (ex: NumaTopology::uniform para testes).
+    // --------------------------------------------------------
+    void set_numa(bool enabled);
+    void set_numa_topology(const NumaTopology& topology);
+    bool numa_active() const                     { return numa && numa_topology.is_numa(); }
+    const NumaTopology& get_numa_topology() const { return numa_topology; }
+    // Bytes das cópias por nó (dataset + pré-ordenação + modelo)
+    size_t numa_replica_bytes() const;
+
+    // --------------------------------------------------------
+    // Early exit na predição: para de avaliar árvores quando o líder
+    // não pode mais ser alcançado pelas árvores restantes ou, se
+    // confidence < 1, quando o líder já tem essa fração dos votos
+    // avaliados (após min_trees árvores).
+    // --------------------------------------------------------
+    void set_early_exit(bool enabled, double confidence = 1.0, int min_trees = 5);
+    // Média de árvores avaliadas por amostra no último predict com early
+    // exit (sem early exit, todas as árvores)
+    double get_avg_trees_evaluated() const {
+        return early_exit ? last_avg_trees_evaluated : n_trees;
+    }
+
+    // Ordena as árvores pela acurácia OOB individual (exige fit com OOB),
+    // para que o early exit decida mais cedo. Retorna false se não houver
+    // métrica disponível (ex: modelo carregado ou fit sem OOB).
+    bool order_trees_by_quality();
+
+    // --------------------------------------------------------
+    // Compactação pós-treino: colapsa subárvores redundantes e passa a
+    // predizer pela forma achatada (folhas deduplicadas). A versão com
+    // dataset pode também remover árvores que não alteram os acertos
+    // OOB (exige o fit com OOB sobre o mesmo X/y).
+    // --------------------------------------------------------
+    struct CompactionReport {
+        int trees_before = 0;
+        int trees_after = 0;
+        long long nodes_before = 0;      // nós da árvore (folhas incluídas)
+        long long nodes_after = 0;
+        size_t flat_nodes = 0;           // nós internos na forma achatada
+        size_t flat_bytes = 0;
+        size_t model_bytes_before = 0;   // tamanho serializado
+        size_t model_bytes_after = 0;
+        bool oob_trees_checked = false;  // remoção por OOB foi aplicada
+    };
+    CompactionReport compact();
+    CompactionReport compact(const std::vector<std::vector<double>>& X,
+                             const std::vector<int>& y,
+                             bool drop_redundant_trees);
+    // Ordem dos nós na forma achatada (vale a partir do próximo
+    // compact()); Profiled usa as frequências de cada nó no treino
+    void set_flat_layout(FlatForest::Layout layout) { flat_layout = layout; }
+    FlatForest::Layout get_flat_layout() const      { return flat_layout; }
+    bool is_compacted() const          { return !flat.empty(); }
+    const FlatForest& get_flat() const { return flat; }
+    int get_num_classes() const        { return num_classes; }
+
     // Serialização binária do modelo inteiro
-    void save_model(const std::string& filename) const;
+    // append = true: acrescenta ao arquivo só as árvores que ele ainda
+    // não tem e reescreve n_trees no cabeçalho
+    void save_model(const std::string& filename, bool append = false) const;
     void load_model(const std::string& filename);
+    void save_model(std::ostream& out) const;
+    void load_model(std::istream& in);
+
+    // Formato compacto (ver CompactModel): só a forma achatada, com
+    // dicionários e varints. load_model reconhece os dois formatos; o
+    // modelo compacto carregado é somente de inferência (sem árvores de
+    // ponteiros: não aceita grow, select_features nem save_model).
+    void save_compact_model(const std::string& filename) const;
+    void save_compact_model(std::ostream& out) const;
+    bool is_inference_only() const     { return trees.empty() && !flat.empty(); }
+
+    // Floresta montada de árvores externas (ex: floresta online): troca
+    // as árvores como um load_model. Árvores de ponteiros, para leitura.
+    void set_trees(std::vector<DecisionTree> new_trees);
+    const DecisionTree& get_tree(int t) const { return trees[t]; }
+
+    // Junta modelos com os mesmos hiperparâmetros e tipo de folha: as
+    // árvores são concatenadas na ordem das entradas e n_trees é
+    // reescrito no cabeçalho. Cada árvore é carregada (validada) e
+    // regravada, uma por vez. Retorna o total de árvores.
+    static int merge_models(const std::vector<std::istream*>& inputs, std::ostream& out);
+    static int merge_models(const std::vector<std::string>& inputs, const std::string& output);
 
     // Getters
     int get_num_trees() const          { return n_trees; }
@@ -38,21 +274,127 @@ private:
     int max_depth;
     int min_samples_split;
     int chunk_size;
+    unsigned int seed;
+    // Faixa de árvores deste processo (ver set_tree_range)
+    int range_first_tree = 0;
+    int range_forest_trees = 0;
 
     std::vector<DecisionTree> trees;
 
+    // Dataset transposto uma vez por fit (compartilhado entre árvores)
+    std::vector<std::vector<double>> X_col_cache;
+    uint64_t X_col_checksum = 0;     // DataLoader::checksum do X do cache
+    bool keep_dataset_cache = false;
+    // Colunas pré-ordenadas do cache (só com crescimento por nível)
+    ColumnOrder presorted_cache;
+
     // Buffers auxiliares
     std::vector<int> base_indices;
     std::vector<int> temp_indices;
-    mutable std::vector<int> vote_buffer;
+    int num_classes = 0;
+
+    // Paralelismo: pool próprio (n_threads) ou compartilhado externo
+    int n_threads = 1;
+    mutable LazyThreadPool own_pool;
+    ThreadPool* shared_pool = nullptr;
+
+    // NUMA: cópias por nó (vazias fora do modo NUMA)
+    bool numa = false;
+    NumaTopology numa_topology;
+    std::vector<std::vector<std::vector<double>>> X_col_replicas;
+    std::vector<ColumnOrder> presorted_replicas;
+    std::vector<FlatForest> flat_replicas;
+
+    TrainingTrace* training_trace = nullptr;
+    std::vector<int> categorical_columns;
+
+    // Saída das folhas (modo das árvores atuais) e opção dos próximos fits
+    bool probability_leaves = false;
+    bool extra_trees = false;
+    bool level_wise = false;
+    LeafMode leaf_mode = LeafMode::Class;
+
+    // Early exit
+    bool early_exit = false;
+    double early_exit_confidence = 1.0;
+    int early_exit_min_trees = 5;
+    mutable double last_avg_trees_evaluated = 0.0;
+
+    // Importância acumulada (cada árvore soma a sua durante o treino;
+    // a floresta junta ao fim do treino paralelo)
+    std::vector<double> importance_sum;
+    std::vector<long long> split_counts;
+
+    // Acurácia OOB individual de cada árvore (qualidade para ordenação)
+    // e deslocamento da sua janela rotacionada (reconstrói as linhas OOB)
+    std::vector<double> tree_quality;
+    std::vector<int> tree_oob_offset;
+
+    // Forma achatada para inferência (gerada por compact())
+    FlatForest flat;
+    FlatForest::Layout flat_layout = FlatForest::Layout::Preorder;
+
+    // Estado OOB (votos n_samples x n_classes acumulados por árvore)
+    bool compute_oob = false;
+    double oob_holdout = 0.368;
+    int oob_num_classes = 0;
+    std::vector<int> oob_votes;
+    uint64_t oob_checksum = 0;       // DataLoader::checksum(X, y) dos votos
+    double oob_accuracy = 0.0;
+    int oob_scored_samples = 0;
+    std::vector<double> oob_class_error;
 
     // Auxiliares internos
-    void init_base_indices(int n_samples);
+    unsigned int tree_seed(int tree_id) const;
+    void init_base_indices(int n_samples, const std::vector<int>* rows = nullptr);
+    void build_column_cache(const std::vector<std::vector<double>>& X);
+    bool column_cache_matches(const std::vector<std::vector<double>>& X) const;
+    void reset_training_state();
+    void train_trees(const std::vector<std::vector<double>>* X,
+                     const std::vector<std::vector<double>>& columns,
+                     const ColumnOrder* presorted,
+                     const std::vector<int>& y,
+                     int n_total,
+                     const std::vector<double>* targets = nullptr);
+    void append_model(const std::string& filename) const;
+    void load_compact_model(std::istream& in);
+    void require_trees(const char* operation) const;
+    int window_offset(int n_samples, int tree_id) const;
     void make_cache_friendly_indices(int n_samples,
-                                     int tree_id,
+                                     int offset,
                                      std::vector<int>& out_indices) const;
 
-    int majority_vote(const std::vector<int>& votes) const;
+    int majority_vote(const std::vector<int>& counts) const;
+    // Soma das saídas das folhas (width por linha) dividida por n_trees
+    std::vector<double> predict_leaf_average(const std::vector<std::vector<double>>& X,
+                                             int width) const;
+    bool vote_is_decided(const std::vector<int>& counts, int evaluated) const;
+    ThreadPool& get_pool() const;
+    // Descarta OOB e importância (não pertencem a modelo carregado/montado)
+    void clear_training_state();
+    int current_numa_node() const;
+    void replicate_dataset(bool with_order);
+    void replicate_model();
+    const FlatForest& local_flat() const;
+
+    double accumulate_oob_votes(const DecisionTree& tree,
+                                const std::vector<std::vector<double>>& X,
+                                const std::vector<int>& y,
+                                const std::vector<int>& oob_rows,
+                                std::mutex& votes_mutex);
+    void finalize_oob(const std::vector<int>& y);
+
+    CompactionReport compact_impl(const std::vector<std::vector<double>>* X,
+                                  const std::vector<int>* y,
+                                  bool drop_redundant_trees);
+    bool drop_trees_by_oob(const std::vector<std::vector<double>>& X,
+                           const std::vector<int>& y);
+    size_t serialized_size() const;
+    DepthGrid depth_grid_impl(const std::vector<std::vector<double>>& X,
+                              const std::vector<int>& y,
+                              const std::vector<int>& depths,
+                              const std::vector<int>& tree_counts,
+                              bool oob) const;
 };
 
 #endif // RANDOM_FOREST_OPTIMIZED_H
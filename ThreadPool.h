@@ -0,0 +1,183 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ------------------------------------------------------------
+// ThreadPool
+// Pool fixo de threads com parallel_for em lotes. A thread que chama
+// parallel_for também executa itens do próprio lote, então chamadas
+// aninhadas (ex: folds de CV que treinam florestas no mesmo pool) não
+// travam: quem espera sempre consegue progredir no seu lote.
+// Uma exceção num item é guardada no lote (a primeira), os itens ainda
+// não iniciados são pulados e parallel_for a relança na thread chamadora
+// depois que todas as threads saíram do lote.
+// ------------------------------------------------------------
+class ThreadPool {
+public:
+    // n_threads = concorrência total (inclui a thread chamadora).
+    // on_start(i), se dado, roda em cada thread i >= 1 antes do primeiro
+    // item (ex: fixar a thread num nó NUMA)
+    explicit ThreadPool(int n_threads = 1,
+                        std::function<void(int)> on_start = nullptr) {
+        if (n_threads < 1) n_threads = 1;
+        for (int i = 1; i < n_threads; i++)
+            workers.emplace_back([this, i, on_start] {
+                if (on_start) on_start(i);
+                worker_loop(i);
+            });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& w : workers) w.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return workers.size() + 1; }
+
+    // Índice da thread atual no pool (0 = thread externa/chamadora)
+    static int current_worker() { return worker_id(); }
+
+    static int hardware_threads() {
+        unsigned int n = std::thread::hardware_concurrency();
+        return n > 0 ? (int)n : 1;
+    }
+
+    // Executa fn(i) para i em [0, n), distribuindo entre as threads
+    void parallel_for(int n, const std::function<void(int)>& fn) {
+        if (n <= 0) return;
+        if (workers.empty() || n == 1) {
+            for (int i = 0; i < n; i++) fn(i);
+            return;
+        }
+
+        auto batch = std::make_shared<Batch>();
+        batch->fn = &fn;
+        batch->n = n;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batches.push_back(batch);
+        }
+        wake.notify_all();
+
+        run_items(*batch);
+
+        std::unique_lock<std::mutex> lock(batch->done_mutex);
+        batch->done_cv.wait(lock, [&] { return batch->done.load() == batch->n; });
+        if (batch->error) std::rethrow_exception(batch->error);
+    }
+
+private:
+    struct Batch {
+        const std::function<void(int)>* fn = nullptr;
+        int n = 0;
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;   // primeira exceção (sob done_mutex)
+        std::mutex done_mutex;
+        std::condition_variable done_cv;
+    };
+
+    std::vector<std::thread> workers;
+    std::deque<std::shared_ptr<Batch>> batches;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    static int& worker_id() {
+        static thread_local int id = 0;
+        return id;
+    }
+
+    static void run_items(Batch& batch) {
+        int i;
+        while ((i = batch.next.fetch_add(1)) < batch.n) {
+            if (!batch.failed.load(std::memory_order_relaxed)) {
+                try {
+                    (*batch.fn)(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(batch.done_mutex);
+                    if (!batch.error) batch.error = std::current_exception();
+                    batch.failed = true;
+                }
+            }
+            // item com erro ou pulado também conta: o lote sempre termina
+            if (batch.done.fetch_add(1) + 1 == batch.n) {
+                std::lock_guard<std::mutex> lock(batch.done_mutex);
+                batch.done_cv.notify_all();
+            }
+        }
+    }
+
+    void worker_loop(int id) {
+        worker_id() = id;
+        for (;;) {
+            std::shared_ptr<Batch> batch;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || !batches.empty(); });
+                if (stopping && batches.empty()) return;
+
+                // descarta lotes já totalmente distribuídos
+                while (!batches.empty() &&
+                       batches.front()->next.load() >= batches.front()->n)
+                    batches.pop_front();
+                if (batches.empty()) continue;
+                batch = batches.front();
+            }
+            run_items(*batch);
+        }
+    }
+};
+
+// ------------------------------------------------------------
+// LazyThreadPool
+// Pool próprio de uma classe, criado no primeiro uso. get() pode ser
+// chamado por várias threads ao mesmo tempo (ex: predições concorrentes
+// num modelo const); reset() (ex: set_num_threads) só fora de uso.
+// ------------------------------------------------------------
+class LazyThreadPool {
+public:
+    LazyThreadPool() = default;
+    LazyThreadPool(const LazyThreadPool&) = delete;
+    LazyThreadPool& operator=(const LazyThreadPool&) = delete;
+
+    ThreadPool& get(int n_threads, const std::function<void(int)>& on_start = nullptr) {
+        if (ThreadPool* ready = created.load(std::memory_order_acquire)) return *ready;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!pool) {
+            pool = std::make_unique<ThreadPool>(n_threads, on_start);
+            created.store(pool.get(), std::memory_order_release);
+        }
+        return *pool;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        created.store(nullptr, std::memory_order_release);
+        pool.reset();
+    }
+
+private:
+    std::mutex mutex;
+    std::unique_ptr<ThreadPool> pool;
+    std::atomic<ThreadPool*> created{nullptr};
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,183 @@
+#ifndef TRAINING_TRACE_H
+#define TRAINING_TRACE_H
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// ------------------------------------------------------------
+// TrainingTrace
+// Telemetria opcional do treino: por árvore e por nível de
+// profundidade, quantos nós/amostras passaram, quantas features e
+// thresholds foram avaliados, quantos thresholds repetidos foram
+// pulados e o tempo de sort / scan / partição do find_best_split.
+// Exporta no formato Chrome trace-event (chrome://tracing, Perfetto).
+// ------------------------------------------------------------
+
+struct TraceLevel {
+    long long nodes = 0;
+    long long leaves = 0;
+    long long samples = 0;               // soma de |indices| dos nós do nível
+    long long features_evaluated = 0;
+    long long thresholds_evaluated = 0;  // posições de corte com Gini calculado
+    long long thresholds_skipped = 0;    // valores repetidos pulados no scan
+    long long sort_ns = 0;
+    long long scan_ns = 0;
+    long long partition_ns = 0;
+
+    long long split_ns() const { return sort_ns + scan_ns + partition_ns; }
+
+    void add(const TraceLevel& o) {
+        nodes += o.nodes;
+        leaves += o.leaves;
+        samples += o.samples;
+        features_evaluated += o.features_evaluated;
+        thresholds_evaluated += o.thresholds_evaluated;
+        thresholds_skipped += o.thresholds_skipped;
+        sort_ns += o.sort_ns;
+        scan_ns += o.scan_ns;
+        partition_ns += o.partition_ns;
+    }
+};
+
+struct TreeTrace {
+    int tree_id = -1;
+    int thread = 0;
+    long long start_ns = 0;
+    long long end_ns = 0;
+    std::vector<TraceLevel> levels;
+
+    TraceLevel& level(int depth) {
+        if (depth >= (int)levels.size()) levels.resize(depth + 1);
+        return levels[depth];
+    }
+};
+
+class TrainingTrace {
+public:
+    TrainingTrace() : origin(clock_ns()) {}
+
+    // Relógio comum a todas as threads (ns desde a criação do trace)
+    long long now_ns() const { return clock_ns() - origin; }
+
+    static long long clock_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Garante slots para as árvores [0, n_trees). Deve ser chamado antes
+    // do treino paralelo: cada tarefa só escreve no slot da sua árvore.
+    void prepare(int n_trees) {
+        if ((int)trees.size() < n_trees) trees.resize(n_trees);
+    }
+
+    TreeTrace* start_tree(int tree_id, int thread) {
+        TreeTrace& t = trees[tree_id];
+        t = TreeTrace();
+        t.tree_id = tree_id;
+        t.thread = thread;
+        t.start_ns = now_ns();
+        return &t;
+    }
+
+    void finish_tree(TreeTrace* t) {
+        if (t) t->end_ns = now_ns();
+    }
+
+    const std::vector<TreeTrace>& get_trees() const { return trees; }
+
+    // Soma de todas as árvores por nível
+    std::vector<TraceLevel> totals_by_depth() const {
+        std::vector<TraceLevel> totals;
+        for (const auto& t : trees) {
+            if (t.levels.size() > totals.size()) totals.resize(t.levels.size());
+            for (size_t d = 0; d < t.levels.size(); d++) totals[d].add(t.levels[d]);
+        }
+        return totals;
+    }
+
+    // --------------------------------------------------------
+    // Chrome trace-event JSON:
+    //  - pid 1: uma barra por árvore na thread que a treinou
+    //  - pid 2: uma linha por árvore, com barras consecutivas por nível
+    //    (duração = sort + scan + partição daquele nível)
+    // Os contadores de cada barra ficam em "args".
+    // --------------------------------------------------------
+    void write_chrome_json(std::ostream& out) const {
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"arvores (por thread)\"}},\n";
+        out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 2, \"args\": {\"name\": \"niveis (por arvore)\"}}";
+        out << std::fixed << std::setprecision(3);
+
+        for (const auto& t : trees) {
+            if (t.tree_id < 0) continue;
+            TraceLevel total;
+            for (const auto& l : t.levels) total.add(l);
+
+            out << ",\n{\"name\": \"tree " << t.tree_id << "\", \"ph\": \"X\", \"pid\": 1"
+                << ", \"tid\": " << t.thread
+                << ", \"ts\": " << t.start_ns / 1e3
+                << ", \"dur\": " << (t.end_ns - t.start_ns) / 1e3
+                << ", \"args\": {\"depth\": " << t.levels.size();
+            write_level_args(out, total);
+            out << "}}";
+
+            long long ts = t.start_ns;
+            for (size_t d = 0; d < t.levels.size(); d++) {
+                const TraceLevel& l = t.levels[d];
+                out << ",\n{\"name\": \"depth " << d << "\", \"ph\": \"X\", \"pid\": 2"
+                    << ", \"tid\": " << t.tree_id
+                    << ", \"ts\": " << ts / 1e3
+                    << ", \"dur\": " << l.split_ns() / 1e3
+                    << ", \"args\": {\"tree\": " << t.tree_id;
+                write_level_args(out, l);
+                out << "}}";
+                ts += l.split_ns();
+            }
+        }
+        out << "\n]}\n";
+    }
+
+    // Resumo por nível (todas as árvores somadas)
+    void print_summary(std::ostream& out) const {
+        const std::vector<TraceLevel> totals = totals_by_depth();
+        out << "\n========== TELEMETRIA DO TREINO (por nivel) ==========\n";
+        out << std::right
+            << std::setw(5) << "Nivel" << std::setw(9) << "Nos" << std::setw(12) << "Amostras"
+            << std::setw(10) << "Features" << std::setw(12) << "Sort(ms)"
+            << std::setw(12) << "Scan(ms)" << std::setw(12) << "Part.(ms)"
+            << std::setw(10) << "%Pulados" << "\n";
+        out << std::fixed << std::setprecision(2);
+        for (size_t d = 0; d < totals.size(); d++) {
+            const TraceLevel& l = totals[d];
+            const long long positions = l.thresholds_evaluated + l.thresholds_skipped;
+            out << std::setw(5) << d << std::setw(9) << l.nodes << std::setw(12) << l.samples
+                << std::setw(10) << l.features_evaluated
+                << std::setw(12) << l.sort_ns / 1e6
+                << std::setw(12) << l.scan_ns / 1e6
+                << std::setw(12) << l.partition_ns / 1e6
+                << std::setw(9) << (positions ? 100.0 * l.thresholds_skipped / positions : 0.0)
+                << "%\n";
+        }
+    }
+
+private:
+    long long origin;
+    std::vector<TreeTrace> trees;
+
+    static void write_level_args(std::ostream& out, const TraceLevel& l) {
+        out << ", \"nodes\": " << l.nodes
+            << ", \"leaves\": " << l.leaves
+            << ", \"samples\": " << l.samples
+            << ", \"features_evaluated\": " << l.features_evaluated
+            << ", \"thresholds_evaluated\": " << l.thresholds_evaluated
+            << ", \"thresholds_skipped\": " << l.thresholds_skipped
+            << ", \"sort_ms\": " << l.sort_ns / 1e6
+            << ", \"scan_ms\": " << l.scan_ns / 1e6
+            << ", \"partition_ms\": " << l.partition_ns / 1e6;
+    }
+};
+
+#endif // TRAINING_TRACE_H
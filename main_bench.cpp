@@ -0,0 +1,345 @@
+#include "RandomForestBaseline.h"
+#include "RandomForestOptimized.h"
+#include "QuantizedForest.h"
+#include "CompleteForest.h"
+#include "GradientBoosting.h"
+#include "HoeffdingForest.h"
+#include "DataLoader.h"
+#include "ArgParser.h"
+#include "BenchHarness.h"
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+
+// ------------------------------------------------------------
+// forest_bench: benchmarks reprodutíveis (sementes fixas, warm-up,
+// repetições com mediana/MAD) de treino, predição e micro-etapas,
+// com varredura de n_samples, n_trees, max_depth e threads.
+// ------------------------------------------------------------
+
+static std::vector<long long> parse_list(const std::string& text) {
+    std::vector<long long> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty()) values.push_back(std::stoll(item));
+    return values;
+}
+
+static std::string join_list(const std::vector<long long>& values) {
+    std::string out;
+    for (size_t i = 0; i < values.size(); i++)
+        out += (i ? "," : "") + std::to_string(values[i]);
+    return out;
+}
+
+static void take_rows(const std::vector<std::vector<double>>& X,
+                      const std::vector<int>& y, size_t n,
+                      std::vector<std::vector<double>>& X_out,
+                      std::vector<int>& y_out) {
+    n = std::min(n, X.size());
+    X_out.assign(X.begin(), X.begin() + n);
+    y_out.assign(y.begin(), y.begin() + n);
+}
+
+int main(int argc, char** argv) {
+    ArgParser args(argc, argv);
+
+    if (args.has_flag("help")) {
+        std::cout << "Uso: " << argv[0] << " [dataset.csv] [--json=saida.json]\n"
+                  << "       [--reps=5] [--warmup=1] [--filter=substr] [--seed=42]\n"
+                  << "       [--samples=1000,10000] [--trees=10,50] [--depths=4,8]\n"
+                  << "       [--threads=1,2] [--compare=anterior.json] [--tolerance=0.10]\n";
+        return 0;
+    }
+
+    const std::string dataset_path = args.positional_count() >= 1
+                                   ? args.positional(0) : "adult_dataset.csv";
+    const std::string json_path   = args.option("json", "bench_results.json");
+    const int repetitions         = std::stoi(args.option("reps", "5"));
+    const int warmup              = std::stoi(args.option("warmup", "1"));
+    const unsigned int seed       = std::stoul(args.option("seed", "42"));
+    const double tolerance        = std::stod(args.option("tolerance", "0.10"));
+    const std::string compare     = args.option("compare");
+    const std::string tmp_model   = args.option("tmp-model", "forest_bench.tmp.model");
+
+    std::cout << "========================================================\n";
+    std::cout << "   forest_bench: " << dataset_path << "\n";
+    std::cout << "========================================================\n\n";
+
+    std::vector<std::vector<double>> X_all;
+    std::vector<int> y_all;
+    try {
+        DataLoader::load(dataset_path, X_all, y_all);
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Erro ao carregar dataset: " << e.what() << "\n";
+        return 1;
+    }
+    if (X_all.empty()) {
+        std::cerr << "❌ Dataset vazio!\n";
+        return 1;
+    }
+    const long long n_rows = X_all.size();
+    const int n_classes = *std::max_element(y_all.begin(), y_all.end()) + 1;
+
+    // Configuração base e varreduras (uma dimensão por vez)
+    const long long base_n       = std::min(10000LL, n_rows);
+    const long long base_trees   = 50;
+    const long long base_depth   = 8;
+    const long long min_split    = 5;
+    const long long chunk_size   = 100;
+
+    std::vector<long long> sweep_samples = parse_list(args.option("samples", "1000,10000," + std::to_string(n_rows)));
+    std::vector<long long> sweep_trees   = parse_list(args.option("trees", "10,50"));
+    std::vector<long long> sweep_depths  = parse_list(args.option("depths", "4,8"));
+    std::vector<long long> sweep_threads = parse_list(args.option("threads",
+        "1," + std::to_string(ThreadPool::hardware_threads())));
+
+    std::set<long long> unique_samples, unique_threads;
+    for (long long n : sweep_samples) unique_samples.insert(std::min(n, n_rows));
+    for (long long th : sweep_threads) unique_threads.insert(std::max(1LL, th));
+    sweep_samples.assign(unique_samples.begin(), unique_samples.end());
+    sweep_threads.assign(unique_threads.begin(), unique_threads.end());
+
+    BenchRunner runner(warmup, repetitions, args.option("filter"));
+    const std::string load_name = DataLoader::is_binary(dataset_path)
+                                ? "micro/load_binary" : "micro/load_csv";
+
+    // --------------------------------------------------------
+    // Micro: carga do dataset (CSV ou binário) e transposição
+    // --------------------------------------------------------
+    for (long long n : sweep_samples) {
+        std::vector<std::vector<double>> X;
+        std::vector<int> y;
+        runner.run(load_name, {{"n_samples", n}}, n, [&] {
+            DataLoader::load(dataset_path, X, y, n);
+            bench_do_not_optimize(X);
+        });
+
+        std::vector<std::vector<double>> X_sub, X_col;
+        std::vector<int> y_sub;
+        take_rows(X_all, y_all, n, X_sub, y_sub);
+        runner.run("micro/transpose", {{"n_samples", n}}, n, [&] {
+            DataLoader::to_column_major(X_sub, X_col);
+            bench_do_not_optimize(X_col);
+        });
+
+        // Busca de split na raiz: árvore de profundidade 1 = um único
+        // find_best_split sobre todas as linhas (sqrt(F) features)
+        std::vector<int> indices(X_sub.size());
+        for (size_t i = 0; i < indices.size(); i++) indices[i] = i;
+        runner.run("micro/split_search", {{"n_samples", n}}, n, [&] {
+            DecisionTree stump(1, 2);
+            stump.set_seed(seed);
+            stump.fit_columns(X_col, y_sub, indices);
+            bench_do_not_optimize(stump);
+        });
+    }
+
+    // --------------------------------------------------------
+    // Treino: varredura de n_samples, n_trees, max_depth, threads
+    // --------------------------------------------------------
+    std::set<std::tuple<long long, long long, long long, long long>> configs;
+    for (long long n : sweep_samples)  configs.insert({n, base_trees, base_depth, 1});
+    for (long long t : sweep_trees)    configs.insert({base_n, t, base_depth, 1});
+    for (long long d : sweep_depths)   configs.insert({base_n, base_trees, d, 1});
+    for (long long th : sweep_threads) configs.insert({base_n, base_trees, base_depth, th});
+
+    for (const auto& cfg : configs) {
+        long long n, trees, depth, threads;
+        std::tie(n, trees, depth, threads) = cfg;
+
+        std::vector<std::vector<double>> X;
+        std::vector<int> y;
+        take_rows(X_all, y_all, n, X, y);
+
+        BenchParams params = {{"n_samples", n}, {"n_trees", trees},
+                              {"max_depth", depth}, {"threads", threads}};
+
+        // baseline é sequencial: só entra nas configurações de 1 thread
+        if (threads == 1) {
+            runner.run("train/baseline", params, n * trees, [&] {
+                RandomForestBaseline forest(trees, depth, min_split);
+                forest.set_seed(seed);
+                forest.fit(X, y);
+                bench_do_not_optimize(forest);
+            });
+        }
+
+        runner.run("train/optimized", params, n * trees, [&] {
+            RandomForestOptimized forest(trees, depth, min_split, chunk_size);
+            forest.set_seed(seed);
+            forest.set_num_threads(threads);
+            forest.fit(X, y);
+            bench_do_not_optimize(forest);
+        });
+
+        // floresta em fluxo: as n linhas num único partial_fit (vazão das
+        // atualizações em linhas x árvores)
+        runner.run("train/online", params, n * trees, [&] {
+            HoeffdingForest forest(trees, depth, n_classes);
+            forest.set_seed(seed);
+            forest.set_num_threads(threads);
+            forest.partial_fit(X, y);
+            bench_do_not_optimize(forest);
+        });
+
+        // boosting: n_trees rodadas de profundidade max_depth, todas as
+        // features por nó (mesma vazão em linhas x árvores)
+        runner.run("train/boosting", params, n * trees, [&] {
+            GradientBoosting booster(trees, depth);
+            booster.set_seed(seed);
+            booster.set_min_samples_split(min_split);
+            booster.set_num_threads(threads);
+            booster.fit(X, y);
+            bench_do_not_optimize(booster);
+        });
+    }
+
+    // --------------------------------------------------------
+    // Predição e serialização (modelo da configuração base)
+    // --------------------------------------------------------
+    {
+        std::vector<std::vector<double>> X;
+        std::vector<int> y;
+        take_rows(X_all, y_all, base_n, X, y);
+
+        RandomForestBaseline baseline(base_trees, base_depth, min_split);
+        baseline.set_seed(seed);
+        baseline.fit(X, y);
+
+        RandomForestOptimized optimized(base_trees, base_depth, min_split, chunk_size);
+        optimized.set_seed(seed);
+        optimized.fit(X, y);
+
+        RandomForestOptimized flat(base_trees, base_depth, min_split, chunk_size);
+        flat.set_seed(seed);
+        flat.fit(X, y);
+        flat.compact();
+
+        // mesma floresta, nós na ordem das frequências do treino
+        RandomForestOptimized profiled(base_trees, base_depth, min_split, chunk_size);
+        profiled.set_seed(seed);
+        profiled.fit(X, y);
+        profiled.set_flat_layout(FlatForest::Layout::Profiled);
+        profiled.compact();
+
+        QuantizedForest quantized;
+        quantized.build(flat.get_flat(), flat.get_num_classes());
+
+        // forma completa implícita; splits categóricos ou árvores com mais
+        // de 16 níveis ficam de fora do benchmark
+        CompleteForest complete;
+        bool has_complete = true;
+        try {
+            complete.build(flat.get_flat(), flat.get_num_classes());
+        } catch (const std::exception&) {
+            has_complete = false;
+        }
+
+        GradientBoosting booster(base_trees, base_depth);
+        booster.set_seed(seed);
+        booster.set_min_samples_split(min_split);
+        booster.fit(X, y);
+
+        BenchParams params = {{"n_samples", base_n}, {"n_trees", base_trees},
+                              {"max_depth", base_depth}, {"threads", 1}};
+
+        runner.run("predict/baseline", params, base_n, [&] {
+            bench_do_not_optimize(baseline.predict(X));
+        });
+        for (long long threads : sweep_threads) {
+            params.back().second = threads;
+            optimized.set_num_threads(threads);
+            flat.set_num_threads(threads);
+            runner.run("predict/optimized", params, base_n, [&] {
+                bench_do_not_optimize(optimized.predict(X));
+            });
+            runner.run("predict/flat", params, base_n, [&] {
+                bench_do_not_optimize(flat.predict(X));
+            });
+            profiled.set_num_threads(threads);
+            runner.run("predict/flat_profiled", params, base_n, [&] {
+                bench_do_not_optimize(profiled.predict(X));
+            });
+            booster.set_num_threads(threads);
+            runner.run("predict/boosting", params, base_n, [&] {
+                bench_do_not_optimize(booster.predict(X));
+            });
+        }
+        params.back().second = 1;
+        runner.run("predict/quantized", params, base_n, [&] {
+            bench_do_not_optimize(quantized.predict(X));
+        });
+        if (has_complete)
+            runner.run("predict/complete", params, base_n, [&] {
+                bench_do_not_optimize(complete.predict(X));
+            });
+
+        BenchParams model_params = {{"n_trees", base_trees}, {"max_depth", base_depth}};
+        runner.run("micro/serialize_save", model_params, base_trees, [&] {
+            optimized.save_model(tmp_model);
+        });
+        runner.run("micro/serialize_load", model_params, base_trees, [&] {
+            RandomForestOptimized loaded(1, 1, 1, 1);
+            loaded.load_model(tmp_model);
+            bench_do_not_optimize(loaded);
+        });
+        std::remove(tmp_model.c_str());
+    }
+
+    // --------------------------------------------------------
+    // Regressões: otimizada mais lenta que a baseline nos mesmos
+    // parâmetros, ou mais lenta que o JSON de referência (--compare)
+    // --------------------------------------------------------
+    std::vector<BenchRegression> regressions;
+    for (const auto& r : runner.get_results()) {
+        const std::string prefix_opt = "/optimized/";
+        auto pos = r.key.find(prefix_opt);
+        if (pos == std::string::npos) continue;
+        std::string base_key = r.key;
+        base_key.replace(pos, prefix_opt.size(), "/baseline/");
+        const BenchResult* base = runner.find(base_key);
+        if (base && r.median_ms > base->median_ms * (1.0 + tolerance))
+            regressions.push_back({r.key, "baseline", base->median_ms, r.median_ms});
+    }
+    if (!compare.empty()) {
+        auto previous = BenchRunner::read_json_medians(compare);
+        for (const auto& r : runner.get_results()) {
+            auto it = previous.find(r.key);
+            if (it != previous.end() && r.median_ms > it->second * (1.0 + tolerance))
+                regressions.push_back({r.key, compare, it->second, r.median_ms});
+        }
+    }
+
+    std::ofstream json(json_path);
+    runner.write_json(json, {
+        {"dataset", "\"" + dataset_path + "\""},
+        {"n_rows", std::to_string(n_rows)},
+        {"n_features", std::to_string(X_all[0].size())},
+        {"hardware_threads", std::to_string(ThreadPool::hardware_threads())},
+        {"repetitions", std::to_string(repetitions)},
+        {"warmup", std::to_string(warmup)},
+        {"seed", std::to_string(seed)},
+        {"tolerance", std::to_string(tolerance)},
+        {"sweep_samples", "\"" + join_list(sweep_samples) + "\""},
+        {"sweep_threads", "\"" + join_list(sweep_threads) + "\""}
+    }, regressions);
+    std::cout << "\nResultados salvos em: " << json_path << "\n";
+
+    if (!regressions.empty()) {
+        std::cout << "\n❌ " << regressions.size() << " regressao(oes) acima de "
+                  << tolerance * 100.0 << "%:\n";
+        for (const auto& g : regressions)
+            std::cout << "  " << g.key << ": " << g.reference_ms << " ms ("
+                      << g.reference << ") -> " << g.current_ms << " ms\n";
+        return 2;
+    }
+    std::cout << "✔ Nenhuma regressao detectada.\n";
+    return 0;
+}
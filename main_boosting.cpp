@@ -0,0 +1,252 @@
+#include "GradientBoosting.h"
+#include "RandomForestOptimized.h"
+#include "DataLoader.h"
+#include "PerfCounters.h"
+#include "ArgParser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+
+// ------------------------------------------------------------
+// forest_boosting: treina o gradient boosting num split 80/20
+// reprodutível, avalia no teste e (com --compare-rf) treina a
+// floresta otimizada no mesmo split para comparar vazão e acurácia.
+// ------------------------------------------------------------
+
+static std::string get_filename_only(const std::string& path) {
+    std::size_t pos = path.find_last_of("/\\");
+    if (pos == std::string::npos) return path;
+    return path.substr(pos + 1);
+}
+
+static std::vector<int> parse_int_list(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty()) values.push_back(std::stoi(item));
+    return values;
+}
+
+template <typename Label>
+static void split_rows(const std::vector<std::vector<double>>& X,
+                       const std::vector<Label>& y,
+                       unsigned int seed,
+                       std::vector<std::vector<double>>& X_train,
+                       std::vector<Label>& y_train,
+                       std::vector<std::vector<double>>& X_test,
+                       std::vector<Label>& y_test) {
+    std::vector<size_t> order(X.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937 gen(seed);
+    std::shuffle(order.begin(), order.end(), gen);
+
+    const size_t n_train = (size_t)(X.size() * 0.8);
+    for (size_t i = 0; i < order.size(); ++i) {
+        auto& X_out = i < n_train ? X_train : X_test;
+        auto& y_out = i < n_train ? y_train : y_test;
+        X_out.push_back(X[order[i]]);
+        y_out.push_back(y[order[i]]);
+    }
+}
+
+static double accuracy(const std::vector<int>& y_true, const std::vector<int>& y_pred) {
+    size_t correct = 0;
+    for (size_t i = 0; i < y_true.size(); ++i)
+        if (y_true[i] == y_pred[i]) ++correct;
+    return y_true.empty() ? 0.0 : (double)correct / y_true.size();
+}
+
+static double log_loss(const std::vector<int>& y_true, const std::vector<double>& proba, int num_classes) {
+    double total = 0.0;
+    for (size_t i = 0; i < y_true.size(); ++i)
+        total -= std::log(std::max(proba[i * num_classes + y_true[i]], 1e-15));
+    return y_true.empty() ? 0.0 : total / y_true.size();
+}
+
+static double rmse(const std::vector<double>& y_true, const std::vector<double>& y_pred) {
+    double sse = 0.0;
+    for (size_t i = 0; i < y_true.size(); ++i)
+        sse += (y_true[i] - y_pred[i]) * (y_true[i] - y_pred[i]);
+    return y_true.empty() ? 0.0 : std::sqrt(sse / y_true.size());
+}
+
+static double elapsed_ms(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    std::cout << "========================================================\n";
+    std::cout << "   Gradient Boosting: TREINO + AVALIACAO\n";
+    std::cout << "========================================================\n\n";
+
+    ArgParser args(argc, argv);
+
+    if (args.positional_count() < 1) {
+        std::cerr << "Uso: " << argv[0]
+                  << " <arquivo_dataset.csv> [max_samples] [modelo_saida]\n"
+                  << "       [--rounds=100] [--depth=6] [--lr=0.1] [--leaves=0 (por folha)]\n"
+                  << "       [--lambda=1] [--min-child-weight=0.001] [--feature-fraction=1]\n"
+                  << "       [--categorical=1,3,5] [--threads=N] [--seed=42]\n"
+                  << "       [--regression] [--compare-rf [--rf-trees=50] [--rf-depth=8]]\n";
+        std::cerr << "Exemplo: " << argv[0]
+                  << " adult_dataset.csv 45222 models/adult.gbt --leaves=31 --compare-rf\n";
+        return 1;
+    }
+
+    const std::string dataset_path = args.positional(0);
+    const int max_samples = args.positional_count() >= 2 ? std::stoi(args.positional(1)) : 100000;
+    const std::string model_path = args.positional_count() >= 3
+        ? args.positional(2)
+        : "models/boosting_" + get_filename_only(dataset_path) + ".model";
+
+    const int rounds       = std::stoi(args.option("rounds", "100"));
+    const int depth        = std::stoi(args.option("depth", "6"));
+    const double lr        = std::stod(args.option("lr", "0.1"));
+    const int leaves       = std::stoi(args.option("leaves", "0"));
+    const int n_threads    = std::stoi(args.option("threads", "1"));
+    const unsigned seed    = std::stoul(args.option("seed", "42"));
+    const bool regression  = args.has_flag("regression");
+    const bool compare_rf  = args.has_flag("compare-rf");
+    const std::vector<int> categorical = parse_int_list(args.option("categorical"));
+
+    std::cout << "Dataset     : " << dataset_path << "\n";
+    std::cout << "Modelo saida: " << model_path << "\n";
+    std::cout << "Rodadas     : " << rounds << " (lr " << lr << ")\n";
+    std::cout << "Crescimento : " << (leaves > 0 ? "por folha, " + std::to_string(leaves) + " folhas"
+                                                 : std::string("recursivo (profundidade primeiro)"))
+              << ", profundidade " << depth << "\n";
+    std::cout << "Threads     : " << n_threads << "\n\n";
+
+    std::vector<std::vector<double>> X, X_train, X_test;
+    std::vector<int> y, y_train, y_test;
+    std::vector<double> y_reg, y_reg_train, y_reg_test;
+
+    std::cout << "Carregando dataset...\n";
+    try {
+        if (regression) DataLoader::load(dataset_path, X, y_reg, max_samples);
+        else            DataLoader::load(dataset_path, X, y, max_samples);
+        if (X.empty()) {
+            std::cerr << "❌ Dataset vazio apos carregamento!\n";
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Erro ao carregar dataset: " << e.what() << "\n";
+        return 1;
+    }
+    if (regression) split_rows(X, y_reg, seed, X_train, y_reg_train, X_test, y_reg_test);
+    else            split_rows(X, y, seed, X_train, y_train, X_test, y_test);
+    std::cout << "Treino: " << X_train.size() << " amostras, teste: " << X_test.size() << "\n\n";
+
+    // --------------------------------------------------------
+    // Boosting
+    // --------------------------------------------------------
+    GradientBoosting booster(rounds, depth, lr, leaves);
+    booster.set_lambda(std::stod(args.option("lambda", "1")));
+    booster.set_min_child_weight(std::stod(args.option("min-child-weight", "0.001")));
+    booster.set_feature_fraction(std::stod(args.option("feature-fraction", "1")));
+    booster.set_categorical_features(categorical);
+    booster.set_num_threads(n_threads);
+    booster.set_seed(seed);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    try {
+        if (regression) booster.fit_regression(X_train, y_reg_train);
+        else            booster.fit(X_train, y_train);
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Erro no treino: " << e.what() << "\n";
+        return 1;
+    }
+    const double gbt_train_ms = elapsed_ms(start);
+
+    start = std::chrono::high_resolution_clock::now();
+    double gbt_metric = 0.0, gbt_log_loss = 0.0;
+    if (regression) {
+        gbt_metric = rmse(y_reg_test, booster.predict_regression(X_test));
+    } else {
+        gbt_metric = accuracy(y_test, booster.predict(X_test));
+        gbt_log_loss = log_loss(y_test, booster.predict_proba(X_test), booster.get_num_classes());
+    }
+    const double gbt_predict_ms = elapsed_ms(start);
+
+    try {
+        booster.save_model(model_path);
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Erro ao salvar modelo: " << e.what() << "\n";
+        return 1;
+    }
+
+    // Vazão = linhas de treino x árvores por segundo
+    const double gbt_throughput = (double)X_train.size() * booster.get_num_trees() / (gbt_train_ms / 1000.0);
+
+    std::cout << "================= BOOSTING ==============================\n";
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << std::setw(28) << "Arvores" << std::setw(16) << booster.get_num_trees() << "\n";
+    std::cout << std::setw(28) << "Tempo treino (ms)" << std::setw(16) << gbt_train_ms << "\n";
+    std::cout << std::setw(28) << "Linhas x arvores / s" << std::setw(16) << std::setprecision(0)
+              << gbt_throughput << std::setprecision(4) << "\n";
+    std::cout << std::setw(28) << "Predicao teste (ms)" << std::setw(16) << gbt_predict_ms << "\n";
+    if (regression) {
+        std::cout << std::setw(28) << "RMSE teste" << std::setw(16) << gbt_metric << "\n";
+    } else {
+        std::cout << std::setw(28) << "Acuracia teste (%)" << std::setw(16) << gbt_metric * 100.0 << "\n";
+        std::cout << std::setw(28) << "Log-loss teste" << std::setw(16) << gbt_log_loss << "\n";
+    }
+    std::cout << "Modelo salvo em: " << model_path << "\n";
+
+    // --------------------------------------------------------
+    // Floresta otimizada no mesmo split (referência)
+    // --------------------------------------------------------
+    double rf_train_ms = 0.0, rf_metric = 0.0, rf_throughput = 0.0;
+    if (compare_rf) {
+        RandomForestOptimized forest(std::stoi(args.option("rf-trees", "50")),
+                                     std::stoi(args.option("rf-depth", "8")), 5, 100);
+        forest.set_seed(seed);
+        forest.set_num_threads(n_threads);
+        forest.set_categorical_features(categorical);
+
+        start = std::chrono::high_resolution_clock::now();
+        if (regression) forest.fit_regression(X_train, y_reg_train);
+        else            forest.fit(X_train, y_train);
+        rf_train_ms = elapsed_ms(start);
+        rf_throughput = (double)X_train.size() * forest.get_num_trees() / (rf_train_ms / 1000.0);
+        rf_metric = regression ? rmse(y_reg_test, forest.predict_regression(X_test))
+                               : accuracy(y_test, forest.predict(X_test));
+
+        std::cout << "\n================= RANDOM FOREST =========================\n";
+        std::cout << std::setw(28) << "Arvores" << std::setw(16) << forest.get_num_trees() << "\n";
+        std::cout << std::setw(28) << "Tempo treino (ms)" << std::setw(16) << rf_train_ms << "\n";
+        std::cout << std::setw(28) << "Linhas x arvores / s" << std::setw(16) << std::setprecision(0)
+                  << rf_throughput << std::setprecision(4) << "\n";
+        if (regression)
+            std::cout << std::setw(28) << "RMSE teste" << std::setw(16) << rf_metric << "\n";
+        else
+            std::cout << std::setw(28) << "Acuracia teste (%)" << std::setw(16) << rf_metric * 100.0 << "\n";
+    }
+    std::cout << "========================================================\n";
+
+    std::string csv_name = "results_boosting_" + get_filename_only(dataset_path) + ".csv";
+    std::ofstream csv(csv_name);
+    csv << "Metodo,Dataset,Amostras,Arvores,TempoTreino(ms),LinhasArvoresPorSeg,"
+        << (regression ? "RMSE" : "Acuracia") << "\n";
+    csv << "GradientBoosting," << get_filename_only(dataset_path) << "," << X_train.size() << ","
+        << booster.get_num_trees() << "," << gbt_train_ms << "," << gbt_throughput << ","
+        << gbt_metric << "\n";
+    if (compare_rf)
+        csv << "RandomForestOptimized," << get_filename_only(dataset_path) << "," << X_train.size() << ","
+            << args.option("rf-trees", "50") << "," << rf_train_ms << "," << rf_throughput << ","
+            << rf_metric << "\n";
+    std::cout << "Resultados salvos em: " << csv_name << "\n";
+
+    PERF_REPORT(args.option("perf-json"));
+    return 0;
+}
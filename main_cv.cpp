@@ -0,0 +1,145 @@
+#include "CrossValidation.h"
+#include "DataLoader.h"
+#include "PerfCounters.h"
+#include "ArgParser.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// ------------------------------------------------------------
+// forest_cv: validação cruzada k-fold da floresta otimizada. O dataset
+// fica numa única cópia column-major; os folds são listas de índices e
+// treinam em paralelo no mesmo pool das árvores.
+// ------------------------------------------------------------
+
+static std::string get_filename_only(const std::string& path) {
+    std::size_t pos = path.find_last_of("/\\");
+    if (pos == std::string::npos) return path;
+    return path.substr(pos + 1);
+}
+
+static std::vector<int> parse_int_list(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty()) values.push_back(std::stoi(item));
+    return values;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "========================================================\n";
+    std::cout << "   Random Forest Otimizada: VALIDACAO CRUZADA K-FOLD\n";
+    std::cout << "========================================================\n\n";
+
+    ArgParser args(argc, argv);
+
+    if (args.positional_count() < 1) {
+        std::cerr << "Uso: " << argv[0] << " <arquivo_dataset.csv> [max_samples]\n"
+                  << "       [--folds=5] [--trees=50] [--depth=8] [--threads=N] [--seed=42]\n"
+                  << "       [--categorical=1,3,5] [--proba] [--extra-trees] [--level-wise]\n";
+        std::cerr << "Exemplo: " << argv[0] << " adult_dataset.csv 45222 --folds=10 --threads=8\n";
+        return 1;
+    }
+
+    const std::string dataset_path = args.positional(0);
+    const int max_samples = args.positional_count() >= 2 ? std::stoi(args.positional(1)) : 100000;
+    const int n_folds     = std::stoi(args.option("folds", "5"));
+    const int n_trees     = std::stoi(args.option("trees", "50"));
+    const int max_depth   = std::stoi(args.option("depth", "8"));
+    const int n_threads   = std::stoi(args.option("threads", "1"));
+    const unsigned seed   = std::stoul(args.option("seed", "42"));
+    const std::vector<int> categorical = parse_int_list(args.option("categorical"));
+    const bool probability_leaves = args.has_flag("proba");
+    const bool extra_trees = args.has_flag("extra-trees");
+    const bool level_wise = args.has_flag("level-wise");
+
+    std::cout << "Dataset     : " << dataset_path << "\n";
+    std::cout << "Folds       : " << n_folds << "\n";
+    std::cout << "Floresta    : " << n_trees << " arvores, profundidade " << max_depth << "\n";
+    std::cout << "Threads     : " << n_threads << " (pool compartilhado por folds e arvores)\n\n";
+
+    // Uma cópia column-major: o binário já vem assim; o CSV é transposto
+    // e a forma por linhas é liberada antes da validação
+    std::vector<std::vector<double>> X_col;
+    std::vector<int> y;
+    std::cout << "Carregando dataset...\n";
+    try {
+        if (DataLoader::is_binary(dataset_path)) {
+            DataLoader::load_binary_columns(dataset_path, X_col, y, max_samples);
+        } else {
+            std::vector<std::vector<double>> X;
+            DataLoader::load(dataset_path, X, y, max_samples);
+            DataLoader::to_column_major(X, X_col);
+        }
+        if (X_col.empty() || y.empty()) {
+            std::cerr << "❌ Dataset vazio apos carregamento!\n";
+            return 1;
+        }
+        std::cout << "Dataset carregado: " << y.size() << " amostras, "
+                  << X_col.size() << " features\n\n";
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Erro ao carregar dataset: " << e.what() << "\n";
+        return 1;
+    }
+
+    auto make_forest = [&]() {
+        auto forest = std::make_unique<RandomForestOptimized>(n_trees, max_depth, 5, 100);
+        forest->set_categorical_features(categorical);
+        forest->set_probability_leaves(probability_leaves);
+        forest->set_extra_trees(extra_trees);
+        forest->set_level_wise(level_wise);
+        return forest;
+    };
+
+    CrossValidation::Report report;
+    try {
+        ThreadPool pool(n_threads);
+        CrossValidation cv(n_folds, seed);
+        report = cv.run(X_col, y, make_forest, pool);
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Erro na validacao cruzada: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::cout << "================= FOLDS =================================\n";
+    std::cout << std::setw(6) << "Fold" << std::setw(10) << "Treino" << std::setw(10) << "Teste"
+              << std::setw(14) << "Acuracia(%)" << std::setw(14) << "Treino(ms)"
+              << std::setw(14) << "Predicao(ms)" << "\n";
+    std::cout << std::fixed << std::setprecision(4);
+    for (const auto& f : report.folds)
+        std::cout << std::setw(6) << f.fold << std::setw(10) << f.train_rows
+                  << std::setw(10) << f.test_rows << std::setw(14) << f.accuracy * 100.0
+                  << std::setw(14) << f.train_ms << std::setw(14) << f.predict_ms << "\n";
+
+    const double mb = 1024.0 * 1024.0;
+    std::cout << "\n================= RESULTADOS CV =========================\n";
+    std::cout << std::setw(28) << "Acuracia (%)" << std::setw(14) << report.mean_accuracy * 100.0
+              << " +- " << report.std_accuracy * 100.0 << "\n";
+    std::cout << std::setw(28) << "Treino por fold (ms)" << std::setw(14) << report.mean_train_ms
+              << " +- " << report.std_train_ms << "\n";
+    std::cout << std::setw(28) << "Predicao por fold (ms)" << std::setw(14) << report.mean_predict_ms << "\n";
+    std::cout << std::setw(28) << "Tempo total (ms)" << std::setw(14) << report.wall_ms << "\n";
+    std::cout << std::setw(28) << "Dataset (MB, 1 copia)" << std::setw(14) << report.dataset_bytes / mb << "\n";
+    std::cout << std::setw(28) << "Indices dos folds (MB)" << std::setw(14) << report.index_bytes / mb << "\n";
+    std::cout << "========================================================\n";
+
+    std::string csv_name = "results_cv_" + get_filename_only(dataset_path) + ".csv";
+    std::ofstream csv(csv_name);
+    csv << "Metodo,Dataset,Amostras,Folds,Fold,Acuracia,TempoTreino(ms),TempoPredicao(ms)\n";
+    for (const auto& f : report.folds)
+        csv << "RandomForestOptimizedCV," << get_filename_only(dataset_path) << "," << y.size() << ","
+            << n_folds << "," << f.fold << "," << f.accuracy << "," << f.train_ms << ","
+            << f.predict_ms << "\n";
+    csv << "RandomForestOptimizedCV," << get_filename_only(dataset_path) << "," << y.size() << ","
+        << n_folds << ",media," << report.mean_accuracy << "," << report.mean_train_ms << ","
+        << report.mean_predict_ms << "\n";
+    std::cout << "Resultados salvos em: " << csv_name << "\n";
+
+    PERF_REPORT(args.option("perf-json"));
+    return 0;
+}
@@ -1,5 +1,7 @@
 #include "RandomForestBaseline.h"
 #include "DataLoader.h"
+#include "PerfCounters.h"
+#include "ArgParser.h"
 
 #include <iostream>
 #include <chrono>
@@ -18,29 +20,39 @@ int main(int argc, char** argv) {
     std::cout << "   Random Forest (Baseline): TREINO + SALVAMENTO\n";
     std::cout << "========================================================\n\n";
 
-    if (argc < 2) {
+    ArgParser args(argc, argv);
+
+    if (args.positional_count() < 1) {
         std::cerr << "Uso: " << argv[0]
-                  << " <arquivo_dataset.csv> [max_samples] [num_runs] [modelo_saida]\n";
+                  << " <arquivo_dataset.csv> [max_samples] [num_runs] [modelo_saida] [--oob]\n"
+                  << "       [--warm-start=<modelo_existente>] [--add-trees=N]\n"
+                  << "       [--perf-json=saida.jsonl]  (build com make PERF=1)\n"
+                  << "       [--trace=treino_trace.json]\n";
         std::cerr << "Exemplo: " << argv[0]
                   << " covertype_dataset.csv 100000 1 baseline.model\n";
         return 1;
     }
 
-    std::string dataset_path = argv[1];
+    std::string dataset_path = args.positional(0);
 
     int max_samples = 100000; // padrão
-    if (argc >= 3) {
-        max_samples = std::stoi(argv[2]);
+    if (args.positional_count() >= 2) {
+        max_samples = std::stoi(args.positional(1));
     }
 
     int num_runs = 1; // para treino+salvamento normalmente 1 já basta
-    if (argc >= 4) {
-        num_runs = std::stoi(argv[3]);
+    if (args.positional_count() >= 3) {
+        num_runs = std::stoi(args.positional(2));
     }
 
+    const bool compute_oob = args.has_flag("oob");
+
+    // Warm start: carrega um modelo e acrescenta árvores em vez de retreinar
+    const std::string warm_start_path = args.option("warm-start");
+
     std::string model_path;
-    if (argc >= 5) {
-        model_path = argv[4];
+    if (args.positional_count() >= 4) {
+        model_path = args.positional(3);
     } else {
         model_path = "models/baseline_" + get_filename_only(dataset_path) + ".model";
     }
@@ -48,7 +60,8 @@ int main(int argc, char** argv) {
     std::cout << "Dataset     : " << dataset_path << "\n";
     std::cout << "Max samples : " << max_samples << "\n";
     std::cout << "Num runs    : " << num_runs << "\n";
-    std::cout << "Modelo saida: " << model_path << "\n\n";
+    std::cout << "Modelo saida: " << model_path << "\n";
+    std::cout << "OOB         : " << (compute_oob ? "sim" : "nao") << "\n\n";
 
     // Carregar dataset
     std::vector<std::vector<double>> X;
@@ -56,7 +69,7 @@ int main(int argc, char** argv) {
 
     std::cout << "Carregando dataset...\n";
     try {
-        DataLoader::load_csv(dataset_path, X, y, max_samples);
+        DataLoader::load(dataset_path, X, y, max_samples);
         if (X.empty()) {
             std::cerr << "❌ Dataset vazio apos carregamento!\n";
             return 1;
@@ -73,14 +86,36 @@ int main(int argc, char** argv) {
     const int max_depth         = 8;
     const int min_samples_split = 5;
 
+    const int add_trees = std::stoi(args.option("add-trees", std::to_string(n_trees)));
+    const bool append_to_model = !warm_start_path.empty() && warm_start_path == model_path;
+
+    if (!warm_start_path.empty()) {
+        std::cout << "Warm start  : " << warm_start_path
+                  << " (+" << add_trees << " arvores"
+                  << (append_to_model ? ", append no mesmo arquivo" : "") << ")\n\n";
+    }
+
     double total_train_ms = 0.0;
 
     RandomForestBaseline forest(n_trees, max_depth, min_samples_split);
+    forest.set_oob_score(compute_oob);
+
+    // Telemetria do treino (última iteração), em Chrome trace-event JSON
+    const std::string trace_path = args.option("trace");
+    TrainingTrace trace;
+    if (!trace_path.empty())
+        forest.set_training_trace(&trace);
 
     for (int run = 0; run < num_runs; ++run) {
         std::cout << "Iteracao " << (run + 1) << "/" << num_runs << "...\n";
+        if (!warm_start_path.empty())
+            forest.load_model(warm_start_path);
+
         auto start_train = std::chrono::high_resolution_clock::now();
-        forest.fit(X, y);
+        if (warm_start_path.empty())
+            forest.fit(X, y);
+        else
+            forest.grow(X, y, add_trees);
         auto end_train   = std::chrono::high_resolution_clock::now();
 
         double train_ms =
@@ -91,29 +126,60 @@ int main(int argc, char** argv) {
 
     double avg_train_ms = total_train_ms / num_runs;
 
+    if (!trace_path.empty()) {
+        trace.print_summary(std::cout);
+        std::ofstream trace_file(trace_path);
+        trace.write_chrome_json(trace_file);
+        std::cout << "Trace do treino salvo em: " << trace_path
+                  << " (abrir em chrome://tracing ou ui.perfetto.dev)\n";
+    }
+
     // Salvar modelo treinado (da última execução)
     std::cout << "\nSalvando modelo em: " << model_path << "\n";
-    forest.save_model(model_path);
+    try {
+        forest.save_model(model_path, append_to_model);
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Erro ao salvar modelo: " << e.what() << "\n";
+        return 1;
+    }
 
     std::cout << "\n================= RESULTADOS TREINO =====================\n";
     std::cout << std::setw(25) << "Tempo Treino Medio (ms)"
               << std::setw(20) << std::fixed << std::setprecision(4)
               << avg_train_ms << "\n";
+    if (forest.has_oob_score()) {
+        std::cout << std::setw(25) << "Acuracia OOB (%)"
+                  << std::setw(20) << std::fixed << std::setprecision(4)
+                  << forest.get_oob_accuracy() * 100.0 << "\n";
+        std::cout << std::setw(25) << "Amostras OOB"
+                  << std::setw(20) << forest.get_oob_scored_samples() << "\n";
+        const auto& class_error = forest.get_oob_class_error();
+        for (size_t c = 0; c < class_error.size(); ++c) {
+            std::cout << std::setw(25) << ("Erro OOB classe " + std::to_string(c) + " (%)")
+                      << std::setw(20) << class_error[c] * 100.0 << "\n";
+        }
+    }
     std::cout << "========================================================\n";
 
     // CSV simples com tempo de treino
     std::string csv_name = "results_forest_baseline_train_" +
                            get_filename_only(dataset_path) + ".csv";
     std::ofstream csv(csv_name);
-    csv << "Metodo,Dataset,MaxSamples,NumRuns,TempoTreinoMedio(ms),Modelo\n";
+    csv << "Metodo,Dataset,MaxSamples,NumRuns,TempoTreinoMedio(ms),Modelo,AcuraciaOOB\n";
     csv << "RandomForestBaselineTrain,"
         << get_filename_only(dataset_path) << ","
         << max_samples << ","
         << num_runs << ","
         << avg_train_ms << ","
-        << model_path << "\n";
+        << model_path << ",";
+    if (forest.has_oob_score()) csv << forest.get_oob_accuracy();
+    else                        csv << "NA";
+    csv << "\n";
     csv.close();
 
     std::cout << "Resultados salvos em: " << csv_name << "\n";
+
+    // Contadores de hardware por fase (só com make PERF=1)
+    PERF_REPORT(args.option("perf-json"));
     return 0;
 }
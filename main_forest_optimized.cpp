@@ -1,11 +1,21 @@
 #include "RandomForestOptimized.h"
 #include "DataLoader.h"
+#include "DistributedTraining.h"
+#include "PerfCounters.h"
+#include "ArgParser.h"
 
+#include <algorithm>
 #include <iostream>
 #include <chrono>
+#include <cmath>
+#include <csignal>
 #include <fstream>
 #include <iomanip>
 #include <string>
+#include <sstream>
+
+#include <sys/wait.h>
+#include <unistd.h>
 
 std::string get_filename_only(const std::string& path) {
     std::size_t pos = path.find_last_of("/\\");
@@ -13,34 +23,148 @@ std::string get_filename_only(const std::string& path) {
     return path.substr(pos + 1);
 }
 
+// "1,3,5" -> {1, 3, 5}
+static std::vector<int> parse_int_list(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty()) values.push_back(std::stoi(item));
+    return values;
+}
+
+// Nomes das colunas de features (cabeçalho do CSV; vazio no binário)
+static std::vector<std::string> read_feature_names(const std::string& path) {
+    std::vector<std::string> names;
+    if (DataLoader::is_binary(path)) return names;
+    std::ifstream file(path);
+    std::string header, name;
+    std::getline(file, header);
+    std::stringstream ss(header);
+    while (std::getline(ss, name, ',')) names.push_back(name);
+    if (!names.empty()) names.pop_back();   // última coluna = label
+    return names;
+}
+
+// Importância por feature (ordem das colunas) e resumo no terminal: as
+// mais importantes e a lista de colunas usadas para o --features do
+// forest_optimized_predict
+static void export_importance(const RandomForestOptimized& forest,
+                              const std::vector<std::string>& names,
+                              const std::string& path) {
+    const std::vector<double> importance = forest.get_feature_importance();
+    const std::vector<long long>& splits = forest.get_split_counts();
+    if (importance.empty()) return;
+
+    std::ofstream out(path);
+    out << "Feature,Nome,Importancia,Splits\n";
+    std::string used;
+    for (size_t f = 0; f < importance.size(); ++f) {
+        const std::string name = f < names.size() ? names[f] : "f" + std::to_string(f);
+        out << f << "," << name << "," << importance[f] << "," << splits[f] << "\n";
+        if (splits[f] > 0) used += (used.empty() ? "" : ",") + std::to_string(f);
+    }
+
+    std::vector<size_t> order(importance.size());
+    for (size_t f = 0; f < order.size(); ++f) order[f] = f;
+    std::sort(order.begin(), order.end(),
+              [&](size_t a, size_t b) { return importance[a] > importance[b]; });
+
+    std::cout << "\n================= IMPORTANCIA (Gini) ====================\n";
+    for (size_t k = 0; k < order.size() && k < 10; ++k) {
+        const size_t f = order[k];
+        std::cout << std::setw(25) << (f < names.size() ? names[f] : "f" + std::to_string(f))
+                  << std::setw(12) << std::fixed << std::setprecision(4) << importance[f] * 100.0
+                  << " %" << std::setw(10) << splits[f] << " splits\n";
+    }
+    std::cout << "Features usadas: " << std::count_if(splits.begin(), splits.end(),
+                                                       [](long long n) { return n > 0; })
+              << "/" << importance.size() << " (--features=" << used << ")\n";
+    std::cout << "Importancia salva em: " << path << "\n";
+}
+
 int main(int argc, char** argv) {
     std::cout << "========================================================\n";
     std::cout << "   Random Forest Otimizada: TREINO + SALVAMENTO\n";
     std::cout << "========================================================\n\n";
 
-    if (argc < 2) {
+    ArgParser args(argc, argv);
+
+    if (args.positional_count() < 1) {
         std::cerr << "Uso: " << argv[0]
-                  << " <arquivo_dataset.csv> [max_samples] [num_runs] [modelo_saida]\n";
+                  << " <arquivo_dataset.csv> [max_samples] [num_runs] [modelo_saida] [--oob [--order-trees]]\n"
+                  << "       [--compact [--drop-trees]] [--threads=N] [--categorical=1,3,5]\n"
+                  << "       [--warm-start=<modelo_existente>] [--add-trees=N]\n"
+                  << "       [--perf-json=saida.jsonl]  (build com make PERF=1)\n"
+                  << "       [--trace=treino_trace.json]\n"
+                  << "       [--proba]  (folhas com distribuicao de classes)\n"
+                  << "       [--regression]  (ultima coluna = alvo continuo, criterio MSE)\n"
+                  << "       [--extra-trees]  (thresholds aleatorios, sem sort)\n"
+                  << "       [--level-wise]  (arvores por nivel, colunas pre-ordenadas)\n"
+                  << "       [--importance=importancia.csv]  (importancia Gini por feature)\n"
+                  << "       [--seed=N]  (treino reprodutivel)\n"
+                  << "       [--numa]  (threads fixadas por no, dataset copiado em cada no)\n"
+                  << "       [--workers=N [--spawn] [--socket=/tmp/forest.sock]]  (coordenador multi-processo)\n"
+                  << "       [--worker=/tmp/forest.sock]  (worker: treina a faixa recebida)\n"
+                  << "       [--depth-grid=2,4,6,8 [--tree-grid=10,25,50]]  (acuracia OOB da grade numa passada)\n"
+                  << "       [--compact-format]  (modelo salvo no formato compacto, so inferencia)\n";
         std::cerr << "Exemplo: " << argv[0]
                   << " covertype_dataset.csv 100000 1 optimized.model\n";
         return 1;
     }
 
-    std::string dataset_path = argv[1];
+    std::string dataset_path = args.positional(0);
 
     int max_samples = 100000;
-    if (argc >= 3) {
-        max_samples = std::stoi(argv[2]);
+    if (args.positional_count() >= 2) {
+        max_samples = std::stoi(args.positional(1));
     }
 
     int num_runs = 1;
-    if (argc >= 4) {
-        num_runs = std::stoi(argv[3]);
+    if (args.positional_count() >= 3) {
+        num_runs = std::stoi(args.positional(2));
     }
 
+    // Grade de hiperparâmetros: treina uma vez com a maior profundidade e
+    // o maior número de árvores e avalia todas as combinações via OOB
+    const std::vector<int> depth_grid = parse_int_list(args.option("depth-grid"));
+    const std::vector<int> tree_grid = parse_int_list(args.option("tree-grid"));
+    const bool grid_search = !depth_grid.empty();
+
+    const bool compute_oob = args.has_flag("oob") || grid_search;
+    // ordena as árvores pela acurácia OOB (favorece o early exit na predição)
+    const bool order_trees = args.has_flag("order-trees");
+    // compactação pós-treino (e remoção de árvores redundantes via OOB)
+    const bool compact_model = args.has_flag("compact") || args.has_flag("drop-trees");
+    const bool drop_trees = args.has_flag("drop-trees");
+    const int n_threads = std::stoi(args.option("threads", "1"));
+    // colunas categóricas (ex: adult: --categorical=1,3,5,6,7,8,9,13)
+    const std::vector<int> categorical = parse_int_list(args.option("categorical"));
+    // saída das folhas: distribuição de classes ou regressão
+    const bool probability_leaves = args.has_flag("proba");
+    const bool regression = args.has_flag("regression");
+    const bool extra_trees = args.has_flag("extra-trees");
+    // a grade exige o crescimento por nível (truncamento exato)
+    const bool level_wise = args.has_flag("level-wise") || grid_search;
+    const std::string seed_option = args.option("seed");
+    const bool numa = args.has_flag("numa");
+
+    // Treino em vários processos: --workers=N coordena, --worker=<socket>
+    // treina uma faixa; --spawn cria os N workers locais via fork
+    const int n_workers = std::stoi(args.option("workers", "0"));
+    const std::string worker_socket = args.option("worker");
+    const std::string socket_path = args.option("socket", "/tmp/forest_optimized_train.sock");
+    const bool spawn_workers = args.has_flag("spawn");
+
+    // Modelo em disco no formato compacto (dicionários + varints)
+    const bool compact_format = args.has_flag("compact-format");
+
+    // Warm start: carrega um modelo e acrescenta árvores em vez de retreinar
+    const std::string warm_start_path = args.option("warm-start");
+
     std::string model_path;
-    if (argc >= 5) {
-        model_path = argv[4];
+    if (args.positional_count() >= 4) {
+        model_path = args.positional(3);
     } else {
         model_path = "models/optimized_" + get_filename_only(dataset_path) + ".model";
     }
@@ -48,15 +172,27 @@ int main(int argc, char** argv) {
     std::cout << "Dataset     : " << dataset_path << "\n";
     std::cout << "Max samples : " << max_samples << "\n";
     std::cout << "Num runs    : " << num_runs << "\n";
-    std::cout << "Modelo saida: " << model_path << "\n\n";
+    std::cout << "Modelo saida: " << model_path << "\n";
+    std::cout << "OOB         : " << (compute_oob ? "sim" : "nao") << "\n";
+    std::cout << "Threads     : " << n_threads << "\n";
+    std::cout << "Categoricas : " << (categorical.empty() ? "nenhuma" : args.option("categorical")) << "\n";
+    std::cout << "Folhas      : " << (regression ? "regressao (MSE)"
+                                     : probability_leaves ? "distribuicao de classes" : "classe") << "\n";
+    std::cout << "Splits      : " << (extra_trees ? "ExtraTrees (aleatorios)" : "exatos") << "\n";
+    std::cout << "Crescimento : " << (level_wise ? "por nivel (colunas pre-ordenadas)" : "recursivo") << "\n";
+    std::cout << "NUMA        : " << (numa ? "sim" : "nao") << "\n\n";
 
     // Carregar dataset
     std::vector<std::vector<double>> X;
     std::vector<int> y;
+    std::vector<double> y_reg;   // alvo contínuo (--regression)
 
     std::cout << "Carregando dataset...\n";
     try {
-        DataLoader::load_csv(dataset_path, X, y, max_samples);
+        if (regression)
+            DataLoader::load(dataset_path, X, y_reg, max_samples);
+        else
+            DataLoader::load(dataset_path, X, y, max_samples);
         if (X.empty()) {
             std::cerr << "❌ Dataset vazio apos carregamento!\n";
             return 1;
@@ -69,21 +205,181 @@ int main(int argc, char** argv) {
     }
 
     // Hiperparâmetros (mesmos do baseline para comparação justa)
-    const int n_trees           = 50;
-    const int max_depth         = 8;
+    const int n_trees           = tree_grid.empty() ? 50
+                                  : *std::max_element(tree_grid.begin(), tree_grid.end());
+    const int max_depth         = depth_grid.empty() ? 8
+                                  : *std::max_element(depth_grid.begin(), depth_grid.end());
     const int min_samples_split = 5;
     const int chunk_size        = 100;
 
+    const int add_trees = std::stoi(args.option("add-trees", std::to_string(n_trees)));
+    const bool append_to_model = !warm_start_path.empty() && warm_start_path == model_path;
+    if (compact_format && append_to_model) {
+        std::cerr << "❌ --compact-format nao acrescenta arvores a um modelo existente\n";
+        return 1;
+    }
+
+    if (!warm_start_path.empty()) {
+        std::cout << "Warm start  : " << warm_start_path
+                  << " (+" << add_trees << " arvores"
+                  << (append_to_model ? ", append no mesmo arquivo" : "") << ")\n\n";
+    }
+
     double total_train_ms = 0.0;
 
+    // Mesmas opções para a floresta deste processo e para as faixas dos workers
+    auto configure = [&](RandomForestOptimized& f) {
+        f.set_num_threads(n_threads);
+        f.set_categorical_features(categorical);
+        f.set_probability_leaves(probability_leaves);
+        f.set_extra_trees(extra_trees);
+        f.set_level_wise(level_wise);
+        f.set_numa(numa);
+    };
+
     RandomForestOptimized forest(n_trees, max_depth,
                                  min_samples_split, chunk_size);
+    forest.set_oob_score(compute_oob);
+    configure(forest);
+    if (!seed_option.empty())
+        forest.set_seed(std::stoul(seed_option));
+
+    // Dataset e opções que mudam as árvores: coordenador e workers precisam
+    // concordar para que as faixas formem a mesma floresta
+    ShardConfig shard_config;
+    shard_config.n_samples = (uint32_t)X.size();
+    shard_config.n_features = (uint32_t)X[0].size();
+    shard_config.data_checksum = regression ? DataLoader::checksum(X, y_reg)
+                                            : DataLoader::checksum(X, y);
+    shard_config.config_hash = ShardConfig::hash_options(
+        std::string(regression ? "regression" : probability_leaves ? "proba" : "class") +
+        (extra_trees ? ",extra" : "") + (level_wise ? ",level" : "") +
+        ",cat=" + args.option("categorical") +
+        ",depth=" + std::to_string(max_depth) +
+        ",split=" + std::to_string(min_samples_split) +
+        ",chunk=" + std::to_string(chunk_size));
+
+    // Worker: recebe a faixa, treina só essas árvores e devolve o modelo parcial
+    auto run_worker = [&](const std::string& path) -> int {
+        try {
+            ShardWorker worker(path);
+            const ShardAssignment a = worker.handshake(shard_config);
+            try {
+                RandomForestOptimized shard(a.n_trees, max_depth, min_samples_split, chunk_size);
+                configure(shard);
+                shard.set_seed(a.seed);
+                shard.set_tree_range(a.first_tree, a.forest_trees);
+
+                auto start = std::chrono::high_resolution_clock::now();
+                if (regression) shard.fit_regression(X, y_reg);
+                else            shard.fit(X, y);
+                const double shard_ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::high_resolution_clock::now() - start).count();
+
+                std::ostringstream model(std::ios::binary);
+                shard.save_model(model);
+                worker.send_model(model.str());
+                std::cout << "Worker " << getpid() << ": arvores [" << a.first_tree << ", "
+                          << a.first_tree + a.n_trees << ") em " << shard_ms << " ms\n";
+            } catch (const std::exception& e) {
+                worker.send_error(e.what());
+                throw;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Worker: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    };
+
+    if (!worker_socket.empty())
+        return run_worker(worker_socket);
+
+    // Telemetria do treino (última iteração), em Chrome trace-event JSON
+    const std::string trace_path = args.option("trace");
+    TrainingTrace trace;
+    if (!trace_path.empty())
+        forest.set_training_trace(&trace);
+
+    if (n_workers > 0) {
+        if (compute_oob || !warm_start_path.empty() || compact_model) {
+            std::cerr << "❌ --workers nao suporta --oob, --depth-grid, --warm-start nem --compact\n";
+            return 1;
+        }
+        // todos os processos precisam da mesma semente
+        const unsigned int seed = seed_option.empty() ? forest.get_seed()
+                                                      : (unsigned int)std::stoul(seed_option);
+        std::vector<pid_t> children;
+        auto start_train = std::chrono::high_resolution_clock::now();
+        try {
+            ShardCoordinator coordinator(socket_path, n_workers);
+            std::cout << "Coordenador : " << socket_path << " (" << n_workers << " workers"
+                      << (spawn_workers ? ", locais" : "") << ")\n";
+            if (spawn_workers) {
+                // filhos herdam o dataset já carregado (copy-on-write)
+                std::cout.flush();
+                for (int k = 0; k < n_workers; ++k) {
+                    const pid_t pid = fork();
+                    if (pid < 0) throw std::runtime_error("fork falhou");
+                    if (pid == 0) {
+                        const int rc = run_worker(socket_path);
+                        std::cout.flush();
+                        _exit(rc);
+                    }
+                    children.push_back(pid);
+                }
+            }
+
+            coordinator.assign(shard_config, n_trees, seed);
+            const std::vector<std::string> parts = coordinator.collect();
 
-    for (int run = 0; run < num_runs; ++run) {
+            std::vector<std::istringstream> streams;
+            std::vector<std::istream*> inputs;
+            streams.reserve(parts.size());
+            for (const std::string& part : parts) {
+                streams.emplace_back(part, std::ios::binary);
+                inputs.push_back(&streams.back());
+            }
+            std::stringstream merged(std::ios::in | std::ios::out | std::ios::binary);
+            RandomForestOptimized::merge_models(inputs, merged);
+            merged.seekg(0);
+            forest.load_model(merged);
+
+            for (const ShardAssignment& a : coordinator.get_assignments())
+                std::cout << "  Faixa: arvores [" << a.first_tree << ", "
+                          << a.first_tree + a.n_trees << ")\n";
+        } catch (const std::exception& e) {
+            for (pid_t pid : children) kill(pid, SIGTERM);
+            for (pid_t pid : children) waitpid(pid, nullptr, 0);
+            std::cerr << "❌ Erro no treino distribuido: " << e.what() << "\n";
+            return 1;
+        }
+        for (pid_t pid : children) waitpid(pid, nullptr, 0);
+
+        total_train_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start_train).count();
+        num_runs = 1;
+        std::cout << "  Tempo treino: " << total_train_ms << " ms (semente " << seed << ")\n";
+    }
+
+    for (int run = 0; n_workers <= 0 && run < num_runs; ++run) {
         std::cout << "Iteracao " << (run + 1) << "/" << num_runs << "...\n";
 
+        if (!warm_start_path.empty())
+            forest.load_model(warm_start_path);
+
         auto start_train = std::chrono::high_resolution_clock::now();
-        forest.fit(X, y);
+        try {
+            if (regression && warm_start_path.empty())
+                forest.fit_regression(X, y_reg);
+            else if (warm_start_path.empty())
+                forest.fit(X, y);
+            else
+                forest.grow(X, y, add_trees);
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Erro no treino: " << e.what() << "\n";
+            return 1;
+        }
         auto end_train   = std::chrono::high_resolution_clock::now();
 
         double train_ms =
@@ -95,27 +391,169 @@ int main(int argc, char** argv) {
 
     double avg_train_ms = total_train_ms / num_runs;
 
-    std::cout << "\nSalvando modelo em: " << model_path << "\n";
-    forest.save_model(model_path);
+    if (!trace_path.empty()) {
+        trace.print_summary(std::cout);
+        std::ofstream trace_file(trace_path);
+        trace.write_chrome_json(trace_file);
+        std::cout << "Trace do treino salvo em: " << trace_path
+                  << " (abrir em chrome://tracing ou ui.perfetto.dev)\n";
+    }
+
+    if (grid_search) {
+        if (!warm_start_path.empty() || regression) {
+            std::cerr << "❌ --depth-grid nao suporta --warm-start nem --regression\n";
+            return 1;
+        }
+        auto start_grid = std::chrono::high_resolution_clock::now();
+        RandomForestOptimized::DepthGrid grid;
+        try {
+            grid = forest.oob_depth_grid(X, y, depth_grid, tree_grid);
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Erro na grade: " << e.what() << "\n";
+            return 1;
+        }
+        double grid_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start_grid).count();
+
+        std::cout << "\n================= GRADE OOB (acuracia %) ================\n";
+        std::cout << std::setw(10) << "Arv\\Prof";
+        for (int d : grid.depths) std::cout << std::setw(10) << d;
+        std::cout << std::setw(12) << "Amostras\n";
+        std::cout << std::fixed << std::setprecision(4);
+        for (size_t t = 0; t < grid.tree_counts.size(); ++t) {
+            std::cout << std::setw(10) << grid.tree_counts[t];
+            for (size_t d = 0; d < grid.depths.size(); ++d)
+                std::cout << std::setw(10) << grid.at(t, d) * 100.0;
+            std::cout << std::setw(11) << grid.scored_samples[t] << "\n";
+        }
+        std::cout << "Grade avaliada em " << grid_ms << " ms ("
+                  << grid.depths.size() * grid.tree_counts.size()
+                  << " combinacoes, 1 treino)\n";
+
+        std::string grid_csv_name = "results_grid_optimized_" +
+                                    get_filename_only(dataset_path) + ".csv";
+        std::ofstream grid_csv(grid_csv_name);
+        grid_csv << "Metodo,Dataset,Arvores,Profundidade,AcuraciaOOB,AmostrasOOB,TempoTreino(ms),TempoGrade(ms)\n";
+        for (size_t t = 0; t < grid.tree_counts.size(); ++t)
+            for (size_t d = 0; d < grid.depths.size(); ++d)
+                grid_csv << "RandomForestOptimizedGrid," << get_filename_only(dataset_path) << ","
+                         << grid.tree_counts[t] << "," << grid.depths[d] << ","
+                         << grid.at(t, d) << "," << grid.scored_samples[t] << ","
+                         << total_train_ms / num_runs << "," << grid_ms << "\n";
+        std::cout << "Grade salva em: " << grid_csv_name << "\n";
+    }
+
+    if (order_trees) {
+        if (forest.order_trees_by_quality())
+            std::cout << "\nArvores ordenadas pela acuracia OOB.\n";
+        else
+            std::cout << "\n⚠ --order-trees exige --oob (ordem original mantida).\n";
+    }
+
+    if (compact_model) {
+        auto time_predict = [&]() {
+            auto start = std::chrono::high_resolution_clock::now();
+            if (forest.is_regression()) forest.predict_regression(X);
+            else                        forest.predict(X);
+            auto end = std::chrono::high_resolution_clock::now();
+            return std::chrono::duration<double, std::milli>(end - start).count();
+        };
+
+        double pred_before_ms = time_predict();
+        auto report = forest.compact(X, y, drop_trees);
+        double pred_after_ms = time_predict();
+
+        std::cout << "\n================= COMPACTACAO ===========================\n";
+        std::cout << std::setw(25) << "Arvores"
+                  << std::setw(12) << report.trees_before << " -> " << report.trees_after << "\n";
+        std::cout << std::setw(25) << "Nos"
+                  << std::setw(12) << report.nodes_before << " -> " << report.nodes_after
+                  << " (" << report.flat_nodes << " internos achatados)\n";
+        std::cout << std::setw(25) << "Modelo serializado (B)"
+                  << std::setw(12) << report.model_bytes_before << " -> " << report.model_bytes_after << "\n";
+        std::cout << std::setw(25) << "Forma achatada (B)"
+                  << std::setw(12) << report.flat_bytes << "\n";
+        std::cout << std::setw(25) << "Predicao no treino (ms)"
+                  << std::setw(12) << std::fixed << std::setprecision(4) << pred_before_ms
+                  << " -> " << pred_after_ms
+                  << " (speedup " << pred_before_ms / pred_after_ms << "x)\n";
+        if (drop_trees && !report.oob_trees_checked)
+            std::cout << "⚠ --drop-trees exige --oob (nenhuma arvore removida).\n";
+        if (forest.has_oob_score())
+            std::cout << std::setw(25) << "Acuracia OOB (%)"
+                      << std::setw(12) << forest.get_oob_accuracy() * 100.0 << "\n";
+    }
+
+    std::cout << "\nSalvando modelo em: " << model_path
+              << (compact_format ? " (formato compacto)" : "") << "\n";
+    try {
+        if (compact_format) {
+            std::ostringstream pointer_format(std::ios::binary);
+            forest.save_model(pointer_format);
+            forest.save_compact_model(model_path);
+            std::ifstream saved(model_path, std::ios::binary | std::ios::ate);
+            std::cout << "  " << pointer_format.str().size() << " B no formato padrao -> "
+                      << saved.tellg() << " B\n";
+        } else {
+            forest.save_model(model_path, append_to_model);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Erro ao salvar modelo: " << e.what() << "\n";
+        return 1;
+    }
 
     std::cout << "\n================= RESULTADOS TREINO =====================\n";
     std::cout << std::setw(25) << "Tempo Treino Medio (ms)"
               << std::setw(20) << std::fixed << std::setprecision(4)
               << avg_train_ms << "\n";
+    if (forest.has_oob_score()) {
+        std::cout << std::setw(25) << "Acuracia OOB (%)"
+                  << std::setw(20) << std::fixed << std::setprecision(4)
+                  << forest.get_oob_accuracy() * 100.0 << "\n";
+        std::cout << std::setw(25) << "Amostras OOB"
+                  << std::setw(20) << forest.get_oob_scored_samples() << "\n";
+        const auto& class_error = forest.get_oob_class_error();
+        for (size_t c = 0; c < class_error.size(); ++c) {
+            std::cout << std::setw(25) << ("Erro OOB classe " + std::to_string(c) + " (%)")
+                      << std::setw(20) << class_error[c] * 100.0 << "\n";
+        }
+    }
+    if (forest.is_regression()) {
+        // erro no próprio treino (referência rápida; holdout no predict)
+        const std::vector<double> pred = forest.predict_regression(X);
+        double sse = 0.0;
+        for (size_t i = 0; i < pred.size(); ++i)
+            sse += (pred[i] - y_reg[i]) * (pred[i] - y_reg[i]);
+        std::cout << std::setw(25) << "RMSE no treino"
+                  << std::setw(20) << std::sqrt(sse / pred.size()) << "\n";
+    }
     std::cout << "========================================================\n";
 
+    if (numa)
+        forest.get_numa_topology().print_summary(std::cout, forest.numa_replica_bytes());
+
+    export_importance(forest, read_feature_names(dataset_path),
+                      args.option("importance", "importance_optimized_" +
+                                                get_filename_only(dataset_path) + ".csv"));
+
     std::string csv_name = "results_forest_optimized_train_" +
                            get_filename_only(dataset_path) + ".csv";
     std::ofstream csv(csv_name);
-    csv << "Metodo,Dataset,MaxSamples,NumRuns,TempoTreinoMedio(ms),Modelo\n";
-    csv << "RandomForestOptimizedTrain,"
+    csv << "Metodo,Dataset,MaxSamples,NumRuns,TempoTreinoMedio(ms),Modelo,AcuraciaOOB\n";
+    csv << (n_workers > 0 ? "RandomForestOptimizedTrainDistribuido," : "RandomForestOptimizedTrain,")
         << get_filename_only(dataset_path) << ","
         << max_samples << ","
         << num_runs << ","
         << avg_train_ms << ","
-        << model_path << "\n";
+        << model_path << ",";
+    if (forest.has_oob_score()) csv << forest.get_oob_accuracy();
+    else                        csv << "NA";
+    csv << "\n";
     csv.close();
 
     std::cout << "Resultados salvos em: " << csv_name << "\n";
+
+    // Contadores de hardware por fase (só com make PERF=1)
+    PERF_REPORT(args.option("perf-json"));
     return 0;
 }
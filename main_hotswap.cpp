@@ -0,0 +1,294 @@
+#include "HotSwapForest.h"
+#include "DataLoader.h"
+#include "ArgParser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+
+// ------------------------------------------------------------
+// forest_hotswap: teste de estresse da troca de modelos. Leitores
+// predizem lotes aleatórios sem parar enquanto um escritor recarrega e
+// publica os modelos em rodízio. Compara a latência dos leitores sem
+// trocas, com a HotSwapForest e com a troca por lock (load_model no
+// mesmo objeto, leitores esperando), e confere cada lote contra a
+// predição do modelo da versão usada.
+// ------------------------------------------------------------
+
+static std::string get_filename_only(const std::string& path) {
+    std::size_t pos = path.find_last_of("/\\");
+    if (pos == std::string::npos) return path;
+    return path.substr(pos + 1);
+}
+
+using Clock = std::chrono::steady_clock;
+
+struct PhaseResult {
+    std::string name;
+    std::vector<double> latencies_us;   // ordenadas
+    int swaps = 0;
+    long long mismatches = 0;
+
+    double percentile(double p) const {
+        if (latencies_us.empty()) return 0.0;
+        size_t k = std::min(latencies_us.size() - 1, (size_t)(p * latencies_us.size()));
+        return latencies_us[k];
+    }
+    double max() const { return latencies_us.empty() ? 0.0 : latencies_us.back(); }
+};
+
+// Latência de uma fase relativa à fase sem trocas (0 sem referência)
+static double tail_ratio(double value, double baseline) {
+    return baseline > 0.0 ? value / baseline : 0.0;
+}
+
+// Troca por lock: o modelo é recarregado no próprio objeto e os
+// leitores esperam o fim da carga. A catraca impede que o fluxo
+// contínuo de leitores deixe o escritor esperando para sempre.
+class LockedForest {
+public:
+    explicit LockedForest(const std::string& path) : forest(1, 1, 1, 1) { load(path); }
+
+    void load(const std::string& path) {
+        std::lock_guard<std::mutex> gate(turnstile);
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        forest.load_model(path);
+        forest.compact();
+        forest.set_thread_pool(&pool);
+    }
+
+    std::vector<int> predict(const std::vector<std::vector<double>>& X) const {
+        { std::lock_guard<std::mutex> gate(turnstile); }
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return forest.predict(X);
+    }
+
+private:
+    mutable std::mutex turnstile;
+    mutable std::shared_mutex mutex;
+    ThreadPool pool{1};
+    RandomForestOptimized forest;
+};
+
+// Leitores predizendo lotes até `stop`; o escritor roda em paralelo
+template <class PredictFn, class SwapFn>
+static PhaseResult run_phase(const std::string& name,
+                             const std::vector<std::vector<double>>& X,
+                             int n_readers, int batch, int duration_ms, int swap_interval_ms,
+                             PredictFn predict_batch, SwapFn swap)
+{
+    std::atomic<bool> stop{false};
+    std::vector<std::vector<double>> latencies(n_readers);
+    std::vector<long long> mismatches(n_readers, 0);
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < n_readers; r++)
+        readers.emplace_back([&, r] {
+            std::mt19937 rng(1234 + r);
+            std::uniform_int_distribution<int> start_dist(0, (int)X.size() - batch);
+            std::vector<std::vector<double>> rows(batch);
+            while (!stop.load(std::memory_order_relaxed)) {
+                const int start = start_dist(rng);
+                std::copy(X.begin() + start, X.begin() + start + batch, rows.begin());
+                auto t0 = Clock::now();
+                mismatches[r] += predict_batch(rows, start);
+                latencies[r].push_back(
+                    std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+            }
+        });
+
+    // Escritor: uma troca por intervalo até o fim da fase
+    PhaseResult result;
+    result.name = name;
+    const auto deadline = Clock::now() + std::chrono::milliseconds(duration_ms);
+    while (Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(swap_interval_ms));
+        if (swap(result.swaps)) result.swaps++;
+    }
+    stop = true;
+    for (auto& t : readers) t.join();
+
+    for (int r = 0; r < n_readers; r++) {
+        result.latencies_us.insert(result.latencies_us.end(), latencies[r].begin(), latencies[r].end());
+        result.mismatches += mismatches[r];
+    }
+    std::sort(result.latencies_us.begin(), result.latencies_us.end());
+    return result;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "========================================================\n";
+    std::cout << "   Random Forest Otimizada: TROCA DE MODELOS (HOT-SWAP)\n";
+    std::cout << "========================================================\n\n";
+
+    ArgParser args(argc, argv);
+
+    if (args.positional_count() < 2) {
+        std::cerr << "Uso: " << argv[0] << " <arquivo_dataset.csv> <modelo1> [modelo2 ...]\n"
+                  << "       [--max-samples=N] [--readers=4] [--batch=16]\n"
+                  << "       [--duration-ms=2000] [--swap-interval-ms=20]\n";
+        std::cerr << "Exemplo: " << argv[0]
+                  << " adult_dataset.csv models/a.model models/b.model --readers=8\n";
+        return 1;
+    }
+
+    const std::string dataset_path = args.positional(0);
+    std::vector<std::string> model_paths;
+    for (size_t k = 1; k < args.positional_count(); k++)
+        model_paths.push_back(args.positional(k));
+    const int max_samples      = std::stoi(args.option("max-samples", "100000"));
+    const int n_readers        = std::max(1, std::stoi(args.option("readers", "4")));
+    const int duration_ms      = std::max(1, std::stoi(args.option("duration-ms", "2000")));
+    const int swap_interval_ms = std::max(1, std::stoi(args.option("swap-interval-ms", "20")));
+    int batch                  = std::max(1, std::stoi(args.option("batch", "16")));
+
+    std::vector<std::vector<double>> X;
+    std::vector<int> y;
+    try {
+        DataLoader::load(dataset_path, X, y, max_samples);
+        if (X.empty()) {
+            std::cerr << "❌ Dataset vazio apos carregamento!\n";
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Erro ao carregar dataset: " << e.what() << "\n";
+        return 1;
+    }
+    batch = std::min<int>(batch, X.size());
+
+    // Predições de referência de cada modelo sobre o dataset inteiro
+    const int n_models = model_paths.size();
+    std::vector<std::vector<int>> reference(n_models);
+    try {
+        for (int m = 0; m < n_models; m++) {
+            RandomForestOptimized forest(1, 1, 1, 1);
+            forest.load_model(model_paths[m]);
+            forest.compact();
+            reference[m] = forest.predict(X);
+            std::cout << "Modelo " << m + 1 << "   : " << model_paths[m] << " ("
+                      << forest.get_num_trees() << " arvores)\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Erro ao carregar modelo: " << e.what() << "\n";
+        return 1;
+    }
+    std::cout << "Dataset    : " << dataset_path << " (" << X.size() << " amostras)\n";
+    std::cout << "Leitores   : " << n_readers << " (lotes de " << batch << " linhas)\n";
+    std::cout << "Fases      : " << duration_ms << " ms, troca a cada "
+              << swap_interval_ms << " ms\n\n";
+
+    auto count_mismatches = [&](const std::vector<int>& pred, int start, int model) {
+        long long wrong = 0;
+        for (int i = 0; i < (int)pred.size(); i++)
+            if (pred[i] != reference[model][start + i]) wrong++;
+        return wrong;
+    };
+
+    std::vector<PhaseResult> phases;
+
+    // 1) HotSwapForest sem trocas (linha de base da latência)
+    {
+        HotSwapForest forest;
+        forest.load(model_paths[0]);
+        phases.push_back(run_phase("sem trocas", X, n_readers, batch, duration_ms, swap_interval_ms,
+            [&](const std::vector<std::vector<double>>& rows, int start) {
+                return count_mismatches(forest.predict(rows), start, 0);
+            },
+            [](int) { return false; }));
+    }
+
+    // 2) HotSwapForest: modelo k carregado do disco e publicado; cada lote
+    //    conferido contra o modelo da versão que o atendeu
+    uint64_t reclaimed = 0;
+    size_t retired_left = 0;
+    {
+        HotSwapForest forest;
+        forest.load(model_paths[0]);   // versão 1 = modelo 0
+        phases.push_back(run_phase("hot-swap", X, n_readers, batch, duration_ms, swap_interval_ms,
+            [&](const std::vector<std::vector<double>>& rows, int start) {
+                uint64_t version = 0;
+                std::vector<int> pred = forest.predict(rows, &version);
+                return count_mismatches(pred, start, (version - 1) % n_models);
+            },
+            [&](int swaps) {
+                forest.load(model_paths[(swaps + 1) % n_models]);
+                return true;
+            }));
+        forest.reclaim();
+        reclaimed = forest.get_num_reclaimed();
+        retired_left = forest.get_num_retired();
+    }
+
+    // 3) Troca por lock (recarga no mesmo objeto)
+    {
+        LockedForest forest(model_paths[0]);
+        phases.push_back(run_phase("lock + load_model", X, n_readers, batch, duration_ms,
+                                   swap_interval_ms,
+            [&](const std::vector<std::vector<double>>& rows, int) {
+                forest.predict(rows);
+                return 0LL;
+            },
+            [&](int swaps) {
+                forest.load(model_paths[(swaps + 1) % n_models]);
+                return true;
+            }));
+    }
+
+    std::cout << "==================== LATENCIA DOS LEITORES (us) =========\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(20) << "Fase" << std::setw(10) << "Lotes" << std::setw(8) << "Trocas"
+              << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+              << std::setw(12) << "max" << "\n";
+    for (const auto& phase : phases)
+        std::cout << std::setw(20) << phase.name << std::setw(10) << phase.latencies_us.size()
+                  << std::setw(8) << phase.swaps
+                  << std::setw(10) << phase.percentile(0.50) << std::setw(10) << phase.percentile(0.99)
+                  << std::setw(10) << phase.percentile(0.999)
+                  << std::setw(12) << phase.max() << "\n";
+
+    // Cauda relativa à fase sem trocas: é o que a troca acrescenta. Só
+    // mede a troca em si se o escritor tiver um núcleo livre; senão inclui
+    // a disputa dele com os leitores pelo processador.
+    const PhaseResult& base = phases[0];
+    const unsigned cpus = std::thread::hardware_concurrency();
+    const bool writer_has_core = cpus > (unsigned)n_readers;
+    std::cout << "Cauda vs sem trocas (x):\n";
+    for (size_t p = 1; p < phases.size(); p++)
+        std::cout << std::setw(20) << phases[p].name
+                  << "  p99 " << tail_ratio(phases[p].percentile(0.99), base.percentile(0.99))
+                  << "  p99.9 " << tail_ratio(phases[p].percentile(0.999), base.percentile(0.999))
+                  << "  max " << tail_ratio(phases[p].max(), base.max()) << "\n";
+    if (!writer_has_core)
+        std::cout << "⚠️  " << cpus << " CPU(s) para " << n_readers << " leitor(es) + escritor: "
+                  << "a cauda inclui a disputa pelo processador (troca sem picos nao verificada)\n";
+    else if (tail_ratio(phases[1].percentile(0.999), base.percentile(0.999)) > 2.0)
+        std::cout << "⚠️  p99.9 do hot-swap acima de 2x a fase sem trocas\n";
+    std::cout << "Divergencias vs modelo da versao: " << phases[1].mismatches << "\n";
+    std::cout << "Snapshots liberados: " << reclaimed << " (pendentes: " << retired_left << ")\n";
+    std::cout << "========================================================\n";
+
+    std::string csv_name = "results_hotswap_" + get_filename_only(dataset_path) + ".csv";
+    std::ofstream csv(csv_name);
+    csv << "Fase,Dataset,Leitores,CPUs,Lote,Lotes,Trocas,p50(us),p99(us),p999(us),max(us),"
+           "p99/sem_trocas,p999/sem_trocas,max/sem_trocas,Divergencias\n";
+    for (const auto& phase : phases)
+        csv << phase.name << "," << get_filename_only(dataset_path) << "," << n_readers << ","
+            << cpus << "," << batch << "," << phase.latencies_us.size() << "," << phase.swaps << ","
+            << phase.percentile(0.50) << "," << phase.percentile(0.99) << ","
+            << phase.percentile(0.999) << "," << phase.max() << ","
+            << tail_ratio(phase.percentile(0.99), base.percentile(0.99)) << ","
+            << tail_ratio(phase.percentile(0.999), base.percentile(0.999)) << ","
+            << tail_ratio(phase.max(), base.max()) << ","
+            << phase.mismatches << "\n";
+    std::cout << "Resultados salvos em: " << csv_name << "\n";
+
+    return phases[1].mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+#include "MultiForest.h"
+#include "DataLoader.h"
+#include "PerfCounters.h"
+#include "ArgParser.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// ------------------------------------------------------------
+// forest_multi_predict: vários modelos (A/B, por segmento) sobre o
+// mesmo dataset numa única carga e numa única passada pelas linhas.
+// Sai uma coluna de predições por modelo.
+// ------------------------------------------------------------
+
+static std::string get_filename_only(const std::string& path) {
+    std::size_t pos = path.find_last_of("/\\");
+    if (pos == std::string::npos) return path;
+    return path.substr(pos + 1);
+}
+
+int main(int argc, char** argv) {
+    std::cout << "========================================================\n";
+    std::cout << "   Random Forest Otimizada: PREDICAO MULTIPLOS MODELOS\n";
+    std::cout << "========================================================\n\n";
+
+    ArgParser args(argc, argv);
+
+    if (args.positional_count() < 2) {
+        std::cerr << "Uso: " << argv[0] << " <arquivo_dataset.csv> <modelo1> [modelo2 ...]\n"
+                  << "       [--max-samples=N] [--threads=N] [--runs=3]\n"
+                  << "       [--flat]  (sem quantizacao compartilhada)\n"
+                  << "       [--output=predicoes.csv]  (uma coluna por modelo)\n";
+        std::cerr << "Exemplo: " << argv[0]
+                  << " adult_dataset.csv models/a.model models/b.model --threads=4\n";
+        return 1;
+    }
+
+    const std::string dataset_path = args.positional(0);
+    const int max_samples = std::stoi(args.option("max-samples", "100000"));
+    const int n_threads   = std::stoi(args.option("threads", "1"));
+    const int num_runs    = std::max(1, std::stoi(args.option("runs", "3")));
+    const bool shared_quantization = !args.has_flag("flat");
+    const std::string output_path = args.option("output", "predicoes_multi_" +
+                                                          get_filename_only(dataset_path));
+
+    // Modelos (nome da coluna = nome do arquivo)
+    MultiForest scorer;
+    scorer.set_num_threads(n_threads);
+    scorer.set_shared_quantization(shared_quantization);
+    try {
+        for (size_t k = 1; k < args.positional_count(); k++) {
+            const std::string path = args.positional(k);
+            scorer.add_model(get_filename_only(path), path);
+            const RandomForestOptimized& model = scorer.get_model(scorer.get_num_models() - 1);
+            std::cout << "Modelo " << k << "   : " << path << " (" << model.get_num_trees()
+                      << " arvores, " << model.get_num_classes() << " classes)\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Erro ao carregar modelo: " << e.what() << "\n";
+        return 1;
+    }
+    std::cout << "Dataset    : " << dataset_path << "\n";
+    std::cout << "Threads    : " << n_threads << "\n";
+    std::cout << "Quantizacao: ";
+    if (scorer.uses_shared_quantization())
+        std::cout << "compartilhada (1 por linha para " << scorer.get_num_models() << " modelos)\n";
+    else if (shared_quantization)
+        std::cout << "indisponivel (" << scorer.get_quantization_error() << "), forma achatada\n";
+    else
+        std::cout << "desligada, forma achatada\n";
+    std::cout << "\n";
+
+    std::vector<std::vector<double>> X;
+    std::vector<int> y;
+    std::cout << "Carregando dataset...\n";
+    double load_ms = 0.0;
+    try {
+        auto load_start = std::chrono::high_resolution_clock::now();
+        DataLoader::load(dataset_path, X, y, max_samples);
+        load_ms = std::chrono::duration<double, std::milli>(
+                      std::chrono::high_resolution_clock::now() - load_start).count();
+        if (X.empty()) {
+            std::cerr << "❌ Dataset vazio apos carregamento!\n";
+            return 1;
+        }
+        std::cout << "Dataset carregado: " << X.size() << " amostras, "
+                  << X[0].size() << " features\n\n";
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Erro ao carregar dataset: " << e.what() << "\n";
+        return 1;
+    }
+
+    // Referência: cada modelo numa passada própria (como invocações
+    // separadas, sem recarregar o CSV)
+    const int n_models = scorer.get_num_models();
+    double total_multi_ms = 0.0, total_separate_ms = 0.0;
+    std::vector<std::vector<int>> predictions;
+    size_t mismatches = 0;
+    for (int run = 0; run < num_runs; run++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        predictions = scorer.predict(X);
+        auto mid = std::chrono::high_resolution_clock::now();
+        std::vector<std::vector<int>> separate(n_models);
+        for (int m = 0; m < n_models; m++) {
+            auto& model = const_cast<RandomForestOptimized&>(scorer.get_model(m));
+            model.set_num_threads(n_threads);
+            separate[m] = model.predict(X);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        total_multi_ms += std::chrono::duration<double, std::milli>(mid - start).count();
+        total_separate_ms += std::chrono::duration<double, std::milli>(end - mid).count();
+        for (int m = 0; m < n_models; m++)
+            for (size_t i = 0; i < X.size(); i++)
+                if (separate[m][i] != predictions[m][i]) mismatches++;
+    }
+    const double multi_ms = total_multi_ms / num_runs;
+    const double separate_ms = total_separate_ms / num_runs;
+
+    std::cout << "================= RESULTADOS MULTIPLOS MODELOS ==========\n";
+    std::cout << std::fixed << std::setprecision(4);
+    for (int m = 0; m < n_models; m++) {
+        size_t correct = 0;
+        for (size_t i = 0; i < X.size(); i++)
+            if (predictions[m][i] == y[i]) correct++;
+        std::cout << std::setw(30) << scorer.get_name(m)
+                  << std::setw(14) << (double)correct / X.size() * 100.0 << " % acuracia\n";
+    }
+    // Invocações separadas releem o CSV uma vez por modelo
+    const double multi_total = load_ms + multi_ms;
+    const double separate_total = n_models * load_ms + separate_ms;
+    std::cout << std::setw(30) << "Leitura do CSV (ms)" << std::setw(14) << load_ms << "\n";
+    std::cout << std::setw(30) << "Passada unica (ms)" << std::setw(14) << multi_ms << "\n";
+    std::cout << std::setw(30) << "Um modelo por vez (ms)" << std::setw(14) << separate_ms
+              << " (" << separate_ms / multi_ms << "x)\n";
+    std::cout << std::setw(30) << "Total, 1 leitura (ms)" << std::setw(14) << multi_total << "\n";
+    std::cout << std::setw(30) << "Total, 1 leitura/modelo (ms)" << std::setw(14) << separate_total
+              << " (" << separate_total / multi_total << "x)\n";
+    std::cout << std::setw(30) << "Divergencias vs separado" << std::setw(14) << mismatches << "\n";
+    std::cout << "========================================================\n";
+
+    // Predições: rótulo e uma coluna por modelo
+    std::ofstream out(output_path);
+    out << "Linha,Rotulo";
+    for (int m = 0; m < n_models; m++) out << "," << scorer.get_name(m);
+    out << "\n";
+    for (size_t i = 0; i < X.size(); i++) {
+        out << i << "," << y[i];
+        for (int m = 0; m < n_models; m++) out << "," << predictions[m][i];
+        out << "\n";
+    }
+    std::cout << "Predicoes salvas em: " << output_path << "\n";
+
+    std::string csv_name = "results_multi_predict_" + get_filename_only(dataset_path) + ".csv";
+    std::ofstream csv(csv_name);
+    csv << "Metodo,Dataset,Amostras,Modelos,Quantizacao,TempoLeitura(ms),TempoPassadaUnica(ms),TempoSeparado(ms)\n";
+    csv << "RandomForestOptimizedMulti," << get_filename_only(dataset_path) << "," << X.size() << ","
+        << n_models << "," << (scorer.uses_shared_quantization() ? "compartilhada" : "achatada") << ","
+        << load_ms << "," << multi_ms << "," << separate_ms << "\n";
+    std::cout << "Resultados salvos em: " << csv_name << "\n";
+
+    PERF_REPORT(args.option("perf-json"));
+    return 0;
+}
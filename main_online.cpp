@@ -0,0 +1,215 @@
+#include "HoeffdingForest.h"
+#include "DataLoader.h"
+#include "ArgParser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+
+// ------------------------------------------------------------
+// forest_online: floresta aprendida em fluxo (HoeffdingForest). As
+// linhas de treino chegam em lotes: cada lote é predito antes de ser
+// aprendido (acurácia prequencial) e a vazão das atualizações sai em
+// linhas/s por núcleo. No fim, acurácia no holdout, exportação para o
+// formato do RandomForestOptimized (predições conferidas) e comparação
+// com um fit em lote nas mesmas linhas.
+// ------------------------------------------------------------
+
+static std::string get_filename_only(const std::string& path) {
+    std::size_t pos = path.find_last_of("/\\");
+    if (pos == std::string::npos) return path;
+    return path.substr(pos + 1);
+}
+
+static double accuracy(const std::vector<int>& pred, const std::vector<int>& y) {
+    size_t correct = 0;
+    for (size_t i = 0; i < y.size(); i++)
+        if (pred[i] == y[i]) correct++;
+    return y.empty() ? 0.0 : (double)correct / y.size();
+}
+
+int main(int argc, char** argv) {
+    std::cout << "========================================================\n";
+    std::cout << "   Random Forest Otimizada: APRENDIZADO EM FLUXO\n";
+    std::cout << "========================================================\n\n";
+
+    ArgParser args(argc, argv);
+
+    if (args.positional_count() < 1) {
+        std::cerr << "Uso: " << argv[0] << " <arquivo_dataset.csv> [max_samples]\n"
+                  << "       [--trees=10] [--depth=10] [--grace=200] [--delta=1e-7] [--tau=0.05]\n"
+                  << "       [--batch=1000] [--threads=N] [--seed=42] [--test-fraction=0.2]\n"
+                  << "       [--no-shuffle]  (linhas na ordem do arquivo)\n"
+                  << "       [--warm-start=modelo.model]  (continua um modelo em lote ou online)\n"
+                  << "       [--model=saida.model]  (formato do RandomForestOptimized)\n"
+                  << "       [--no-batch]  (sem a comparacao com o fit em lote)\n";
+        std::cerr << "Exemplo: " << argv[0] << " adult_dataset.csv 45222 --trees=20 --threads=4\n";
+        return 1;
+    }
+
+    const std::string dataset_path = args.positional(0);
+    const int max_samples    = args.positional_count() >= 2 ? std::stoi(args.positional(1)) : 100000;
+    const int n_trees        = std::stoi(args.option("trees", "10"));
+    const int max_depth      = std::stoi(args.option("depth", "10"));
+    const double grace       = std::stod(args.option("grace", "200"));
+    const double delta       = std::stod(args.option("delta", "1e-7"));
+    const double tau         = std::stod(args.option("tau", "0.05"));
+    const int batch          = std::max(1, std::stoi(args.option("batch", "1000")));
+    const int n_threads      = std::max(1, std::stoi(args.option("threads", "1")));
+    const unsigned seed      = std::stoul(args.option("seed", "42"));
+    const double test_fraction = std::stod(args.option("test-fraction", "0.2"));
+    const std::string warm_start = args.option("warm-start");
+    const std::string model_path = args.option("model");
+
+    std::vector<std::vector<double>> X;
+    std::vector<int> y;
+    try {
+        DataLoader::load(dataset_path, X, y, max_samples);
+        if (X.empty()) {
+            std::cerr << "❌ Dataset vazio apos carregamento!\n";
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Erro ao carregar dataset: " << e.what() << "\n";
+        return 1;
+    }
+
+    // Ordem do fluxo (embaralhada: alguns datasets vêm ordenados pela classe)
+    std::vector<int> order(X.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (!args.has_flag("no-shuffle")) {
+        std::mt19937 rng(seed);
+        std::shuffle(order.begin(), order.end(), rng);
+    }
+    const size_t n_test = std::min(X.size() - 1, (size_t)(X.size() * test_fraction));
+    const size_t n_train = X.size() - n_test;
+    std::vector<std::vector<double>> X_train, X_test;
+    std::vector<int> y_train, y_test;
+    for (size_t k = 0; k < X.size(); k++) {
+        auto& Xs = k < n_train ? X_train : X_test;
+        auto& ys = k < n_train ? y_train : y_test;
+        Xs.push_back(X[order[k]]);
+        ys.push_back(y[order[k]]);
+    }
+    const int n_classes = *std::max_element(y.begin(), y.end()) + 1;
+
+    HoeffdingForest online(n_trees, max_depth, n_classes);
+    online.set_seed(seed);
+    online.set_num_threads(n_threads);
+    online.set_grace_period(grace);
+    online.set_split_confidence(delta);
+    online.set_tie_threshold(tau);
+    try {
+        if (!warm_start.empty()) {
+            online.load_model(warm_start);
+            std::cout << "Modelo inicial: " << warm_start << " (" << online.get_num_trees()
+                      << " arvores, " << online.get_num_splits() << " splits)\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Erro ao carregar modelo: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::cout << "Dataset    : " << dataset_path << " (" << n_train << " no fluxo, "
+              << n_test << " no holdout)\n";
+    std::cout << "Floresta   : " << online.get_num_trees() << " arvores, profundidade " << max_depth
+              << ", grace " << grace << ", delta " << delta << ", tau " << tau << "\n";
+    std::cout << "Lotes      : " << batch << " linhas, " << n_threads << " thread(s)\n\n";
+
+    // Fluxo: prediz o lote (prequencial) e então aprende com ele
+    double update_ms = 0.0;
+    size_t prequential_correct = 0;
+    std::vector<std::vector<double>> X_batch;
+    std::vector<int> y_batch;
+    for (size_t begin = 0; begin < n_train; begin += batch) {
+        const size_t end = std::min(n_train, begin + batch);
+        X_batch.assign(X_train.begin() + begin, X_train.begin() + end);
+        y_batch.assign(y_train.begin() + begin, y_train.begin() + end);
+
+        std::vector<int> pred = online.predict(X_batch);
+        for (size_t i = 0; i < pred.size(); i++)
+            if (pred[i] == y_batch[i]) prequential_correct++;
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        try {
+            online.partial_fit(X_batch, y_batch);
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Erro na atualizacao: " << e.what() << "\n";
+            return 1;
+        }
+        update_ms += std::chrono::duration<double, std::milli>(
+                         std::chrono::high_resolution_clock::now() - t0).count();
+    }
+    const double rows_per_s = n_train / (update_ms / 1000.0);
+    const double online_accuracy = accuracy(online.predict(X_test), y_test);
+
+    // Exportação: mesmo formato de nós/arquivo do lote
+    RandomForestOptimized exported(online.get_num_trees(), max_depth, 2);
+    online.export_forest(exported);
+    std::vector<int> online_pred = online.predict(X_test);
+    size_t export_mismatches = 0;
+    std::vector<int> exported_pred = exported.predict(X_test);
+    for (size_t i = 0; i < y_test.size(); i++)
+        if (exported_pred[i] != online_pred[i]) export_mismatches++;
+    if (!model_path.empty()) {
+        online.save_model(model_path);
+        RandomForestOptimized reloaded(1, 1, 1, 1);
+        reloaded.load_model(model_path);
+        std::vector<int> reloaded_pred = reloaded.predict(X_test);
+        for (size_t i = 0; i < y_test.size(); i++)
+            if (reloaded_pred[i] != online_pred[i]) export_mismatches++;
+    }
+
+    std::cout << "==================== RESULTADOS EM FLUXO ================\n";
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << std::setw(32) << "Tempo de atualizacao (ms)" << std::setw(14) << update_ms << "\n";
+    std::cout << std::setw(32) << "Linhas/s" << std::setw(14) << rows_per_s << "\n";
+    std::cout << std::setw(32) << "Linhas/s por nucleo" << std::setw(14) << rows_per_s / n_threads << "\n";
+    std::cout << std::setw(32) << "Linhas x arvores/s" << std::setw(14)
+              << rows_per_s * online.get_num_trees() << "\n";
+    std::cout << std::setw(32) << "Acuracia prequencial (%)" << std::setw(14)
+              << 100.0 * prequential_correct / n_train << "\n";
+    std::cout << std::setw(32) << "Acuracia holdout (%)" << std::setw(14) << online_accuracy * 100.0 << "\n";
+    std::cout << std::setw(32) << "Splits / folhas" << std::setw(14) << online.get_num_splits()
+              << " / " << online.get_num_leaves() << "\n";
+    std::cout << std::setw(32) << "Divergencias do modelo exportado" << std::setw(14) << export_mismatches << "\n";
+    if (!model_path.empty())
+        std::cout << "Modelo salvo em: " << model_path << "\n";
+
+    // Lote: retreino completo nas mesmas linhas
+    double batch_ms = 0.0, batch_accuracy = 0.0;
+    if (!args.has_flag("no-batch")) {
+        RandomForestOptimized forest(online.get_num_trees(), max_depth, 2);
+        forest.set_seed(seed);
+        forest.set_num_threads(n_threads);
+        auto t0 = std::chrono::high_resolution_clock::now();
+        forest.fit(X_train, y_train);
+        batch_ms = std::chrono::duration<double, std::milli>(
+                       std::chrono::high_resolution_clock::now() - t0).count();
+        batch_accuracy = accuracy(forest.predict(X_test), y_test);
+        std::cout << std::setw(32) << "Fit em lote (ms)" << std::setw(14) << batch_ms << "\n";
+        std::cout << std::setw(32) << "Acuracia holdout lote (%)" << std::setw(14)
+                  << batch_accuracy * 100.0 << "\n";
+        std::cout << std::setw(32) << "Atualizacao de 1 lote (ms)" << std::setw(14)
+                  << update_ms * batch / n_train << " (" << batch_ms / (update_ms * batch / n_train)
+                  << "x menos que o refit)\n";
+    }
+    std::cout << "========================================================\n";
+
+    std::string csv_name = "results_online_" + get_filename_only(dataset_path) + ".csv";
+    std::ofstream csv(csv_name);
+    csv << "Metodo,Dataset,LinhasFluxo,Arvores,Threads,TempoAtualizacao(ms),LinhasPorSegundo,"
+           "LinhasPorSegundoPorNucleo,AcuraciaPrequencial,AcuraciaHoldout,TempoLote(ms),AcuraciaLote\n";
+    csv << "HoeffdingForest," << get_filename_only(dataset_path) << "," << n_train << ","
+        << online.get_num_trees() << "," << n_threads << "," << update_ms << "," << rows_per_s << ","
+        << rows_per_s / n_threads << "," << (double)prequential_correct / n_train << ","
+        << online_accuracy << "," << batch_ms << "," << batch_accuracy << "\n";
+    std::cout << "Resultados salvos em: " << csv_name << "\n";
+
+    return export_mismatches == 0 ? 0 : 1;
+}
@@ -1,5 +1,6 @@
 #include "RandomForestBaseline.h"
 #include "DataLoader.h"
+#include "PerfCounters.h"
 
 #include <iostream>
 #include <chrono>
@@ -98,7 +99,7 @@ int main(int argc, char** argv) {
 
     std::cout << "Carregando dataset...\n";
     try {
-        DataLoader::load_csv(dataset_path, X, y, max_samples);
+        DataLoader::load(dataset_path, X, y, max_samples);
         if (X.empty()) {
             std::cerr << "❌ Dataset vazio apos carregamento!\n";
             return 1;
@@ -170,5 +171,8 @@ int main(int argc, char** argv) {
     csv.close();
 
     std::cout << "Resultados salvos em: " << csv_name << "\n";
+
+    // Contadores de hardware por fase (só com make PERF=1)
+    PERF_REPORT(std::string());
     return 0;
 }
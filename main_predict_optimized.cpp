@@ -1,5 +1,9 @@
 #include "RandomForestOptimized.h"
+#include "QuantizedForest.h"
+#include "CompleteForest.h"
 #include "DataLoader.h"
+#include "PerfCounters.h"
+#include "ArgParser.h"
 
 #include <iostream>
 #include <chrono>
@@ -8,6 +12,8 @@
 #include <string>
 #include <random>
 #include <algorithm>
+#include <cmath>
+#include <sstream>
 
 std::string get_filename_only(const std::string& path) {
     std::size_t pos = path.find_last_of("/\\");
@@ -15,12 +21,13 @@ std::string get_filename_only(const std::string& path) {
     return path.substr(pos + 1);
 }
 
+template <typename Label>
 void train_test_split(const std::vector<std::vector<double>>& X,
-                      const std::vector<int>& y,
+                      const std::vector<Label>& y,
                       std::vector<std::vector<double>>& X_train,
-                      std::vector<int>& y_train,
+                      std::vector<Label>& y_train,
                       std::vector<std::vector<double>>& X_test,
-                      std::vector<int>& y_test,
+                      std::vector<Label>& y_test,
                       double train_ratio = 0.8) {
     const std::size_t n = X.size();
     std::vector<std::size_t> indices(n);
@@ -51,6 +58,16 @@ void train_test_split(const std::vector<std::vector<double>>& X,
     }
 }
 
+// "1,3,5" -> {1, 3, 5}
+static std::vector<int> parse_int_list(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty()) values.push_back(std::stoi(item));
+    return values;
+}
+
 double compute_accuracy(const std::vector<int>& y_true,
                         const std::vector<int>& y_pred) {
     if (y_true.size() != y_pred.size() || y_true.empty()) return 0.0;
@@ -61,50 +78,148 @@ double compute_accuracy(const std::vector<int>& y_true,
     return static_cast<double>(correct) / static_cast<double>(y_true.size());
 }
 
+// Log-loss médio das probabilidades (n x num_classes, row-major)
+double compute_log_loss(const std::vector<int>& y_true,
+                        const std::vector<double>& proba,
+                        int num_classes) {
+    if (y_true.empty() || num_classes == 0) return 0.0;
+    double total = 0.0;
+    for (std::size_t i = 0; i < y_true.size(); ++i) {
+        double p = 0.0;
+        if (y_true[i] >= 0 && y_true[i] < num_classes)
+            p = proba[i * num_classes + y_true[i]];
+        total -= std::log(std::max(p, 1e-15));
+    }
+    return total / y_true.size();
+}
+
+double compute_rmse(const std::vector<double>& y_true,
+                    const std::vector<double>& y_pred) {
+    if (y_true.size() != y_pred.size() || y_true.empty()) return 0.0;
+    double sse = 0.0;
+    for (std::size_t i = 0; i < y_true.size(); ++i)
+        sse += (y_true[i] - y_pred[i]) * (y_true[i] - y_pred[i]);
+    return std::sqrt(sse / y_true.size());
+}
+
 int main(int argc, char** argv) {
     std::cout << "========================================================\n";
     std::cout << "   Random Forest Otimizada: LOAD + PREDICAO\n";
     std::cout << "========================================================\n\n";
 
-    if (argc < 3) {
+    ArgParser args(argc, argv);
+
+    if (args.positional_count() < 2) {
         std::cerr << "Uso: " << argv[0]
-                  << " <arquivo_dataset.csv> <arquivo_modelo> [max_samples] [num_runs]\n";
+                  << " <arquivo_dataset.csv> <arquivo_modelo> [max_samples] [num_runs]\n"
+                  << "       [--early-exit[=confianca]] [--compact [--profiled-layout]] [--quantized]\n"
+                  << "       [--complete]  (arvores completas implicitas, travessia desenrolada)\n"
+                  << "       [--threads=N] [--perf-json=saida.jsonl]  (build com make PERF=1)\n"
+                  << "       [--features=0,2,5 | --features=model]  (so essas colunas sao carregadas)\n"
+                  << "       [--numa]  (threads fixadas por no, modelo copiado em cada no)\n";
         std::cerr << "Exemplo: " << argv[0]
                   << " covertype_dataset.csv optimized_covertype.model 100000 3\n";
         return 1;
     }
 
-    std::string dataset_path = argv[1];
-    std::string model_path   = argv[2];
+    std::string dataset_path = args.positional(0);
+    std::string model_path   = args.positional(1);
 
     int max_samples = 100000;
-    if (argc >= 4) {
-        max_samples = std::stoi(argv[3]);
+    if (args.positional_count() >= 3) {
+        max_samples = std::stoi(args.positional(2));
     }
 
     int num_runs = 3;
-    if (argc >= 5) {
-        num_runs = std::stoi(argv[4]);
+    if (args.positional_count() >= 4) {
+        num_runs = std::stoi(args.positional(3));
     }
 
+    // --early-exit (exato) ou --early-exit=0.9 (limite de confiança)
+    const bool early_exit = args.has_flag("early-exit");
+    const double early_exit_confidence = std::stod(args.option("early-exit", "1.0"));
+    // compacta e prediz pela forma achatada
+    // --profiled-layout: nós achatados na ordem das frequências do treino
+    const bool profiled_layout = args.has_flag("profiled-layout");
+    const bool compact_model = args.has_flag("compact") || profiled_layout;
+    // prediz pelo modelo quantizado (thresholds uint16, features uint8)
+    const bool quantized = args.has_flag("quantized");
+    // prediz pela forma completa implícita (filhos em 2i+1 / 2i+2)
+    const bool complete = args.has_flag("complete");
+    const int n_threads = std::stoi(args.option("threads", "1"));
+    const bool numa = args.has_flag("numa");
+
     std::cout << "Dataset   : " << dataset_path << "\n";
     std::cout << "Modelo    : " << model_path << "\n";
     std::cout << "MaxSamples: " << max_samples << "\n";
-    std::cout << "Num runs  : " << num_runs << "\n\n";
+    std::cout << "Num runs  : " << num_runs << "\n";
+    std::cout << "EarlyExit : " << (early_exit ? "sim" : "nao");
+    if (early_exit) std::cout << " (confianca " << early_exit_confidence << ")";
+    std::cout << "\n";
+    std::cout << "Compactar : " << (compact_model ? "sim" : "nao")
+              << (profiled_layout ? " (layout guiado por perfil)" : "") << "\n";
+    std::cout << "Quantizado: " << (quantized ? "sim" : "nao") << "\n";
+    std::cout << "Completa  : " << (complete ? "sim" : "nao") << "\n";
+    std::cout << "Threads   : " << n_threads << "\n";
+    std::cout << "NUMA      : " << (numa ? "sim" : "nao") << "\n";
+
+    // Tipo de folha do modelo: regressão lê o alvo como double e reporta
+    // RMSE; distribuição de classes reporta também o log-loss
+    // Seleção de colunas: lista explícita ou as features usadas pelo
+    // modelo; as demais não são convertidas/lidas do dataset
+    const std::string features_arg = args.option("features");
+    std::vector<int> columns;
+    RandomForestOptimized::LeafMode leaf_mode;
+    try {
+        RandomForestOptimized probe(1, 1, 1, 1);
+        probe.load_model(model_path);
+        leaf_mode = probe.get_leaf_mode();
+        if (features_arg == "model") {
+            columns = probe.get_used_features();
+        } else if (!features_arg.empty()) {
+            columns = parse_int_list(features_arg);
+            std::sort(columns.begin(), columns.end());
+            columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+        }
+        if (!features_arg.empty())
+            probe.select_features(columns);   // valida contra o modelo
+    } catch (const std::exception& e) {
+        std::cerr << "❌ Erro ao carregar modelo: " << e.what() << "\n";
+        return 1;
+    }
+    const bool regression = (leaf_mode == RandomForestOptimized::LeafMode::Regression);
+    const bool has_proba = (leaf_mode == RandomForestOptimized::LeafMode::Distribution);
+    std::cout << "Folhas    : " << (regression ? "regressao" : has_proba ? "distribuicao" : "classe") << "\n";
+    std::cout << "Colunas   : " << (features_arg.empty() ? std::string("todas")
+                                    : std::to_string(columns.size()) + " selecionadas")
+              << "\n\n";
+    const std::vector<int>* selected = features_arg.empty() ? nullptr : &columns;
+    if (regression && (quantized || complete || early_exit)) {
+        std::cerr << "❌ --quantized/--complete/--early-exit valem so para classificacao\n";
+        return 1;
+    }
 
     // Carregar dataset
     std::vector<std::vector<double>> X;
     std::vector<int> y;
+    std::vector<double> y_reg;
 
     std::cout << "Carregando dataset...\n";
+    double load_ms = 0.0;
     try {
-        DataLoader::load_csv(dataset_path, X, y, max_samples);
+        auto start_load = std::chrono::high_resolution_clock::now();
+        if (regression)
+            DataLoader::load(dataset_path, X, y_reg, max_samples, selected);
+        else
+            DataLoader::load(dataset_path, X, y, max_samples, selected);
+        load_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start_load).count();
         if (X.empty()) {
             std::cerr << "❌ Dataset vazio apos carregamento!\n";
             return 1;
         }
         std::cout << "Dataset carregado: " << X.size() << " amostras, "
-                  << X[0].size() << " features\n\n";
+                  << X[0].size() << " features (" << load_ms << " ms)\n\n";
     } catch (const std::exception& e) {
         std::cerr << "❌ Erro ao carregar dataset: " << e.what() << "\n";
         return 1;
@@ -112,24 +227,85 @@ int main(int argc, char** argv) {
 
     std::vector<std::vector<double>> X_train, X_test;
     std::vector<int> y_train, y_test;
-    train_test_split(X, y, X_train, y_train, X_test, y_test, 0.8);
+    std::vector<double> y_reg_train, y_reg_test;
+    if (regression)
+        train_test_split(X, y_reg, X_train, y_reg_train, X_test, y_reg_test, 0.8);
+    else
+        train_test_split(X, y, X_train, y_train, X_test, y_test, 0.8);
 
     std::cout << "Treino (nao usado aqui): " << X_train.size() << " amostras\n";
     std::cout << "Teste                  : " << X_test.size()  << " amostras\n\n";
 
     double total_pred_ms = 0.0;
     double total_acc     = 0.0;
+    double total_trees   = 0.0;
+    double total_log_loss = 0.0;
+    double total_rmse    = 0.0;
+    size_t numa_replica_bytes = 0;
+    size_t complete_bytes = 0, flat_bytes = 0;
 
     for (int run = 0; run < num_runs; ++run) {
         std::cout << "Iteracao " << (run + 1) << "/" << num_runs << "...\n";
 
         RandomForestOptimized forest(1, 1, 1, 1); // parametros nao importam para load_model
-        std::cout << "  Carregando modelo...\n";
+        std::cout << "  Carregando modelo... ";
+        auto start_load = std::chrono::high_resolution_clock::now();
         forest.load_model(model_path);
+        std::cout << std::chrono::duration<double, std::milli>(
+                         std::chrono::high_resolution_clock::now() - start_load).count()
+                  << " ms" << (forest.is_inference_only() ? " (formato compacto)" : "") << "\n";
+        if (selected) forest.select_features(columns);
+        forest.set_early_exit(early_exit, early_exit_confidence);
+        forest.set_num_threads(n_threads);
+        forest.set_numa(numa);
+        if (profiled_layout)
+            forest.set_flat_layout(FlatForest::Layout::Profiled);
+        if (compact_model || quantized || complete)
+            forest.compact();
+        numa_replica_bytes = forest.numa_replica_bytes();
+
+        QuantizedForest qforest;
+        if (quantized) {
+            qforest.build(forest.get_flat(), forest.get_num_classes());
+            std::cout << "  Modelo quantizado: " << qforest.get_num_nodes() << " nos, "
+                      << qforest.get_num_used_features() << " features, "
+                      << qforest.get_num_thresholds() << " thresholds, "
+                      << qforest.memory_bytes() << " B (achatado: "
+                      << forest.get_flat().memory_bytes() << " B)\n";
+        }
+        CompleteForest cforest;
+        if (complete) {
+            cforest.build(forest.get_flat(), forest.get_num_classes());
+            complete_bytes = cforest.memory_bytes();
+            flat_bytes = forest.get_flat().memory_bytes();
+            std::cout << "  Modelo completo: profundidade max " << cforest.get_max_tree_depth() << ", "
+                      << cforest.get_num_slots() << " nos (" << cforest.get_num_real_nodes()
+                      << " reais), " << complete_bytes << " B (achatado: " << flat_bytes << " B)\n";
+        }
+
+        if (regression) {
+            std::cout << "  Predizendo em conjunto de teste... ";
+            auto start_pred = std::chrono::high_resolution_clock::now();
+            std::vector<double> y_pred = forest.predict_regression(X_test);
+            auto end_pred   = std::chrono::high_resolution_clock::now();
+
+            double pred_ms =
+                std::chrono::duration<double, std::milli>(end_pred - start_pred).count();
+            total_pred_ms += pred_ms;
+            total_trees += forest.get_num_trees();
+            std::cout << pred_ms << " ms\n";
+
+            double rmse = compute_rmse(y_reg_test, y_pred);
+            total_rmse += rmse;
+            std::cout << "  RMSE: " << std::fixed << std::setprecision(4) << rmse << "\n\n";
+            continue;
+        }
 
         std::cout << "  Predizendo em conjunto de teste... ";
         auto start_pred = std::chrono::high_resolution_clock::now();
-        std::vector<int> y_pred = forest.predict(X_test);
+        std::vector<int> y_pred = quantized ? qforest.predict(X_test)
+                                : complete  ? cforest.predict(X_test)
+                                            : forest.predict(X_test);
         auto end_pred   = std::chrono::high_resolution_clock::now();
 
         double pred_ms =
@@ -137,38 +313,96 @@ int main(int argc, char** argv) {
         total_pred_ms += pred_ms;
         std::cout << pred_ms << " ms\n";
 
+        if (quantized || complete) {
+            // os modelos derivados precisam reproduzir exatamente a floresta
+            std::vector<int> y_ref = forest.predict(X_test);
+            std::size_t mismatches = 0;
+            for (std::size_t i = 0; i < y_ref.size(); ++i)
+                if (y_ref[i] != y_pred[i]) ++mismatches;
+            std::cout << "  Divergencias vs floresta: " << mismatches << "\n";
+        }
+
+        total_trees += (quantized || complete) ? forest.get_num_trees() : forest.get_avg_trees_evaluated();
+        std::cout << "  Arvores avaliadas/amostra: "
+                  << forest.get_avg_trees_evaluated() << "\n";
+
         double acc = compute_accuracy(y_test, y_pred);
         total_acc += acc;
         std::cout << "  Acuracia: " << std::fixed << std::setprecision(4)
-                  << acc * 100.0 << " %\n\n";
+                  << acc * 100.0 << " %\n";
+
+        if (has_proba) {
+            double log_loss = compute_log_loss(y_test, forest.predict_proba(X_test),
+                                               forest.get_num_classes());
+            total_log_loss += log_loss;
+            std::cout << "  Log-loss: " << log_loss << "\n";
+        }
+        std::cout << "\n";
     }
 
     double avg_pred_ms = total_pred_ms / num_runs;
     double avg_acc     = total_acc     / num_runs;
+    double avg_trees   = total_trees   / num_runs;
 
     std::cout << "================= RESULTADOS PREDICAO ===================\n";
     std::cout << std::setw(25) << "Tempo Predicao Medio (ms)"
               << std::setw(20) << std::fixed << std::setprecision(4)
               << avg_pred_ms << "\n";
 
-    std::cout << std::setw(25) << "Acuracia Media (%)"
+    if (regression) {
+        std::cout << std::setw(25) << "RMSE Medio"
+                  << std::setw(20) << std::fixed << std::setprecision(4)
+                  << total_rmse / num_runs << "\n";
+    } else {
+        std::cout << std::setw(25) << "Acuracia Media (%)"
+                  << std::setw(20) << std::fixed << std::setprecision(4)
+                  << (avg_acc * 100.0) << "\n";
+    }
+    if (has_proba)
+        std::cout << std::setw(25) << "Log-loss Medio"
+                  << std::setw(20) << total_log_loss / num_runs << "\n";
+
+    std::cout << std::setw(25) << "Arvores/Amostra"
               << std::setw(20) << std::fixed << std::setprecision(4)
-              << (avg_acc * 100.0) << "\n";
+              << avg_trees << "\n";
+    if (complete) {
+        // troca de memória da forma completa (preenchimento até a profundidade)
+        std::cout << std::setw(25) << "Memoria achatada (B)"
+                  << std::setw(20) << flat_bytes << "\n";
+        std::cout << std::setw(25) << "Memoria completa (B)"
+                  << std::setw(20) << complete_bytes << " ("
+                  << std::setprecision(2) << (double)complete_bytes / flat_bytes << "x)\n";
+    }
     std::cout << "========================================================\n";
 
+    if (numa)
+        NumaTopology::detect().print_summary(std::cout, numa_replica_bytes);
+
     std::string csv_name = "results_predict_optimized_load_" +
                            get_filename_only(dataset_path) + ".csv";
     std::ofstream csv(csv_name);
-    csv << "Metodo,Dataset,Modelo,MaxSamples,NumRuns,TempoPredicaoMedio(ms),AcuraciaMedia\n";
-    csv << "RandomForestOptimizedPredict,"
+    csv << "Metodo,Dataset,Modelo,MaxSamples,NumRuns,TempoPredicaoMedio(ms),AcuraciaMedia,ArvoresPorAmostra,LogLossMedio,RMSEMedio\n";
+    csv << (complete ? "RandomForestOptimizedPredictCompleta,"
+            : profiled_layout ? "RandomForestOptimizedPredictPerfil," : "RandomForestOptimizedPredict,")
         << get_filename_only(dataset_path) << ","
         << model_path << ","
         << max_samples << ","
         << num_runs << ","
-        << avg_pred_ms << ","
-        << avg_acc << "\n";
+        << avg_pred_ms << ",";
+    if (regression) csv << "NA";
+    else            csv << avg_acc;
+    csv << "," << avg_trees << ",";
+    if (has_proba)  csv << total_log_loss / num_runs;
+    else            csv << "NA";
+    csv << ",";
+    if (regression) csv << total_rmse / num_runs;
+    else            csv << "NA";
+    csv << "\n";
     csv.close();
 
     std::cout << "Resultados salvos em: " << csv_name << "\n";
+
+    // Contadores de hardware por fase (só com make PERF=1)
+    PERF_REPORT(args.option("perf-json"));
     return 0;
 }